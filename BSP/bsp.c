@@ -172,7 +172,12 @@ void  BSP_Init (void)
     
  Sensor_Init();   
     
+ Odom_Init();
+    
  PWM_Init();  
+    
+ Adc_Init();
+ Servo_Init();
  
  OLED_Init();      
 }
@@ -0,0 +1,252 @@
+/*
+ռڲflashǰ16K(0x08000000~0x08003FFF) boot.uvprojx main.uvprojx  RTE
+ϵȿW25Q64ݴ(Driver/Ota.h)Уû³򣬾УһCRC32
+ͨȱǿʼҳд OTA_APP_ADDR ضȽϣȫȷݴѿ;磬´ϵ
+Ӧóջ͸λȥû³򣬻ݴԵûʼʱֱ
+ BOOT_COPY_TRY ζԣʼݴˡڲflashCRCֶԲϣֻдһ룬ͣﲻ
+ֻüĴѯжϣ⣻ Driver/Ota.h ͬǱ߸ҲҪ
+
+W25Q64  SPI1(A5 A6 A7)Ƭѡ C0ͬ User/config.cpp
+*/
+
+#include "stm32f10x.h"                  // Device header
+
+
+#define OTA_IMG_ADDR        0x700000
+#define OTA_IMG_MAX         0x7C000
+#define OTA_HDR_ADDR        0x7F0000
+#define OTA_MAGIC           0x3141544F
+#define OTA_HDR_READY       16
+#define OTA_HDR_DONE        17
+#define OTA_HDR_COPY        18
+#define OTA_APP_ADDR        0x08004000
+
+#define BOOT_PAGE_SIZE      0x800               //ڲflashһҳ2K
+#define BOOT_COPY_TRY       3
+#define BOOT_CS             0x0001              //C0
+
+#define W25X_WriteEnable    0x06
+#define W25X_ReadStatusReg  0x05
+#define W25X_ReadData       0x03
+#define W25X_PageProgram    0x02
+
+
+static const uint32_t Boot_Crc_Tab [ 16 ] =     //ͬ Driver/Ota.cpp
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint8_t Boot_Buf [ BOOT_PAGE_SIZE ];
+
+
+static uint32_t Boot_Crc32(uint32_t crc, const uint8_t *p, uint32_t len)       //ͬ zlib  crc32()
+{
+    crc = ~crc;
+    while ( len-- )
+    {
+        crc ^= *p++;
+        crc = ( crc >> 4 ) ^ Boot_Crc_Tab [ crc & 0x0F ];
+        crc = ( crc >> 4 ) ^ Boot_Crc_Tab [ crc & 0x0F ];
+    }
+    return ~crc;
+}
+
+
+static void Boot_Spi_Init(void)
+{
+    RCC->APB2ENR |= RCC_APB2ENR_IOPAEN | RCC_APB2ENR_IOPCEN | RCC_APB2ENR_SPI1EN;
+
+    GPIOC->BSRR = BOOT_CS;                                           //Ƭѡ
+    GPIOC->CRL = ( GPIOC->CRL & ~0x0000000Fu ) | 0x00000003u;          //C0  50MHz
+    GPIOA->CRL = ( GPIOA->CRL & ~0xFFF00000u ) | 0xB4B00000u;          //A5 A7 죬A6 
+
+    SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_BR_0 | SPI_CR1_CPOL | SPI_CR1_CPHA;     //72M/4ͬ W25Q64::Init_SPI()
+    SPI1->CR1 |= SPI_CR1_SPE;
+}
+
+
+static void Boot_Spi_Deinit(void)           //صλ״̬ٽӦó
+{
+    RCC->APB2RSTR |= RCC_APB2RSTR_SPI1RST | RCC_APB2RSTR_IOPARST | RCC_APB2RSTR_IOPCRST;
+    RCC->APB2RSTR &= ~( RCC_APB2RSTR_SPI1RST | RCC_APB2RSTR_IOPARST | RCC_APB2RSTR_IOPCRST );
+    RCC->APB2ENR &= ~( RCC_APB2ENR_IOPAEN | RCC_APB2ENR_IOPCEN | RCC_APB2ENR_SPI1EN );
+}
+
+
+static uint8_t Boot_Xfer(uint8_t b)
+{
+    while ( ! ( SPI1->SR & SPI_SR_TXE ) )
+        ;
+    SPI1->DR = b;
+    while ( ! ( SPI1->SR & SPI_SR_RXNE ) )
+        ;
+    return SPI1->DR;
+}
+
+
+static void Boot_Cmd_Addr(uint8_t cmd, uint32_t addr)
+{
+    GPIOC->BRR = BOOT_CS;
+    Boot_Xfer ( cmd );
+    Boot_Xfer ( addr >> 16 );
+    Boot_Xfer ( addr >> 8 );
+    Boot_Xfer ( addr );
+}
+
+
+static void Boot_Read(uint32_t addr, uint8_t *p, uint32_t len)
+{
+    Boot_Cmd_Addr ( W25X_ReadData, addr );
+    while ( len-- )
+        *p++ = Boot_Xfer ( 0xFF );
+    GPIOC->BSRR = BOOT_CS;
+}
+
+
+static void Boot_Mark(uint32_t addr)        //ݴһֽ 0xFF д 0x00
+{
+    GPIOC->BRR = BOOT_CS;
+    Boot_Xfer ( W25X_WriteEnable );
+    GPIOC->BSRR = BOOT_CS;
+
+    Boot_Cmd_Addr ( W25X_PageProgram, addr );
+    Boot_Xfer ( 0x00 );
+    GPIOC->BSRR = BOOT_CS;
+
+    GPIOC->BRR = BOOT_CS;
+    Boot_Xfer ( W25X_ReadStatusReg );
+    while ( Boot_Xfer ( 0xFF ) & 0x01 )
+        ;
+    GPIOC->BSRR = BOOT_CS;
+}
+
+
+static uint32_t Boot_Get32(const uint8_t *p)
+{
+    return p [ 0 ] | ( p [ 1 ] << 8 ) | ( (uint32_t)p [ 2 ] << 16 ) | ( (uint32_t)p [ 3 ] << 24 );
+}
+
+
+static void Boot_Flash_Wait(void)
+{
+    while ( FLASH->SR & FLASH_SR_BSY )
+        ;
+}
+
+
+static uint8_t Boot_Flash_Page(uint32_t addr, const uint8_t *p, uint32_t len)     //һҳд len ֽڣضȽϣȷ1
+{
+    uint32_t i;
+
+    Boot_Flash_Wait ();
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+    FLASH->CR |= FLASH_CR_PER;
+    FLASH->AR = addr;
+    FLASH->CR |= FLASH_CR_STRT;
+    Boot_Flash_Wait ();
+    FLASH->CR &= ~FLASH_CR_PER;
+
+    FLASH->CR |= FLASH_CR_PG;
+    for ( i = 0; i < len; i += 2 )                                  //дʱ0xFF
+    {
+        *(volatile uint16_t *)( addr + i ) = p [ i ] | ( ( ( i + 1 < len ) ? p [ i + 1 ] : 0xFF ) << 8 );
+        Boot_Flash_Wait ();
+    }
+    FLASH->CR &= ~FLASH_CR_PG;
+
+    for ( i = 0; i < len; i++ )
+    {
+        if ( *(volatile uint8_t *)( addr + i ) != p [ i ] )
+            return 0;
+    }
+    return 1;
+}
+
+
+static uint8_t Boot_Copy(uint32_t size)     //ݴڲflashȫȷ1
+{
+    uint32_t off, n;
+    uint8_t  ok = 1;
+
+    FLASH->KEYR = 0x45670123;
+    FLASH->KEYR = 0xCDEF89AB;
+    for ( off = 0; ok && ( off < size ); off += BOOT_PAGE_SIZE )
+    {
+        n = ( size - off > BOOT_PAGE_SIZE ) ? BOOT_PAGE_SIZE : size - off;
+        Boot_Read ( OTA_IMG_ADDR + off, Boot_Buf, n );
+        ok = Boot_Flash_Page ( OTA_APP_ADDR + off, Boot_Buf, n );
+    }
+    FLASH->CR |= FLASH_CR_LOCK;
+    return ok;
+}
+
+
+static uint8_t Boot_Update(void)            //0ʾڲflashĳȥ
+{
+    uint8_t  hdr [ OTA_HDR_COPY + 1 ];
+    uint32_t size, crc, c, off, n, i;
+
+    Boot_Read ( OTA_HDR_ADDR, hdr, sizeof ( hdr ) );
+    size = Boot_Get32 ( &hdr [ 4 ] );
+    crc = Boot_Get32 ( &hdr [ 8 ] );
+    if ( ( Boot_Get32 ( &hdr [ 0 ] ) != OTA_MAGIC ) || ( size == 0 ) || ( size > OTA_IMG_MAX )
+      || ( hdr [ OTA_HDR_READY ] != 0x00 ) || ( hdr [ OTA_HDR_DONE ] != 0xFF ) )
+        return 1;
+
+    c = 0;
+    for ( off = 0; off < size; off += n )                           //ݴУһΣԾͲԭĳ
+    {
+        n = ( size - off > sizeof ( Boot_Buf ) ) ? sizeof ( Boot_Buf ) : size - off;
+        Boot_Read ( OTA_IMG_ADDR + off, Boot_Buf, n );
+        c = Boot_Crc32 ( c, Boot_Buf, n );
+    }
+    if ( c != crc )                                                 //ûʼԭĳ򣻿ҪԵ(ֻѿıûд)
+        return ( hdr [ OTA_HDR_COPY ] != 0x00 ) || ( Boot_Crc32 ( 0, (const uint8_t *)OTA_APP_ADDR, size ) == crc );
+
+    if ( hdr [ OTA_HDR_COPY ] != 0x00 )
+        Boot_Mark ( OTA_HDR_ADDR + OTA_HDR_COPY );
+    for ( i = 0; i < BOOT_COPY_TRY; i++ )
+    {
+        if ( Boot_Copy ( size ) && ( Boot_Crc32 ( 0, (const uint8_t *)OTA_APP_ADDR, size ) == crc ) )
+        {
+            Boot_Mark ( OTA_HDR_ADDR + OTA_HDR_DONE );
+            return 1;
+        }
+    }
+    return 0;                                                       //ѿıǲд´ϵ
+}
+
+
+typedef void (*Boot_Entry)(void);
+
+int main(void)
+{
+    uint32_t   sp, pc;
+    uint8_t    ok;
+    Boot_Entry entry;
+
+    SCB->VTOR = FLASH_BASE;                 //RTE system_stm32f10x.c Ӧó 0x4000
+
+    Boot_Spi_Init ();
+    ok = Boot_Update ();
+    Boot_Spi_Deinit ();
+    if ( ! ok )                             //سȥҶͣȸλԻ
+        while ( 1 )
+            ;
+
+    sp = *(volatile uint32_t *)OTA_APP_ADDR;
+    pc = *(volatile uint32_t *)( OTA_APP_ADDR + 4 );
+    if ( ( ( sp & 0xFFFF0000u ) != 0x20000000u ) && ( sp != 0x20010000u ) )        //ջҪ64KڲRAM
+        while ( 1 )
+            ;
+    if ( ( pc < OTA_APP_ADDR ) || ( pc >= FLASH_BASE + 0x80000 ) || ! ( pc & 1 ) )
+        while ( 1 )
+            ;
+
+    entry = (Boot_Entry)pc;
+    __set_MSP ( sp );
+    entry ();
+    while ( 1 )
+        ;
+}
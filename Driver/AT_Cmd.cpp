@@ -0,0 +1,189 @@
+#include "AT_Cmd.h"
+#include <string.h>
+
+
+
+AT_Cmd::AT_Cmd(const AT_Port *port)
+{
+    this->port=port;
+    head=0;
+    tail=0;
+    expect1=0;
+    expect2=0;
+    result=AT_IDLE;
+    deferred=false;
+    deferred_timeout=0;
+    deferred_start=0;
+    deferred_fails=0;
+}
+
+
+bool AT_Cmd::match(const char *reply, AT_Token tok, const char *p, uint16_t len)
+{
+    uint16_t n;
+
+    if ( reply == 0 )
+        return false;
+    if ( reply [ 0 ] == '>' )                           //CIPSEND ķʾ
+        return tok == AT_TOK_PROMPT;
+    if ( ( tok == AT_TOK_PROMPT ) || ( tok == AT_TOK_IPD ) || ( tok == AT_TOK_IPD_DATA ) )
+        return false;
+
+    n = strlen ( reply );
+    return ( len >= n ) && ( memcmp ( p, reply, n ) == 0 );     //Ӧͷ
+}
+
+
+bool AT_Cmd::on_token(AT_Token tok, const char *p, uint16_t len)
+{
+    if ( result != AT_WAIT )
+        return false;
+
+    if ( match ( expect1, tok, p, len ) || match ( expect2, tok, p, len ) )
+        result = AT_DONE;
+    else if ( ( tok == AT_TOK_ERROR ) || ( tok == AT_TOK_FAIL ) || ( tok == AT_TOK_SEND_FAIL ) )
+        result = AT_FAILED;                             //ģѾȷʧܣصȵʱ
+    else
+        return false;
+    return true;
+}
+
+
+void AT_Cmd::arm(const char *reply1, const char *reply2)
+{
+    expect1 = reply1;
+    expect2 = reply2;
+    result = ( ( reply1 == 0 ) && ( reply2 == 0 ) ) ? AT_IDLE : AT_WAIT;
+
+    port->rx_clear();                                   //¿ʼµݰ
+}
+
+
+bool AT_Cmd::wait_reply(uint32_t timeout)
+{
+    uint32_t start, used;
+
+    if ( result == AT_IDLE )                            //Ҫ
+        return true;
+
+    start = port->now();
+    while ( 1 )
+    {
+        if ( result == AT_DONE )
+            return true;
+        if ( result == AT_FAILED )
+            return false;
+
+        used = port->now() - start;
+        if ( used >= timeout )
+        {
+            result = AT_IDLE;
+            return false;
+        }
+
+        port->wait ( timeout - used );                  //յӦ/ERRORʱŷ
+    }
+}
+
+
+void AT_Cmd::settle()
+{
+    uint32_t used;
+
+    if ( ! deferred )
+        return;
+    deferred = false;
+    used = port->now() - deferred_start;                //ʱӷʱ
+    if ( ! wait_reply ( ( used < deferred_timeout ) ? deferred_timeout - used : 0 ) )      //һη͵ļѾյ
+        deferred_fails ++;
+}
+
+
+bool AT_Cmd::exec(const char *cmd, const char *reply1, const char *reply2, uint32_t timeout)
+{
+    settle ();
+    arm ( reply1, reply2 );
+
+    if ( cmd != 0 )
+    {
+        port->send ( cmd );
+        port->send ( "\r\n" );
+    }
+
+    return wait_reply ( timeout );
+}
+
+
+bool AT_Cmd::send_data(const char *cmd, const void *data, uint16_t len, uint32_t timeout, bool wait)
+{
+    if ( port->write == 0 )
+        return false;
+    if ( ! exec ( cmd, ">", 0, timeout ) )
+        return false;
+
+    arm ( "SEND OK", 0 );                               //׼ٷݣӦ𲻻©
+    port->write ( data, len );
+    if ( wait )
+        return wait_reply ( timeout );
+
+    deferred = true;                                    //ڴϷ͡ģ鷢ȥʱ
+    deferred_timeout = timeout;
+    deferred_start = port->now();
+    return true;
+}
+
+
+bool AT_Cmd::sending()
+{
+    return deferred && ( result == AT_WAIT ) && ( port->now() - deferred_start < deferred_timeout );
+}
+
+
+uint32_t AT_Cmd::send_fails()
+{
+    return deferred_fails;
+}
+
+
+bool AT_Cmd::submit(const char *cmd, const char *reply1, const char *reply2, uint32_t timeout, AT_Callback cb, void *arg)
+{
+    uint8_t next = ( tail + 1 ) % AT_QUEUE_LEN;
+
+    if ( next == head )                                 //
+        return false;
+
+    queue [ tail ].cmd = cmd;
+    queue [ tail ].reply1 = reply1;
+    queue [ tail ].reply2 = reply2;
+    queue [ tail ].timeout = timeout;
+    queue [ tail ].cb = cb;
+    queue [ tail ].arg = arg;
+    tail = next;
+    return true;
+}
+
+
+uint8_t AT_Cmd::process()
+{
+    uint8_t      fail = 0;
+    bool         ok;
+    AT_Request * pReq;
+
+    while ( head != tail )
+    {
+        pReq = &queue [ head ];
+        ok = exec ( pReq->cmd, pReq->reply1, pReq->reply2, pReq->timeout );     //һӦһͷһ
+        if ( ! ok )
+            fail ++;
+        if ( pReq->cb )
+            pReq->cb ( ok, port->rx_buf(), pReq->arg );
+        head = ( head + 1 ) % AT_QUEUE_LEN;
+    }
+    return fail;
+}
+
+
+uint8_t AT_Cmd::pending()
+{
+    return ( tail + AT_QUEUE_LEN - head ) % AT_QUEUE_LEN;
+}
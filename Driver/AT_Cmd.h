@@ -0,0 +1,81 @@
+#ifndef __AT_Cmd_H__
+#define __AT_Cmd_H__
+
+#include <stdint.h>
+#include "AT_Parser.h"
+
+
+//ATָ棺ָȴ¼յӦأٹ̶ʱ
+//ӲͲϵͳշʱ䡢ȴ AT_Port ṩϵESP8266ģֱӱ뱾ļ
+//Ӧ AT_Parser ֺõн on_token() Ƚϣٶջ strstr
+
+
+#define AT_QUEUE_LEN       8                   //첽ָг
+
+
+struct AT_Port
+{
+    void          (*send)(const char *str);         //ַ
+    uint32_t      (*now)(void);                     //ǰʱ(ms)
+    void          (*wait)(uint32_t ms);             //ȴ on_token() trueȴms
+    void          (*sleep)(uint32_t ms);            //ʱ(ms)ڸλ塢͸˳ӲʱҪ
+    void          (*rx_clear)(void);                //սջδĽ¼
+    const char *  (*rx_buf)(void);                  //ջ('\0'β)
+    void          (*write)(const void *buf, uint16_t len);     //Ͷ(CIPSEND ݲ)Ϊ0
+};
+
+
+typedef void (*AT_Callback)(bool ok, const char *rx, void *arg);     //첽ָɻصrxΪʱĽջ
+
+struct AT_Request
+{
+    const char *  cmd;              //ָ0ʾֻȴӦ
+    const char *  reply1;           //Ӧ1
+    const char *  reply2;           //Ӧ2
+    uint32_t      timeout;          //ʱʱ(ms)
+    AT_Callback   cb;               //ɻصΪ0
+    void *        arg;
+};
+
+
+class AT_Cmd
+{
+    public:
+    AT_Cmd(const AT_Port *port);
+    bool    exec(const char *cmd, const char *reply1, const char *reply2, uint32_t timeout);   //ִͬУյӦ/ERROR/ʱ
+    bool    send_data(const char *cmd, const void *data, uint16_t len, uint32_t timeout, bool wait);     //cmdΪ AT+CIPSEND=...ȵ'>'ݣwaitΪʱٵ SEND OK
+    uint32_t send_fails();                              //waitΪٵķ֮ͣյ SEND FAIL/ʱĴ
+    bool    sending();                                  //waitΪٵķͻڵ SEND OK ûʱȴ
+    bool    submit(const char *cmd, const char *reply1, const char *reply2, uint32_t timeout, AT_Callback cb, void *arg);   //Уcmdִַ֮ǰЧ
+    uint8_t process();                                  //ִжеָм䲻Уʧܵ
+    uint8_t pending();                                  //δִеָ
+    bool    on_token(AT_Token tok, const char *p, uint16_t len);       //ִڽжеãtrueʱҪѵȴ
+
+    private:
+    enum Result
+    {
+        AT_IDLE,
+        AT_WAIT,            //ڵȴӦ
+        AT_DONE,            //յӦ
+        AT_FAILED,          //յ ERROR/FAIL
+    };
+
+    const AT_Port *         port;
+    AT_Request              queue [ AT_QUEUE_LEN ];
+    uint8_t                 head;
+    uint8_t                 tail;
+    const char * volatile   expect1;
+    const char * volatile   expect2;
+    volatile uint8_t        result;
+    static bool match(const char *reply, AT_Token tok, const char *p, uint16_t len);
+    bool                    deferred;       //һη͵ SEND OK ûȣһָ֮ǰٵ
+    uint32_t                deferred_timeout;
+    uint32_t                deferred_start;
+    uint32_t                deferred_fails;
+    void    arm(const char *reply1, const char *reply2);
+    void    settle();
+    bool    wait_reply(uint32_t timeout);
+};
+
+
+#endif
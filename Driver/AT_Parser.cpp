@@ -0,0 +1,216 @@
+#include "AT_Parser.h"
+
+
+
+struct AT_Keyword
+{
+    const char * str;
+    uint8_t      len;
+    AT_Token     tok;
+};
+
+static const AT_Keyword AT_Key [ ] =                    //еЩַʱӦı
+{
+    { "OK",        2, AT_TOK_OK },
+    { "ERROR",     5, AT_TOK_ERROR },
+    { "FAIL",      4, AT_TOK_FAIL },
+    { "SEND OK",   7, AT_TOK_SEND_OK },
+    { "SEND FAIL", 9, AT_TOK_SEND_FAIL },
+    { "+IPD,",     5, AT_TOK_IPD },                     //ǰ׺ƥ䵽תȥ
+};
+
+#define AT_KEY_NUM         ( sizeof ( AT_Key ) / sizeof ( AT_Key [ 0 ] ) )
+#define AT_KEY_ALL         ( ( 1u << AT_KEY_NUM ) - 1 )
+#define AT_KEY_IPD         ( 1u << ( AT_KEY_NUM - 1 ) )
+
+
+
+
+AT_Parser::AT_Parser(AT_TokenFunc fn, void *arg)
+{
+    this->fn=fn;
+    this->arg=arg;
+    reset(0);
+}
+
+
+void AT_Parser::reset(const char *buf)
+{
+    this->buf=buf;
+    pos=0;
+    start=0;
+    col=0;
+    match=AT_KEY_ALL;
+    state=S_LINE;
+    id=0;
+    left=0;
+}
+
+
+void AT_Parser::rebase(const char *buf)
+{
+    if ( ( state == S_IPD_DATA ) && ( pos > start ) )   //Ƚȥ
+        fn ( AT_TOK_IPD_DATA, this->buf + start, pos - start, arg );
+
+    this->buf=buf;
+    pos=0;
+    start=0;
+}
+
+
+uint8_t AT_Parser::ipd_id()
+{
+    return id;
+}
+
+
+uint16_t AT_Parser::ipd_left()
+{
+    return ( state == S_IPD_DATA ) ? left : 0;
+}
+
+
+void AT_Parser::line_char(char ch)
+{
+    uint8_t i;
+
+    for ( i = 0; i < AT_KEY_NUM; i++ )                  //ؼ̶ָÿֽO(1)
+    {
+        if ( ( match & ( 1u << i ) ) && ( ( col >= AT_Key [ i ] .len ) || ( AT_Key [ i ] .str [ col ] != ch ) ) )
+            match &= ~ ( 1u << i );
+    }
+    col ++;
+
+    if ( ( match & AT_KEY_IPD ) && ( col == AT_Key [ AT_KEY_NUM - 1 ] .len ) )
+    {
+        state = S_IPD_NUM1;
+        num = 0;
+        digits = 0;
+    }
+}
+
+
+void AT_Parser::line_end(uint16_t end)
+{
+    uint8_t  i;
+
+    if ( col == 0 )                                     //
+        return;
+
+    for ( i = 0; i < AT_KEY_NUM - 1; i++ )
+    {
+        if ( ( match & ( 1u << i ) ) && ( col == AT_Key [ i ] .len ) )
+        {
+            fn ( AT_Key [ i ] .tok, AT_Key [ i ] .str, AT_Key [ i ] .len, arg );       //ؼַָܻͷӰ
+            return;
+        }
+    }
+
+    while ( ( end > start ) && ( buf [ end - 1 ] == '\r' ) )
+        end --;
+    fn ( AT_TOK_LINE, buf + start, end - start, arg );  //;صͷʱֻкΣȿΪ0
+}
+
+
+void AT_Parser::feed(uint16_t end)
+{
+    char     ch;
+    uint16_t n;
+
+    while ( pos < end )
+    {
+        ch = buf [ pos ];
+
+        switch ( state )
+        {
+            case S_IPD_DATA:                            //ݲֽڿֱ
+                n = end - pos;
+                if ( n > left )
+                    n = left;
+                pos += n;
+                left -= n;
+                if ( left == 0 )
+                {
+                    fn ( AT_TOK_IPD_DATA, buf + start, pos - start, arg );
+                    state = S_LINE;
+                    start = pos;
+                    col = 0;
+                    match = AT_KEY_ALL;
+                }
+                continue;
+
+            case S_PROMPT:
+                state = S_LINE;
+                start = pos;
+                if ( ch == ' ' )                        //"> "
+                {
+                    start = ++ pos;
+                    continue;
+                }
+                break;
+
+            case S_IPD_NUM1:
+            case S_IPD_NUM2:
+                if ( ( ch >= '0' ) && ( ch <= '9' ) && ( digits < 4 ) )
+                {
+                    num = num * 10 + ( ch - '0' );
+                    digits ++;
+                    pos ++;
+                    continue;
+                }
+                if ( ( ch == ',' ) && ( state == S_IPD_NUM1 ) && digits )      //ӸʽһӺ
+                {
+                    id = num;
+                    num = 0;
+                    digits = 0;
+                    state = S_IPD_NUM2;
+                    pos ++;
+                    continue;
+                }
+                if ( ( ch == ':' ) && digits && ( num <= AT_IPD_MAX_LEN ) )
+                {
+                    if ( state == S_IPD_NUM1 )
+                        id = 0;
+                    fn ( AT_TOK_IPD, 0, num, arg );
+                    pos ++;
+                    start = pos;
+                    left = num;
+                    if ( left )
+                        state = S_IPD_DATA;
+                    else
+                    {
+                        state = S_LINE;
+                        col = 0;
+                        match = AT_KEY_ALL;
+                    }
+                    continue;
+                }
+                state = S_LINE;                         //ʽԣͨд
+                match = 0;
+                break;
+
+            default:
+                break;
+        }
+
+        if ( ch == '\n' )
+        {
+            line_end ( pos );
+            start = ++ pos;
+            col = 0;
+            match = AT_KEY_ALL;
+        }
+        else if ( ( ch == '>' ) && ( col == 0 ) )      //׵ʾ
+        {
+            fn ( AT_TOK_PROMPT, buf + pos, 1, arg );
+            state = S_PROMPT;
+            start = ++ pos;
+        }
+        else
+        {
+            if ( ch != '\r' )
+                line_char ( ch );
+            pos ++;
+        }
+    }
+}
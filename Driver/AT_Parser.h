@@ -0,0 +1,70 @@
+#ifndef __AT_Parser_H__
+#define __AT_Parser_H__
+
+#include <stdint.h>
+
+
+//ESP8266Ӧʽִжÿյһֽڵһ feed()ÿֽO(1)ͷɨ軺
+//ʶ нOK/ERROR/FAIL/SEND OK/SEND FAIL'>'ʾ"+IPD,<id>,<len>:"("+IPD,<len>:")
+//ֳкݶָ߽ջָ+ȣƣOK/ERRORȹؼַָ
+//Ӳڵϱģ(Tools/AT_Fuzz)
+
+
+#define AT_IPD_MAX_LEN     2048                //+IPD ݳޣʽ
+
+
+enum AT_Token
+{
+    AT_TOK_LINE,            //ͨһ(\r\n)
+    AT_TOK_OK,
+    AT_TOK_ERROR,
+    AT_TOK_FAIL,
+    AT_TOK_SEND_OK,
+    AT_TOK_SEND_FAIL,
+    AT_TOK_PROMPT,          //׵'>'pָ'>'
+    AT_TOK_IPD,             //+IPD ͷϣlenΪܳȣpΪ0
+    AT_TOK_IPD_DATA,        //+IPD һݣһݿּܷθ
+};
+
+
+typedef void (*AT_TokenFunc)(AT_Token tok, const char *p, uint16_t len, void *arg);     //ڵ feed() ִ(һж)
+
+
+class AT_Parser
+{
+    public:
+    AT_Parser(AT_TokenFunc fn, void *arg);
+    void     reset(const char *buf);            //״ֽ̬֮ڴ buf[0] ʼд
+    void     rebase(const char *buf);           //Ҫ´ͷд(һ)Ƚյİݣ״̬
+    void     feed(uint16_t end);                //buf[ϴεend .. end) Ѿд룬ֽڽ
+    uint8_t  ipd_id();                          //ǰ/һ +IPD ӺţӸʽΪ0
+    uint16_t ipd_left();                        //ǰ +IPD ûյֽ0ʾ
+
+    private:
+    enum State
+    {
+        S_LINE,             //
+        S_PROMPT,           //յ'>'һո
+        S_IPD_NUM1,         //+IPD, ֮ĵһ
+        S_IPD_NUM2,         //Ӹʽĵڶ()
+        S_IPD_DATA,         //
+    };
+
+    AT_TokenFunc    fn;
+    void *          arg;
+    const char *    buf;
+    uint16_t        pos;            //һҪֽ
+    uint16_t        start;          //ǰ(ݶ)bufе
+    uint16_t        col;            //ǰյַ('\r')
+    uint8_t         match;          //ǰлЩؼ(λ)
+    uint8_t         state;
+    uint8_t         digits;
+    uint8_t         id;
+    uint16_t        num;
+    uint16_t        left;
+    void     line_end(uint16_t end);
+    void     line_char(char ch);
+};
+
+
+#endif
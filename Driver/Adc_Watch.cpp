@@ -0,0 +1,122 @@
+#include "Adc_Watch.h"
+#include <string.h>
+
+
+
+Adc_Watch::Adc_Watch(uint8_t ch_num)
+{
+    this->ch_num = ( ch_num > ADC_WATCH_CH_MAX ) ? ADC_WATCH_CH_MAX : ch_num;
+    rule_num = 0;
+    idx = 0;
+    primed = false;
+    memset ( hist, 0, sizeof ( hist ) );
+    memset ( sum, 0, sizeof ( sum ) );
+    memset ( (void *)avg, 0, sizeof ( avg ) );
+    memset ( (void *)avg_peak, 0, sizeof ( avg_peak ) );
+}
+
+
+int8_t Adc_Watch::rule(uint8_t ch, uint16_t level, uint16_t hold, bool above, Adc_Watch_Cb cb)
+{
+    Rule *r;
+
+    if ( ( rule_num >= ADC_WATCH_RULE_MAX ) || ( ch >= ch_num ) )
+        return -1;
+    r = &rules [ rule_num ];
+    r->ch = ch;
+    r->above = above;
+    r->level = level;
+    r->hold = hold ? hold : 1;
+    r->count = 0;
+    r->tripped = false;
+    r->trips = 0;
+    r->cb = cb;
+    return rule_num++;                                  //һж￴ʱѾ
+}
+
+
+void Adc_Watch::feed(const uint16_t *buf, uint16_t frames)
+{
+    uint16_t f, v;
+    uint8_t  c, k;
+    Rule     *r;
+
+    if ( ! primed && frames )                           //һõһڣϵʱƽֵ0
+    {
+        for ( c = 0; c < ch_num; c++ )
+        {
+            for ( k = 0; k < ( 1 << ADC_WATCH_AVG_SHIFT ); k++ )
+                hist [ c ] [ k ] = buf [ c ];
+            sum [ c ] = (uint32_t)buf [ c ] << ADC_WATCH_AVG_SHIFT;
+        }
+        primed = true;
+    }
+
+    for ( f = 0; f < frames; f++, buf += ch_num )
+    {
+        for ( c = 0; c < ch_num; c++ )
+        {
+            sum [ c ] += buf [ c ] - hist [ c ] [ idx ];
+            hist [ c ] [ idx ] = buf [ c ];
+            v = (uint16_t)( sum [ c ] >> ADC_WATCH_AVG_SHIFT );
+            avg [ c ] = v;
+            if ( v > avg_peak [ c ] )
+                avg_peak [ c ] = v;
+        }
+        idx = ( idx + 1 ) & ( ( 1 << ADC_WATCH_AVG_SHIFT ) - 1 );
+
+        for ( k = 0; k < rule_num; k++ )
+        {
+            r = &rules [ k ];
+            v = avg [ r->ch ];
+            if ( r->above ? ( v <= r->level ) : ( v >= r->level ) )
+            {
+                r->count = 0;
+                r->tripped = false;
+                continue;
+            }
+            if ( r->count < r->hold )
+                r->count++;
+            if ( ( r->count >= r->hold ) && ! r->tripped )
+            {
+                r->tripped = true;
+                r->trips++;
+                if ( r->cb )
+                    r->cb ( k, v );
+            }
+        }
+    }
+}
+
+
+uint16_t Adc_Watch::value(uint8_t ch)
+{
+    return ( ch < ch_num ) ? avg [ ch ] : 0;
+}
+
+
+uint16_t Adc_Watch::peak(uint8_t ch)
+{
+    return ( ch < ch_num ) ? avg_peak [ ch ] : 0;
+}
+
+
+void Adc_Watch::peak_clear()
+{
+    uint8_t c;
+
+    for ( c = 0; c < ch_num; c++ )
+        avg_peak [ c ] = avg [ c ];
+}
+
+
+uint32_t Adc_Watch::trips(uint8_t rule)
+{
+    return ( rule < rule_num ) ? rules [ rule ] .trips : 0;
+}
+
+
+bool Adc_Watch::tripped(uint8_t rule)
+{
+    return ( rule < rule_num ) && rules [ rule ] .tripped;
+}
@@ -0,0 +1,58 @@
+#ifndef __Adc_Watch_H__
+#define __Adc_Watch_H__
+
+#include <stdint.h>
+
+
+//ADCɨĻƽޣDMAѭһɨ(ÿɨ ch_num ͨ)
+//ȫжѸհһ뽻 feed()ÿͨ 2^ADC_WATCH_AVG_SHIFT 㻬ƽ
+//ٰȽϣƽֵ hold ֮(֮)ʱһλصصһ¼
+//ȫ㣬жûгӲڵֱӱ
+
+
+#define ADC_WATCH_CH_MAX        8
+#define ADC_WATCH_AVG_SHIFT     3           //8ƽ
+#define ADC_WATCH_RULE_MAX      12
+
+
+typedef void (*Adc_Watch_Cb)(uint8_t rule, uint16_t avg);      // feed() (ж)
+
+
+class Adc_Watch
+{
+    public:
+    Adc_Watch(uint8_t ch_num);
+    void        feed(const uint16_t *buf, uint16_t frames);             //frames ɨ裬buf ɨ˳
+    int8_t      rule(uint8_t ch, uint16_t level, uint16_t hold, bool above, Adc_Watch_Cb cb);      //عţ˷-1
+    uint16_t    value(uint8_t ch);                                      //ƽ
+    uint16_t    peak(uint8_t ch);                                       //ϴ peak_clear() ƽֵֵ
+    void        peak_clear();
+    uint32_t    trips(uint8_t rule);                                    //ص
+    bool        tripped(uint8_t rule);
+
+    private:
+    struct Rule
+    {
+        uint8_t         ch;
+        bool            above;
+        uint16_t        level;
+        uint16_t        hold;
+        uint16_t        count;          //Խ޵Ĵ
+        bool            tripped;
+        uint32_t        trips;
+        Adc_Watch_Cb    cb;
+    };
+
+    uint8_t         ch_num;
+    uint8_t         rule_num;
+    uint8_t         idx;                //ɵһ
+    bool            primed;
+    uint16_t        hist [ ADC_WATCH_CH_MAX ] [ 1 << ADC_WATCH_AVG_SHIFT ];
+    uint32_t        sum [ ADC_WATCH_CH_MAX ];
+    volatile uint16_t avg [ ADC_WATCH_CH_MAX ];
+    volatile uint16_t avg_peak [ ADC_WATCH_CH_MAX ];
+    Rule            rules [ ADC_WATCH_RULE_MAX ];
+};
+
+
+#endif
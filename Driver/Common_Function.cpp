@@ -1,5 +1,6 @@
 #include "Common_Function.h"
 #include <stdarg.h>
+#include "uart.h"
 
 
 
@@ -48,12 +49,50 @@ static char * itoa( int value, char *string )           //
 
 
 
+struct USART_Out                     //USART_printf壬˻ʱ齻
+{
+	USART_TypeDef * USARTx;
+	UART_DMA_TX   * tx;
+	uint16_t        len;
+	char            buf[64];
+};
+
+static void USART_Out_Flush ( USART_Out * out )
+{
+	uint16_t i;
+	
+	if ( out->tx )
+		out->tx->write ( out->buf, out->len, true );       //DMAͣʱȴ
+	
+	else                                                  //ôûDMAͻֽڷ
+	{
+		for ( i = 0; i < out->len; i++ )
+		{
+			USART_SendData ( out->USARTx, out->buf [ i ] );
+			while ( USART_GetFlagStatus ( out->USARTx, USART_FLAG_TXE ) == RESET );
+		}
+	}
+	out->len = 0;
+}
+
+static void USART_Out_Put ( USART_Out * out, char ch )
+{
+	out->buf [ out->len ++ ] = ch;
+	if ( out->len == sizeof ( out->buf ) )
+		USART_Out_Flush ( out );
+}
+
+
 void USART_printf ( USART_TypeDef * USARTx, char * Data, ... )
 {
 	const char *s;
 	int d;   
 	char buf[16];
+	USART_Out out;
 
+	out.USARTx = USARTx;
+	out.tx = UART_DMA_TX::find ( USARTx );
+	out.len = 0;
 	
 	va_list ap;
 	va_start(ap, Data);
@@ -65,12 +104,12 @@ void USART_printf ( USART_TypeDef * USARTx, char * Data, ... )
 			switch ( *++Data )
 			{
 				case 'r':							          //س
-				USART_SendData(USARTx, 0x0d);
+				USART_Out_Put ( &out, 0x0d );
 				Data ++;
 				break;
 
 				case 'n':							          //з
-				USART_SendData(USARTx, 0x0a);	
+				USART_Out_Put ( &out, 0x0a );	
 				Data ++;
 				break;
 
@@ -88,10 +127,7 @@ void USART_printf ( USART_TypeDef * USARTx, char * Data, ... )
 				s = va_arg(ap, const char *);
 				
 				for ( ; *s; s++) 
-				{
-					USART_SendData(USARTx,*s);
-					while( USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET );
-				}
+					USART_Out_Put ( &out, *s );
 				
 				Data++;
 				
@@ -104,10 +140,7 @@ void USART_printf ( USART_TypeDef * USARTx, char * Data, ... )
 				itoa(d, buf);
 				
 				for (s = buf; *s; s++) 
-				{
-					USART_SendData(USARTx,*s);
-					while( USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET );
-				}
+					USART_Out_Put ( &out, *s );
 				
 				Data++;
 				
@@ -121,11 +154,10 @@ void USART_printf ( USART_TypeDef * USARTx, char * Data, ... )
 			}		 
 		}
 		
-		else USART_SendData(USARTx, *Data++);
-		
-		while ( USART_GetFlagStatus ( USARTx, USART_FLAG_TXE ) == RESET );
+		else USART_Out_Put ( &out, *Data++ );
 		
 	}
+	
+	va_end(ap);
+	USART_Out_Flush ( &out );
 }
-
-
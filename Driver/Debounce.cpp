@@ -0,0 +1,101 @@
+#include "Debounce.h"
+
+
+
+Debounce::Debounce(uint16_t hz)
+{
+    this->hz=hz;
+    line_num = 0;
+}
+
+
+int8_t Debounce::add(uint16_t min_us, uint16_t refract_ms, Debounce_Cb cb)
+{
+    Line *l;
+
+    if ( line_num >= DEB_LINE_MAX )
+        return -1;
+    l = &lines [ line_num ];
+    l->state = IDLE;
+    l->min = ( (uint32_t)min_us * hz + 999999 ) / 1000000;     //ȡٳô
+    l->refract = (uint32_t)refract_ms * hz / 1000;
+    l->count = 0;
+    l->ts = 0;
+    l->cb = cb;
+    l->accepts = 0;
+    l->glitches = 0;
+    l->bounces = 0;
+    return line_num++;
+}
+
+
+void Debounce::edge(uint8_t line, uint32_t ts)
+{
+    Line *l;
+
+    if ( line >= line_num )
+        return;
+    l = &lines [ line ];
+    if ( l->state != IDLE )
+    {
+        l->bounces++;
+        return;
+    }
+    l->state = WAIT;
+    l->count = 0;
+    l->ts = ts;
+}
+
+
+void Debounce::tick(uint8_t active)
+{
+    Line *l;
+    uint8_t i;
+
+    for ( i = 0; i < line_num; i++ )
+    {
+        l = &lines [ i ];
+        switch ( l->state )
+        {
+            case WAIT:
+                if ( ! ( active & ( 1 << i ) ) )        //ûͱȥ
+                {
+                    l->glitches++;
+                    l->state = IDLE;
+                    break;
+                }
+                if ( ++l->count < l->min )
+                    break;
+                l->accepts++;
+                l->state = l->refract ? HOLD : IDLE;
+                l->count = 0;
+                if ( l->cb )
+                    l->cb ( i, l->ts );
+                break;
+            case HOLD:
+                if ( ++l->count >= l->refract )
+                    l->state = IDLE;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+
+uint32_t Debounce::accepts(uint8_t line)
+{
+    return ( line < line_num ) ? lines [ line ] .accepts : 0;
+}
+
+
+uint32_t Debounce::glitches(uint8_t line)
+{
+    return ( line < line_num ) ? lines [ line ] .glitches : 0;
+}
+
+
+uint32_t Debounce::bounces(uint8_t line)
+{
+    return ( line < line_num ) ? lines [ line ] .bounces : 0;
+}
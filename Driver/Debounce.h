@@ -0,0 +1,53 @@
+#ifndef __Debounce_H__
+#define __Debounce_H__
+
+#include <stdint.h>
+
+
+//ⲿжжֻ edge() ʱ̣ϵͳʱжÿ tick() ʱǲЧƽ
+//Чƽ min_us صһ(һصʱ)֮ refract_ms ıضҪ
+//ûͱȥẹ̈ȴҪʱı㶶ֱʱ
+//edge()  tick() ܻ(ͬһռȼ߹ж)
+//ӲϿֱӱ
+
+
+#define DEB_LINE_MAX        8
+
+
+typedef void (*Debounce_Cb)(uint8_t line, uint32_t ts);        // tick() (ʱж)
+
+
+class Debounce
+{
+    public:
+    Debounce(uint16_t hz);
+    int8_t      add(uint16_t min_us, uint16_t refract_ms, Debounce_Cb cb);      //ߺţ˷-1
+    void        edge(uint8_t line, uint32_t ts);                        //ⲿж
+    void        tick(uint8_t active);                                   //nλΪnЧƽ
+    uint32_t    accepts(uint8_t line);                                  //Ĵ
+    uint32_t    glitches(uint8_t line);                                 //Чƽû
+    uint32_t    bounces(uint8_t line);                                  //ȴҪʱı
+
+    private:
+    enum { IDLE, WAIT, HOLD };
+
+    struct Line
+    {
+        uint8_t         state;
+        uint16_t        min;            //ЧƽҪ
+        uint16_t        refract;        //Ҫص
+        uint16_t        count;
+        uint32_t        ts;             //һصʱ
+        Debounce_Cb     cb;
+        volatile uint32_t accepts;
+        volatile uint32_t glitches;
+        volatile uint32_t bounces;
+    };
+
+    uint16_t    hz;
+    uint8_t     line_num;
+    Line        lines [ DEB_LINE_MAX ];
+};
+
+
+#endif
@@ -1,6 +1,7 @@
 #include "ESP8266.h"
 #include <stdarg.h>
 #include "Common_Function.h"
+#include "uart.h"
 #include <stdio.h>  
 
 
@@ -11,19 +12,178 @@ extern "C"
 #include "system.h"
 #include <string.h>  
 #include <stdbool.h>
+#include <includes.h>
 };
 #endif
 
 
 
-STRUCT_USART3_Fram  strEsp8266_Fram_Record = { 0 };
+STRUCT_USART3_Fram  strEsp8266_Fram_Record [ ESP8266_RX_FRAM_NUM ] = { 0 };
+static STRUCT_USART3_Fram * volatile ESP8266_RxFram = &strEsp8266_Fram_Record [ 0 ];        //жд֡
+static char    ESP8266_Reply [ ESP8266_REPLY_LEN ];     //һָӦ𣬿жϰӦڼ֡ʱҲŵ
+static volatile uint16_t ESP8266_ReplyLen = 0;
+static volatile bool ESP8266_ReplyOpen = false; //ָյӦ(OK/ERROR)֮䣬жϰֽڳһݵ ESP8266_Reply
+static OS_Q    ESP8266_FramQ;                   //д֡ϢΪָ֡룬Ϊ֡
+static volatile uint32_t ESP8266_FramLost = 0;
 
+static uint8_t USART3_TX_Buf [ ESP8266_TX_BUF_LEN ];
+static UART_DMA_TX USART3_TX ( USART3, DMA1_Channel2, DMA1_IT_TC2, USART3_TX_Buf, ESP8266_TX_BUF_LEN );     //USART3_Printf DMA
 
+static OS_MUTEX ESP8266_SendMutex;              //ģʽң⡢ָӦ·ڲͬʹģ飬һֻһָ
+static OS_SEM  ESP8266_RxSem;                   //յӦERRORʱɽжϷAT_Cmd ڴ˵ȴ
+static AT_Cmd * ESP8266_At = 0;                 //ǰʹô3AT
+static ESP8266_DataFunc ESP8266_Data = 0;       //+IPD ݵĽպ
+static ESP8266_LinkFunc ESP8266_Link = 0;       //Ӻŵ/Ͽ
+static volatile bool ESP8266_Unvarnish = false; //͸УյֽڲATӦ ESP8266_Data ֱӽ
 
+static void ESP8266_Token(AT_Token tok, const char *p, uint16_t len, void *arg);
+static AT_Parser ESP8266_Parser ( ESP8266_Token, 0 );      //жֽڷִ
 
 
 
-ESP8266::ESP8266(ESP8266_Gpio *ESP8266_gpio)
+
+static void ESP8266_Token(AT_Token tok, const char *p, uint16_t len, void *arg)
+{
+    OS_ERR err;
+
+    if ( tok == AT_TOK_IPD_DATA )                                       //ֱָջ
+    {
+        if ( ESP8266_Data )
+            ESP8266_Data ( ESP8266_Parser .ipd_id(), p, len );
+        return;
+    }
+    if ( ( tok == AT_TOK_LINE ) && ESP8266_Link && ( len >= 8 ) && ( p [ 0 ] >= '0' ) && ( p [ 0 ] <= '4' ) && ( p [ 1 ] == ',' ) )
+    {
+        if ( ( len == 9 ) && ( memcmp ( p + 2, "CONNECT", 7 ) == 0 ) )         //"0,CONNECT FAIL" 
+            ESP8266_Link ( p [ 0 ] - '0', true );
+        else if ( ( len == 8 ) && ( memcmp ( p + 2, "CLOSED", 6 ) == 0 ) )
+            ESP8266_Link ( p [ 0 ] - '0', false );
+    }
+    if ( ESP8266_At && ESP8266_At->on_token ( tok, p, len ) )
+    {
+        ESP8266_ReplyOpen = false;                                      //Ӧ룬һָ֮ǰٸд
+        OSSemPost ( &ESP8266_RxSem, OS_OPT_POST_1, &err );              //ѵȴӦ
+    }
+}
+
+
+static void ESP8266_Reply_Add(char ch)          //ֻڽжеã˺ĲҪʱ'\0'β
+{
+    uint16_t n = ESP8266_ReplyLen;
+
+    if ( ! ESP8266_ReplyOpen || ( n >= ESP8266_REPLY_LEN - 1 ) || ESP8266_Parser .ipd_left() )     //+IPD ݲӦ
+        return;
+    ESP8266_Reply [ n + 1 ] = '\0';                                    //дʱҲԽ
+    ESP8266_Reply [ n ] = ch;
+    ESP8266_ReplyLen = n + 1;
+}
+
+
+static bool ESP8266_Fram_Switch(void)           //ֻڽжеãǰ֡񣬻һеĽд
+{
+    STRUCT_USART3_Fram * pCur = ESP8266_RxFram;
+    STRUCT_USART3_Fram * pNext = 0;
+    OS_ERR  err;
+    uint8_t i;
+
+    for ( i = 0; i < ESP8266_RX_FRAM_NUM; i++ )
+    {
+        if ( strEsp8266_Fram_Record [ i ] .Owner == ESP8266_FRAM_FREE )
+        {
+            pNext = &strEsp8266_Fram_Record [ i ];
+            break;
+        }
+    }
+    if ( pNext == 0 )                           //û꣬дǰ֡
+        return false;
+
+    pNext ->Owner = ESP8266_FRAM_ISR;
+    pNext ->InfAll = 0;
+    pNext ->Data_RX_BUF [ 0 ] = '\0';
+    ESP8266_Parser .rebase ( pNext ->Data_RX_BUF );                     //+IPDȴӾ֡ȥ
+    ESP8266_RxFram = pNext;
+
+    pCur ->InfBit .FramFinishFlag = 1;
+    pCur ->Owner = ESP8266_FRAM_TASK;
+    OSQPost ( &ESP8266_FramQ, pCur, pCur ->InfBit .FramLength, OS_OPT_POST_FIFO, &err );
+    return true;
+}
+
+
+static void ESP8266_Port_Send(const char *str)
+{
+    USART3_Printf ( "%s", str );
+}
+
+static uint32_t ESP8266_Port_Now(void)
+{
+    OS_ERR err;
+    return OSTimeGet ( &err ) * 1000u / OSCfg_TickRate_Hz;
+}
+
+static void ESP8266_Port_Wait(uint32_t ms)
+{
+    OS_ERR  err;
+    OS_TICK ticks = ms * OSCfg_TickRate_Hz / 1000u;
+
+    OSSemPend ( &ESP8266_RxSem, ticks ? ticks : 1, OS_OPT_PEND_BLOCKING, 0, &err );
+}
+
+static void ESP8266_Port_Sleep(uint32_t ms)
+{
+    OS_ERR err;
+    OSTimeDlyHMSM ( 0, 0, 0, ms, OS_OPT_TIME_HMSM_NON_STRICT, &err );
+}
+
+static void ESP8266_Port_RxClear(void)
+{
+    OS_ERR      err;
+    OS_MSG_SIZE size;
+    STRUCT_USART3_Fram * pFram;
+    CPU_SR_ALLOC();
+
+    while ( ( pFram = ( STRUCT_USART3_Fram * ) OSQPend ( &ESP8266_FramQ, 0, OS_OPT_PEND_NON_BLOCKING, &size, 0, &err ) ) != 0 )
+        pFram ->Owner = ESP8266_FRAM_FREE;                              //֮ǰûȡߵ֡Ҫ
+
+    CPU_CRITICAL_ENTER();                                               //жд֡ͷʼֻڷָǰһ
+    pFram = ESP8266_RxFram;
+    pFram ->InfAll = 0;
+    pFram ->Data_RX_BUF [ 0 ] = '\0';
+    ESP8266_Parser .rebase ( pFram ->Data_RX_BUF );                     //ڽյ+IPD˴λ
+    ESP8266_ReplyLen = 0;
+    ESP8266_Reply [ 0 ] = '\0';
+    ESP8266_ReplyOpen = true;
+    CPU_CRITICAL_EXIT();
+    OSSemSet ( &ESP8266_RxSem, 0, &err );
+}
+
+static const char * ESP8266_Port_RxBuf(void)
+{
+    return ESP8266_Reply;
+}
+
+static void ESP8266_Port_Write(const void *buf, uint16_t len)
+{
+    USART3_TX.write ( buf, len, true );
+}
+
+static const AT_Port ESP8266_Port =
+{
+    ESP8266_Port_Send,
+    ESP8266_Port_Now,
+    ESP8266_Port_Wait,
+    ESP8266_Port_Sleep,
+    ESP8266_Port_RxClear,
+    ESP8266_Port_RxBuf,
+    ESP8266_Port_Write,
+};
+
+
+
+
+
+
+ESP8266::ESP8266(ESP8266_Gpio *ESP8266_gpio) : at ( &ESP8266_Port )
 {
     this->gpio=ESP8266_gpio;
 }
@@ -64,6 +224,7 @@ void ESP8266::Init_USART3_IT()
 	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
 	NVIC_Init(&NVIC_InitStructure);
     
+    USART3_TX.inti ( DMA1_Channel2_IRQn, 1, 0 );        //DMAUSART3_Printf Զʹ
     
     USART_Cmd(USART3, ENABLE);
 }
@@ -89,6 +250,16 @@ inline void ESP8266::RST_Reset()
 
 void ESP8266::Init()
 {
+    OS_ERR err;
+    OSSemCreate ( &ESP8266_RxSem, "ESP8266 Rx", 0, &err );
+    OSQCreate ( &ESP8266_FramQ, "ESP8266 Fram", ESP8266_RX_FRAM_NUM, &err );
+    OSMutexCreate ( &ESP8266_SendMutex, "ESP8266 Send", &err );
+    for ( uint8_t i = 0; i < ESP8266_RX_FRAM_NUM; i++ )
+        strEsp8266_Fram_Record [ i ] .Owner = ESP8266_FRAM_FREE;
+    strEsp8266_Fram_Record [ 0 ] .Owner = ESP8266_FRAM_ISR;
+    ESP8266_RxFram = &strEsp8266_Fram_Record [ 0 ];
+    ESP8266_Parser .reset ( strEsp8266_Fram_Record [ 0 ] .Data_RX_BUF );
+    ESP8266_At = &at;
     ESP8266::Init_Gpio();
     ESP8266::Init_USART3_IT();
     ESP8266::RST_Set();
@@ -131,27 +302,7 @@ bool  ESP8266::SentString(FunctionalState EnUnvarnishTx, char * pStr, u32 StrLen
 
 bool ESP8266::Cmd(char * cmd, char * reply1, char * reply2, uint32_t waittime)
 {
-	strEsp8266_Fram_Record .InfBit .FramLength = 0;               //¿ʼµݰ
-
-	USART3_Printf ( "%s\r\n", cmd );
-    
-    
-
-	if ( ( reply1 == 0 ) && ( reply2 == 0 ) )                      //Ҫ
-		return true;
-	
-	delay_ms( waittime );                 //ʱ
-	
-	strEsp8266_Fram_Record .Data_RX_BUF [ strEsp8266_Fram_Record .InfBit .FramLength ]  = '\0';
-    
-	if ( ( reply1 != 0 ) && ( reply2 != 0 ) )
-		return ( ( bool ) strstr ( strEsp8266_Fram_Record .Data_RX_BUF, reply1 ) || ( bool ) strstr ( strEsp8266_Fram_Record .Data_RX_BUF, reply2 ) ); 
- 	
-	else if ( reply1 != 0 )
-		return ( ( bool ) strstr ( strEsp8266_Fram_Record .Data_RX_BUF, reply1 ) );
-	
-	else
-		return ( ( bool ) strstr ( strEsp8266_Fram_Record .Data_RX_BUF, reply2 ) );    
+	return at.exec ( cmd, reply1, reply2, waittime );            //յӦأwaittimeֻΪʱ
 }
 
 
@@ -159,7 +310,7 @@ void ESP8266::Rst()
 {
     
   	 ESP8266::RST_Reset();
-	 delay_ms ( 500 ); 
+	 ESP8266_Port.sleep ( 500 ); 
 	 ESP8266::RST_Set();  
     
 }
@@ -173,7 +324,7 @@ void ESP8266::AT_Test()
    
     CH_PD_Set();
 	RST_Set();	
-	delay_ms ( 1000 );
+	at.exec ( 0, "ready", 0, 1000 );                     //ϵȴģӡready1s
 	while ( count < 10 )
 	{
 		if( ESP8266::Cmd( "AT", "OK", NULL, 500 ) ) return;
@@ -290,14 +441,17 @@ ENUM_Link_Status    ESP8266::Get_LinkStatus_One()
 	if ( ESP8266::Cmd ( "AT+CIPSTATUS", "OK", 0, 500 ) )
 	{
         
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "STATUS:2\r\n" ) )
+		if ( strstr ( ESP8266_Reply, "STATUS:2\r\n" ) )
 			return IP_Get;
 		
-		else if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "STATUS:3\r\n" ) )
+		else if ( strstr ( ESP8266_Reply, "STATUS:3\r\n" ) )
 			return Link_Set;
 		
-		else if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "STATUS:4\r\n" ) )
+		else if ( strstr ( ESP8266_Reply, "STATUS:4\r\n" ) )
 			return Link_Lost;		
+
+		else if ( strstr ( ESP8266_Reply, "STATUS:5\r\n" ) )
+			return AP_Lost;
 	}
 	return Status_Get_Fall;        
 }
@@ -310,27 +464,27 @@ uint8_t  ESP8266::Get_LinkStatus_Mul()
 	uint8_t ucIdLinkStatus = 0x00;	
 	if ( ESP8266::Cmd ( "AT+CIPSTATUS", "OK", 0, 500 ) )
 	{
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "+CIPSTATUS:0," ) )
+		if ( strstr ( ESP8266_Reply, "+CIPSTATUS:0," ) )
 			ucIdLinkStatus |= 0x01;
 		else 
 			ucIdLinkStatus &= ~ 0x01;
 		
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "+CIPSTATUS:1," ) )
+		if ( strstr ( ESP8266_Reply, "+CIPSTATUS:1," ) )
 			ucIdLinkStatus |= 0x02;
 		else 
 			ucIdLinkStatus &= ~ 0x02;
 		
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "+CIPSTATUS:2," ) )
+		if ( strstr ( ESP8266_Reply, "+CIPSTATUS:2," ) )
 			ucIdLinkStatus |= 0x04;
 		else 
 			ucIdLinkStatus &= ~ 0x04;
 		
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "+CIPSTATUS:3," ) )
+		if ( strstr ( ESP8266_Reply, "+CIPSTATUS:3," ) )
 			ucIdLinkStatus |= 0x08;
 		else 
 			ucIdLinkStatus &= ~ 0x08;
 		
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "+CIPSTATUS:4," ) )
+		if ( strstr ( ESP8266_Reply, "+CIPSTATUS:4," ) )
 			ucIdLinkStatus |= 0x10;
 		else 
 			ucIdLinkStatus &= ~ 0x10;	
@@ -345,25 +499,23 @@ bool ESP8266::Get_APIP(char * p_ApIp, uint8_t ArrayLength)
 {   
 	char uc;	
 	char * pCh;	
-    ESP8266::Cmd ( "AT+CIFSR", "OK", 0, 500 );
+    if ( ( ArrayLength == 0 ) || ! ESP8266::Cmd ( "AT+CIFSR", "OK", 0, 500 ) )
+		return 0;
 	
-	pCh = strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "APIP,\"" );
+	pCh = strstr ( ESP8266_Reply, "APIP,\"" );
 	
 	if ( pCh )
 		pCh += 6;
 	else
 		return 0;
-	for ( uc = 0; uc < ArrayLength; uc ++ )
+	for ( uc = 0; uc < ArrayLength - 1; uc ++ )
 	{
-		p_ApIp [ uc ] = * ( pCh + uc);
-		
-		if ( p_ApIp [ uc ] == '\"' )
-		{
-			p_ApIp [ uc ] = '\0';
+		if ( ( pCh [ uc ] == '\"' ) || ( pCh [ uc ] == '\0' ) )
 			break;
-		}
+		p_ApIp [ uc ] = pCh [ uc ];
 	}	
-	return 1;    
+	p_ApIp [ uc ] = '\0';
+	return pCh [ uc ] == '\"';                      //ûкӦŲ
 }
 
 bool ESP8266::UnvarnishSend(FunctionalState ok)
@@ -371,13 +523,16 @@ bool ESP8266::UnvarnishSend(FunctionalState ok)
     if(ok)
     {
         if ( ! ESP8266::Cmd ( "AT+CIPMODE=1", "OK", 0, 500 ) )  return false ;		
-        return ESP8266::Cmd ( "AT+CIPSEND", "OK", ">", 500 );               
+        if ( ! ESP8266::Cmd ( "AT+CIPSEND", "OK", ">", 500 ) )  return false ;
+        ESP8266_Unvarnish = true;
+        return true;
     }
     else
     {
-        delay_ms ( 1000 );
+        ESP8266_Unvarnish = false;
+        ESP8266_Port.sleep ( 1000 );                      //"+++"ǰ豣ִڿ
         USART3_Printf ( "+++" );
-        delay_ms ( 500 );          
+        ESP8266_Port.sleep ( 500 );          
         return 1;
     }    
 }
@@ -385,39 +540,66 @@ bool ESP8266::UnvarnishSend(FunctionalState ok)
 
 char* ESP8266::ReceiveString(FunctionalState EnUnvarnishTx)
 {
+	static STRUCT_USART3_Fram * pFram = 0;          //ϴηص֡´εʱŹ黹
 	char * pRecStr = 0;
 	
-	strEsp8266_Fram_Record .InfBit .FramLength = 0;
-	strEsp8266_Fram_Record .InfBit .FramFinishFlag = 0;
+	if ( pFram )
+		ESP8266::Free_Fram ( pFram );
 	
-	while ( ! strEsp8266_Fram_Record .InfBit .FramFinishFlag );
-	strEsp8266_Fram_Record .Data_RX_BUF [ strEsp8266_Fram_Record .InfBit .FramLength ] = '\0';
+	pFram = ESP8266::Get_Fram ( 0 );
+	if ( pFram == 0 )                               //бɾȴֹ
+		return 0;
 	
-	if ( EnUnvarnishTx )    pRecStr = strEsp8266_Fram_Record .Data_RX_BUF;
+	if ( EnUnvarnishTx )    pRecStr = pFram ->Data_RX_BUF;
 			
 	else 
 	{
-		if ( strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "+IPD" ) )
-			pRecStr = strEsp8266_Fram_Record .Data_RX_BUF;
+		if ( strstr ( pFram ->Data_RX_BUF, "+IPD" ) )
+			pRecStr = pFram ->Data_RX_BUF;
 	}
 	return pRecStr;    
 }
 
 
+STRUCT_USART3_Fram * ESP8266::Get_Fram(uint32_t timeout)
+{
+    OS_ERR      err;
+    OS_MSG_SIZE size;
+    OS_TICK     ticks = timeout * OSCfg_TickRate_Hz / 1000u;
+
+    if ( timeout && ( ticks == 0 ) )
+        ticks = 1;
+    return ( STRUCT_USART3_Fram * ) OSQPend ( &ESP8266_FramQ, ticks, OS_OPT_PEND_BLOCKING, &size, 0, &err );
+}
+
+
+void ESP8266::Free_Fram(STRUCT_USART3_Fram *pFram)
+{
+    if ( pFram )
+        pFram ->Owner = ESP8266_FRAM_FREE;      //һֽڵдùж
+}
+
+
+uint32_t ESP8266::Fram_Lost()
+{
+    return ESP8266_FramLost;
+}
+
+
 
 bool ESP8266::Get_IP(char *p_StaIp)
 {
 	uint8_t uc, ucLen;
 	char * pCh, * pCh1;
     
-    ESP8266::Cmd ( "AT+CWLIF", "OK", 0, 100 );
-	pCh = strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "," );
+    if ( ! ESP8266::Cmd ( "AT+CWLIF", "OK", 0, 100 ) )
+		return 0;
+	pCh1 = strstr ( ESP8266_Reply, "AT+CWLIF\r\r\n" );
+	pCh1 = pCh1 ? pCh1 + 11 : ESP8266_Reply;       //˻(ATE0)ʱӦһо
+	pCh = strchr ( pCh1, ',' );
 	
-	if ( pCh )
-	{
-      pCh1 = strstr ( strEsp8266_Fram_Record .Data_RX_BUF, "AT+CWLIF\r\r\n" ) + 11;
+	if ( pCh && ( pCh - pCh1 <= 15 ) && ! memchr ( pCh1, '\r', pCh - pCh1 ) )    //ҪڵһIP15ַ
 	  ucLen = pCh - pCh1;
-	}
 	else    return 0;
     
 	for ( uc = 0; uc < ucLen; uc ++ )
@@ -459,14 +641,131 @@ void ESP8266::Set_AP_Mode()
 void ESP8266::Set_STA_Mode()
 {
     ESP8266::AT_Test();
-    ESP8266::Set_NetMode( STA );
+    at.submit ( "AT+CWMODE=1", "OK", "no change", 2500, 0, 0 );     //һŶӣӦһͷһ
+    at.submit ( "AT+CIPMUX=0", "OK", 0, 500, 0, 0 );
+    at.process();
     while(! ESP8266::JoinAP(ESP8266_ApSsid, ESP8266_APPwd) );
-    ESP8266::MultipleId(DISABLE);
     while ( !	ESP8266::LinkServer ( ESP8266_NetPro, ESP8266_Link_TcpServer_IP, ESP8266_TcpServer_Port, Single_ID_0 ) );
     while ( ! ESP8266::UnvarnishSend(ENABLE) );
 }
 
 
+void ESP8266::Set_STA_Mux_Mode()
+{
+    ESP8266::AT_Test();
+    at.submit ( "AT+CWMODE=1", "OK", "no change", 2500, 0, 0 );
+    at.submit ( "AT+CIPMODE=0", "OK", 0, 500, 0, 0 );                 //Ӳ͸
+    at.submit ( "AT+CIPMUX=1", "OK", 0, 500, 0, 0 );
+    at.process();
+    while(! ESP8266::JoinAP(ESP8266_ApSsid, ESP8266_APPwd) );
+    while ( !	ESP8266::LinkServer ( TCP, ESP8266_Link_TcpServer_IP, ESP8266_TcpServer_Port, Multiple_ID_0 ) );
+    while ( !	ESP8266::LinkServer ( UDP, ESP8266_Link_TcpServer_IP, ESP8266_UdpServer_Port, Multiple_ID_1 ) );
+}
+
+
+bool ESP8266::Send_Id(ENUM_ID_NO id, const void *buf, uint16_t len, bool wait)
+{
+    OS_ERR err;
+    char   cCmd [ 24 ];
+    bool   ok;
+
+    sprintf ( cCmd, "AT+CIPSEND=%d,%d", id, len );
+    OSMutexPend ( &ESP8266_SendMutex, ESP8266_SEND_TIMEOUT * OSCfg_TickRate_Hz / 1000u + 1, OS_OPT_PEND_BLOCKING, 0, &err );
+    if ( err != OS_ERR_NONE )                                          //
+        return false;
+    ok = at.send_data ( cCmd, buf, len, ESP8266_SEND_TIMEOUT, wait );      //UDPȶԷȷϣSEND OK һ㼸ͻ
+    OSMutexPost ( &ESP8266_SendMutex, OS_OPT_POST_NONE, &err );
+    return ok;
+}
+
+
+ENUM_Link_Status ESP8266::Link_Poll(uint8_t *ids)
+{
+    OS_ERR           err;
+    ENUM_Link_Status st;
+    char             cId [ 16 ];
+    uint8_t          i;
+
+    OSMutexPend ( &ESP8266_SendMutex, 0, OS_OPT_PEND_BLOCKING, 0, &err );
+    st = ESP8266::Get_LinkStatus_One();
+    *ids = 0;
+    if ( st != Status_Get_Fall )
+    {
+        for ( i = 0; i < 5; i++ )                                      //ͬһӦĸӣٷһָ
+        {
+            sprintf ( cId, "+CIPSTATUS:%d,", i );
+            if ( strstr ( ESP8266_Reply, cId ) )
+                *ids |= 1u << i;
+        }
+    }
+    OSMutexPost ( &ESP8266_SendMutex, OS_OPT_POST_NONE, &err );
+    return st;
+}
+
+
+bool ESP8266::Relink_STA_Mux(bool join)
+{
+    OS_ERR err;
+    bool   ok;
+
+    OSMutexPend ( &ESP8266_SendMutex, 0, OS_OPT_PEND_BLOCKING, 0, &err );
+    ok = ( ! join || ESP8266::JoinAP ( ESP8266_ApSsid, ESP8266_APPwd ) )
+      && ESP8266::LinkServer ( TCP, ESP8266_Link_TcpServer_IP, ESP8266_TcpServer_Port, Multiple_ID_0 )        //ŵĻ ALREAY CONNECTҲɹ
+      && ESP8266::LinkServer ( UDP, ESP8266_Link_TcpServer_IP, ESP8266_UdpServer_Port, Multiple_ID_1 );
+    OSMutexPost ( &ESP8266_SendMutex, OS_OPT_POST_NONE, &err );
+    return ok;
+}
+
+
+bool ESP8266::Restart_AP()
+{
+    OS_ERR err;
+    bool   ok;
+
+    OSMutexPend ( &ESP8266_SendMutex, 0, OS_OPT_PEND_BLOCKING, 0, &err );
+    ESP8266::Rst();
+    at.exec ( 0, "ready", 0, 1000 );                                   //ͬ AT_Test()ûȵreadyҲAT
+    ok = ESP8266::Cmd ( "AT", "OK", NULL, 500 )
+      && ESP8266::Set_NetMode ( AP )
+      && ESP8266::Set_APIP ( ESP8266_TcpServer_IP )
+      && ESP8266::BuildAP ( ESP8266_BulitApSsid, ESP8266_BulitApPwd, ESP8266_BulitApEcn )
+      && ESP8266::MultipleId ( ENABLE )
+      && ESP8266::ServerMode ( ENABLE, ESP8266_TcpServer_Port, ESP8266_TcpServer_OverTime );
+    OSMutexPost ( &ESP8266_SendMutex, OS_OPT_POST_NONE, &err );
+    return ok;
+}
+
+
+uint32_t ESP8266::Send_Fails()
+{
+    return at.send_fails();
+}
+
+
+bool ESP8266::Send_Busy()
+{
+    return at.sending();
+}
+
+
+uint16_t ESP8266::Send(const void *buf, uint16_t len)
+{
+    return USART3_TX.write ( buf, len, false );
+}
+
+
+void ESP8266::Set_DataHandler(ESP8266_DataFunc fn)
+{
+    ESP8266_Data = fn;
+}
+
+
+void ESP8266::Set_LinkHandler(ESP8266_LinkFunc fn)
+{
+    ESP8266_Link = fn;
+}
+
+
 void ESP8266::STA_Send(char *str,...)
 {
     char cStr [ 100 ] = { 0 };
@@ -483,22 +782,54 @@ void ESP8266::STA_Send(char *str,...)
 void USART3_IRQHandler()
 {
     uint8_t ucCh;
+    STRUCT_USART3_Fram * pFram;
 	
+    OSIntEnter();       //ж
 	
 	if ( USART_GetITStatus ( USART3, USART_IT_RXNE ) != RESET )
 	{
 		ucCh  = USART_ReceiveData( USART3 );
+		pFram = ESP8266_RxFram;
+		
+		if ( ESP8266_Unvarnish && ESP8266_Data )                                                         //͸ݲֱ֡ӽȥ
+		{
+			ESP8266_Data ( 0, ( const char * ) &ucCh, 1 );
+			pFram = 0;
+		}
+		else if ( pFram ->InfBit .FramLength >= ( RX_BUF_MAX_LEN - 1 ) )                                      //Ԥ1ֽд˻һ
+		{
+			if ( ESP8266_Fram_Switch () )
+				pFram = ESP8266_RxFram;
+			else
+				pFram = 0;
+		}
 		
-		if ( strEsp8266_Fram_Record .InfBit .FramLength < ( RX_BUF_MAX_LEN - 1 ) )                       //Ԥ1ֽд
-			strEsp8266_Fram_Record .Data_RX_BUF [ strEsp8266_Fram_Record .InfBit .FramLength ++ ]  = ucCh;
+		if ( pFram )
+		{
+			pFram ->Data_RX_BUF [ pFram ->InfBit .FramLength ++ ]  = ucCh;
+			pFram ->Data_RX_BUF [ pFram ->InfBit .FramLength ]  = '\0';                                 //ʱֱstrstr
+			ESP8266_Reply_Add ( ucCh );                                                                   // feed ֮ǰֽ֮ǰ״̬жǲ+IPD
+			ESP8266_Parser .feed ( pFram ->InfBit .FramLength );                                          //ÿֽO(1)Ӧ/ڻصи
+		}
+		else if ( ! ESP8266_Unvarnish || ! ESP8266_Data )
+			ESP8266_FramLost ++;                                                                          //֡
 	}
 	 	 
 	if ( USART_GetITStatus( USART3, USART_IT_IDLE ) == SET )                                         //֡(ж)
 	{
-    strEsp8266_Fram_Record .InfBit .FramFinishFlag = 1;		
-    ucCh = USART_ReceiveData( USART3 );                                                  //жϱ־λ(ȶUSART_SRȻUSART_DR)			
-    }	
+		if ( ESP8266_RxFram ->InfBit .FramLength )
+			ESP8266_Fram_Switch ();                                                                     //ûп֡ʱһ֡ں
+		ucCh = USART_ReceiveData( USART3 );                                                  //жϱ־λ(ȶUSART_SRȻUSART_DR)			
+	}	
+    
+    OSIntExit();       //˳ж
 }  ; //֡պ
+
+
+void DMA1_Channel2_IRQHandler()     //USART3DMA
+{
+    USART3_TX.irq();
+}
 }
 #endif
 
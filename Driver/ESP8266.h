@@ -7,13 +7,23 @@
 
 #include "stm32f10x.h"                  // Device header
 #include "gpio.h"
+#include "AT_Cmd.h"
 
 
 //ô3ESP8266ͨ,жϷڶӦ .cpp  ļ
-//֡ʱȹرմж֮ٿ
+// ESP8266_RX_FRAM_NUM ֡джʱдһ龭OSн(Get_Fram)ʱùж
+//ATָ AT_Cmd 淢ͣuC/OS֮ Init()ȴڼ𣬲ռCPU
+//ӷָյ OK/ERRORӦⳭһݣжϰӦгɼ֡Ҳν
+//жϰÿֽڽ AT_Parser ִʣ+IPD ݾ Set_DataHandler() õĺ
+//͸ݺյֽڲٽ֡ͷִʣֱֽӽ
 
 
 #define ESP8266_USART_BAUD_RATE      115200                  //USART3
+#define ESP8266_TX_BUF_LEN           512                     //USART3 DMAͻС
+#define ESP8266_RX_FRAM_NUM          2                       //֡(ƹ)ÿ RX_BUF_MAX_LEN ֽ
+#define ESP8266_REPLY_LEN            512                     //һָӦ(+IPD)ౣֽCIPSTATUS Ҳŵ
+#define ESP8266_SEND_TIMEOUT         100                     //Send_Id() '>' SEND OK ĳʱ(ms)ģʽͻʧ
+                                                             //ռģʱ Send_Id() ҲôãȻ㷢ʧ
 
 
 
@@ -33,6 +43,7 @@
 #define ESP8266_NetPro               TCP                             //Э
 #define ESP8266_Link_TcpServer_IP    "192.168.0.11"                   //Ҫӵķ IP
 #define ESP8266_TcpServer_Port       "8080"                          //ҪӵķĶ˿
+#define ESP8266_UdpServer_Port       "8081"                          //Set_STA_Mux_Mode() UDPңⷢԵĶ˿
 
 
 
@@ -89,6 +100,7 @@ enum ENUM_Link_Status    //
     Link_Set,
     Link_Lost,
     Status_Get_Fall,
+    AP_Lost,                //ûȵ(STATUS:5)
 };
 
 
@@ -108,12 +120,21 @@ struct  STRUCT_USART3_Fram                                  //
 		  __IO uint16_t FramFinishFlag   :1;        // 15   FramFinishFlagռһλ         жϺмӸⲿṩ֡־
 	  } InfBit;
   }; 
-	
+  
+  __IO uint8_t  Owner;                                      //ESP8266_FRAM_FREE / ISR / TASKֻӵ߿Զдһ
 };
 
+#define ESP8266_FRAM_FREE    0                              //УжϿȥд
+#define ESP8266_FRAM_ISR     1                              //жд
+#define ESP8266_FRAM_TASK    2                              //ѽ Free_Fram()
+
+
+//յ   strEsp8266_Fram_Record[].Data_RX_BUF 
+extern STRUCT_USART3_Fram strEsp8266_Fram_Record [ ESP8266_RX_FRAM_NUM ];
+
 
-//յ   strEsp8266_Fram_Record.Data_RX_BUF 
-extern STRUCT_USART3_Fram strEsp8266_Fram_Record;
+typedef void (*ESP8266_DataFunc)(uint8_t id, const char *p, uint16_t len);     //+IPD (idΪӺ)pָջжеãҪ췵
+typedef void (*ESP8266_LinkFunc)(uint8_t id, bool open);                        //ģʽӺid("n,CONNECT")Ͽ("n,CLOSED")же
 
 
 
@@ -125,9 +146,22 @@ class ESP8266
     ESP8266(ESP8266_Gpio *ESP8266_gpio);
     void    Init();
     void    Rst();
-    void    Set_AP_Mode();          //ΪWIFIȵ
+    void    Set_AP_Mode();          //ΪWIFIȵ㣬ӣ(ESP8266_TcpServer_Port)ȿͻ
     void    Set_STA_Mode();         //Ϊͻ˷ݸ(͸ģʽ)
+    void    Set_STA_Mux_Mode();     //Ϊͻ()0ΪTCP(ָӦ)1ΪUDP(ң)
     void    STA_Send(char *str,...);   //STAģʽ
+    void    Set_DataHandler(ESP8266_DataFunc fn);   //͸ģʽյ +IPD ݣ͸ģʽյÿֽ(idΪ0)
+    void    Set_LinkHandler(ESP8266_LinkFunc fn);   //ӺͶϿ֪ͨ
+    uint16_t  Send(const void *buf, uint16_t len);  //͸ģʽ·Ͷ(DMAȴ)Ųʱ0
+    bool    Send_Id(ENUM_ID_NO id, const void *buf, uint16_t len, bool wait);     //ģʽ¾ CIPSEND һݣͬʱãwaitΪʱ SEND OKһָǰٵ
+    uint32_t  Send_Fails();                         //waitΪٵķͺʧܵĴ
+    bool    Send_Busy();                            //waitΪٵķͻûȵ SEND OK(Ҳûʱ)ʱ Send_Id() ȵ
+    ENUM_Link_Status  Link_Poll(uint8_t *ids);      //ѯһ״̬*ids nλΪӺnѽ Send_Id() 
+    bool    Relink_STA_Mux(bool join);              //Set_STA_Mux_Mode() ӲֻһΣjoinΪʱȵ
+    bool    Restart_AP();                           //λģ飬Set_AP_Mode() ֻһ
+    STRUCT_USART3_Fram *  Get_Fram(uint32_t timeout);       //ȴһ֡(ms0Ϊһֱ)ʱ0 Free_Fram()
+    void    Free_Fram(STRUCT_USART3_Fram *pFram);
+    uint32_t  Fram_Lost();                          //ûпֽ֡
     
     
     
@@ -151,6 +185,7 @@ class ESP8266
 
     private:
     ESP8266_Gpio*    gpio;
+    AT_Cmd           at;
     void Init_Gpio();           //ųʼ
     void Init_USART3_IT();      //USART3жϳʼ |ж
     inline void CH_PD_Set();
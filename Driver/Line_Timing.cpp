@@ -0,0 +1,134 @@
+#include "Line_Timing.h"
+
+
+
+Line_Timing::Line_Timing(uint32_t ts_hz, uint16_t grid_mm, uint32_t pair_us)
+{
+    uint8_t i;
+
+    ts_per_us = ts_hz / 1000000;
+    if ( ts_per_us == 0 )
+        ts_per_us = 1;
+    this->grid_mm=grid_mm;
+    this->pair_us=pair_us;
+    head = 0;
+    tail = 0;
+    drop = 0;
+    for ( i = 0; i < LINE_SENSOR_NUM; i++ )
+    {
+        last [ i ] = 0;
+        ival [ i ] = 0;
+        count [ i ] = 0;
+        paired [ i ] = true;                            //ûѹߣ
+    }
+    for ( i = 0; i < LINE_PAIR_NUM; i++ )
+    {
+        dt [ i ] = 0;
+        npair [ i ] = 0;
+    }
+}
+
+
+uint32_t Line_Timing::us(uint32_t ticks)
+{
+    return ticks / ts_per_us;
+}
+
+
+void Line_Timing::push(uint8_t id, uint32_t ts)
+{
+    uint8_t h = head;
+
+    if ( (uint8_t)( h - tail ) >= LINE_RING_SIZE )
+    {
+        drop++;
+        return;
+    }
+    ring_id [ h & ( LINE_RING_SIZE - 1 ) ] = id;
+    ring_ts [ h & ( LINE_RING_SIZE - 1 ) ] = ts;
+    head = h + 1;                                       //дƶ񿴵һ
+}
+
+
+bool Line_Timing::pop(Line_Edge *e)
+{
+    uint8_t t = tail;
+
+    if ( t == head )
+        return false;
+    e->id = ring_id [ t & ( LINE_RING_SIZE - 1 ) ];
+    e->ts = ring_ts [ t & ( LINE_RING_SIZE - 1 ) ];
+    tail = t + 1;
+    return true;
+}
+
+
+int8_t Line_Timing::feed(const Line_Edge *e)
+{
+    uint8_t i, j, pair;
+    uint32_t gap;
+
+    if ( e->id < 1 || e->id > LINE_SENSOR_NUM )
+        return -1;
+    i = e->id - 1;
+    j = i ^ 1;                                          //Ĵ
+    pair = i >> 1;
+
+    if ( count [ i ] )
+        ival [ i ] = us ( e->ts - last [ i ] );         //ʱҲԣֻҪһȦ(72MHzʱ59)
+    last [ i ] = e->ts;
+    count [ i ]++;
+    paired [ i ] = false;
+
+    if ( paired [ j ] )
+        return -1;
+    gap = us ( e->ts - last [ j ] );
+    if ( gap > pair_us )
+        return -1;
+    dt [ pair ] = ( i & 1 ) ? (int32_t)gap : -(int32_t)gap;        //()Ϊ
+    npair [ pair ]++;
+    paired [ i ] = true;
+    paired [ j ] = true;
+    return pair;
+}
+
+
+int32_t Line_Timing::pair_dt(uint8_t pair)
+{
+    return ( pair < LINE_PAIR_NUM ) ? dt [ pair ] : 0;
+}
+
+
+uint32_t Line_Timing::pairs(uint8_t pair)
+{
+    return ( pair < LINE_PAIR_NUM ) ? npair [ pair ] : 0;
+}
+
+
+uint32_t Line_Timing::interval(uint8_t id)
+{
+    return ( id >= 1 && id <= LINE_SENSOR_NUM ) ? ival [ id - 1 ] : 0;
+}
+
+
+uint16_t Line_Timing::speed(uint8_t id)
+{
+    uint32_t v = interval ( id );
+
+    if ( v == 0 )
+        return 0;
+    v = (uint32_t)grid_mm * 1000000u / v;
+    return ( v > 0xFFFF ) ? 0xFFFF : v;
+}
+
+
+uint32_t Line_Timing::edges(uint8_t id)
+{
+    return ( id >= 1 && id <= LINE_SENSOR_NUM ) ? count [ id - 1 ] : 0;
+}
+
+
+uint32_t Line_Timing::drops()
+{
+    return drop;
+}
@@ -0,0 +1,65 @@
+#ifndef __Line_Timing_H__
+#define __Line_Timing_H__
+
+#include <stdint.h>
+
+
+//Ѳߴѹʱ̣TIM7жʱ(CPUڼ) push() λ pop() ʱ˳ feed()
+//ʱEXTIжµĵһأ Debounce ʱ
+//λֻһд(TIM7жϣʹжռȼͬụ)һ()ùж
+//ͬһѹߵļ  (ӱ߳/)һԴѹͬһߵȺ  ˶
+//  ǰ󴫸(12)ʱѹߣʱͬʱѹ
+//  Ҵ(34)ǰʱѹ
+//бʱ߶ѹβһͬһߣٶȲ׼
+//ӲϿֱӱ
+
+
+#define LINE_SENSOR_NUM     4
+#define LINE_RING_SIZE      32          //2
+#define LINE_PAIR_FB        0           //ǰ
+#define LINE_PAIR_LR        1           //
+#define LINE_PAIR_NUM       2
+
+
+struct Line_Edge
+{
+    uint8_t     id;                     // 1~4ͬ Position 
+    uint32_t    ts;                     //ѹʱ(ʱ)
+};
+
+
+class Line_Timing
+{
+    public:
+    Line_Timing(uint32_t ts_hz, uint16_t grid_mm, uint32_t pair_us);
+    void        push(uint8_t id, uint32_t ts);                          //TIM7ж˶
+    bool        pop(Line_Edge *e);
+    int8_t      feed(const Line_Edge *e);                               //һԴѹͬһʱ LINE_PAIR_*򷵻-1
+    int32_t     pair_dt(uint8_t pair);                                  //һԵʱ(us)ǰҼ
+    uint32_t    pairs(uint8_t pair);                                    //ɶԵĴ
+    uint32_t    interval(uint8_t id);                                   //ѹߵļ(us)Ϊ0
+    uint16_t    speed(uint8_t id);                                      //ĳ(mm/s)
+    uint32_t    edges(uint8_t id);
+    uint32_t    drops();                                                //
+
+    private:
+    uint32_t    us(uint32_t ticks);
+
+    uint32_t    ts_per_us;
+    uint16_t    grid_mm;
+    uint32_t    pair_us;                //ѹ߸ñ⻹þͲͬһ
+    volatile uint8_t  ring_id [ LINE_RING_SIZE ];
+    volatile uint32_t ring_ts [ LINE_RING_SIZE ];
+    volatile uint8_t  head;             //ֻ push() д
+    volatile uint8_t  tail;             //ֻ pop() д
+    volatile uint32_t drop;
+    uint32_t    last [ LINE_SENSOR_NUM ];
+    uint32_t    ival [ LINE_SENSOR_NUM ];
+    uint32_t    count [ LINE_SENSOR_NUM ];
+    bool        paired [ LINE_SENSOR_NUM ];     //һѾͶ
+    int32_t     dt [ LINE_PAIR_NUM ];
+    uint32_t    npair [ LINE_PAIR_NUM ];
+};
+
+
+#endif
@@ -0,0 +1,128 @@
+#include "Link_Sup.h"
+
+
+
+Link_Sup::Link_Sup()
+{
+    up=false;
+    started=false;
+    miss=0;
+    due=0;
+    backoff=0;
+    up_since=0;
+    down_since=0;
+    up_total=0;
+    downs=0;
+    reconnects=0;
+    attempts=0;
+    recover_last=0;
+    recover_max=0;
+    recover_sum=0;
+}
+
+
+void Link_Sup::start(uint32_t now, bool up)
+{
+    started = true;
+    miss = 0;
+    if ( up )
+    {
+        up_since = now;
+        due = now + LINK_POLL_MS;
+    }
+    else
+    {
+        down_since = now;
+        due = now;                                      //
+    }
+    this->up = up;
+}
+
+
+uint8_t Link_Sup::next(uint32_t now, uint32_t *wait)
+{
+    if ( ! started )
+    {
+        *wait = LINK_POLL_MS;
+        return LINK_ACT_NONE;
+    }
+    if ( (int32_t)( now - due ) < 0 )                   //ʱƻأֵȽ
+    {
+        *wait = due - now;
+        return LINK_ACT_NONE;
+    }
+    *wait = 0;
+    return up ? LINK_ACT_POLL : LINK_ACT_RECONNECT;
+}
+
+
+void Link_Sup::polled(uint32_t now, bool ok)
+{
+    if ( ! up )
+        return;
+    if ( ok )
+    {
+        miss = 0;
+        due = now + LINK_POLL_MS;
+        return;
+    }
+    if ( miss ++ == 0 )
+        down_since = now;
+    if ( miss < LINK_MISS_MAX )
+    {
+        due = now + LINK_MISS_RETRY;
+        return;
+    }
+
+    up = false;                                         //Ͽϵһ
+    downs ++;
+    up_total += down_since - up_since;
+    backoff = 0;
+    due = now;
+}
+
+
+void Link_Sup::reconnected(uint32_t now, bool ok)
+{
+    if ( up )
+        return;
+    attempts ++;
+    if ( ! ok )
+    {
+        backoff = ( backoff == 0 ) ? LINK_BACKOFF_MIN : ( ( backoff >= LINK_BACKOFF_MAX / 2 ) ? LINK_BACKOFF_MAX : backoff * 2 );
+        due = now + backoff;
+        return;
+    }
+
+    reconnects ++;
+    recover_last = now - down_since;
+    if ( recover_last > recover_max )
+        recover_max = recover_last;
+    recover_sum += recover_last;
+    backoff = 0;
+    miss = 0;
+    up_since = now;
+    due = now + LINK_POLL_MS;
+    up = true;
+}
+
+
+bool Link_Sup::is_up()
+{
+    return up;
+}
+
+
+void Link_Sup::stat(uint32_t now, Link_Stat *out)
+{
+    out->up = up;
+    out->uptime = up ? now - up_since : 0;
+    out->up_total = up_total + out->uptime;
+    out->downs = downs;
+    out->reconnects = reconnects;
+    out->attempts = attempts;
+    out->recover_last = recover_last;
+    out->recover_max = recover_max;
+    out->recover_avg = reconnects ? recover_sum / reconnects : 0;
+    out->backoff = backoff;
+}
@@ -0,0 +1,68 @@
+#ifndef __Link_Sup_H__
+#define __Link_Sup_H__
+
+#include <stdint.h>
+
+
+//·ӣʱÿ LINK_POLL_MS ѯһ״̬(һ AT+CIPSTATUS) LINK_MISS_MAX βͨϿ
+//Ͽʧһεȴʱӱ(LINK_BACKOFF_MIN~LINK_BACKOFF_MAX)ȵ㳤ʱ䲻ʱһֱռģ
+//ֻʲôʱѯʲôʱͳƣѯɵԼңͿ񲻵
+//Ӳϵģ⹤(Tools/Link_Sim)ֱӱ뱾ļ
+
+
+#define LINK_POLL_MS         1000            //ʱĲѯ(ms)
+#define LINK_MISS_RETRY      200             //ѯͨٲ(ms)
+#define LINK_MISS_MAX        2               //βͨϿżһӦʱ
+#define LINK_BACKOFF_MIN     500             //һʧܺȴ(ms)
+#define LINK_BACKOFF_MAX     8000            //ȵٵôãһȵʱָܻ
+
+#define LINK_ACT_NONE        0               //ûʱ
+#define LINK_ACT_POLL        1               //ѯ״̬ polled()
+#define LINK_ACT_RECONNECT   2               //һΣ reconnected()
+
+
+struct Link_Stat
+{
+    bool        up;
+    uint32_t    uptime;             //ϵ(ms)ϿʱΪ0
+    uint32_t    up_total;           //ۼŵʱ(ms)
+    uint32_t    downs;              //Ͽ
+    uint32_t    reconnects;         //ɹ
+    uint32_t    attempts;           //Դ(ɹ)
+    uint32_t    recover_last;       //һδӲѯͨɹ(ms)
+    uint32_t    recover_max;
+    uint32_t    recover_avg;
+    uint32_t    backoff;            //ǰȴʱ(ms)
+};
+
+
+class Link_Sup
+{
+    public:
+    Link_Sup();
+    void        start(uint32_t now, bool up);           //ӽã֮ǰ next() ʲôҲ
+    uint8_t     next(uint32_t now, uint32_t *wait);     //ڸʲôLINK_ACT_NONE ʱ *wait Ϊһµʱ(ms)
+    void        polled(uint32_t now, bool ok);
+    void        reconnected(uint32_t now, bool ok);
+    bool        is_up();
+    void        stat(uint32_t now, Link_Stat *out);
+
+    private:
+    volatile bool   up;
+    bool            started;
+    uint8_t         miss;           //ͨĲѯ
+    uint32_t        due;            //һµʱ
+    uint32_t        backoff;
+    uint32_t        up_since;
+    uint32_t        down_since;     //һβѯͨʱ䣬ָʱ
+    uint32_t        up_total;
+    uint32_t        downs;
+    uint32_t        reconnects;
+    uint32_t        attempts;
+    uint32_t        recover_last;
+    uint32_t        recover_max;
+    uint32_t        recover_sum;
+};
+
+
+#endif
@@ -0,0 +1,46 @@
+#include "Mecanum.h"
+
+
+
+Mecanum::Mecanum(int16_t duty_max)
+{
+    this->duty_max=duty_max;
+    sats=0;
+}
+
+
+bool Mecanum::solve(int16_t vx, int16_t vy, int16_t w, int16_t duty[MEC_WHEEL_NUM])
+{
+    int32_t d [ MEC_WHEEL_NUM ], m = 0, a;
+    uint8_t i;
+
+    d [ 0 ] = (int32_t)vy + vx - w;
+    d [ 1 ] = (int32_t)vy - vx + w;
+    d [ 2 ] = (int32_t)vy - vx - w;
+    d [ 3 ] = (int32_t)vy + vx + w;
+
+    for ( i = 0; i < MEC_WHEEL_NUM; i++ )
+    {
+        a = ( d [ i ] < 0 ) ? -d [ i ] : d [ i ];
+        if ( a > m )
+            m = a;
+    }
+
+    if ( m <= duty_max )
+    {
+        for ( i = 0; i < MEC_WHEEL_NUM; i++ )
+            duty [ i ] = d [ i ];
+        return false;
+    }
+
+    for ( i = 0; i < MEC_WHEEL_NUM; i++ )                   //Ǹ duty_max룬ᳬ
+        duty [ i ] = ( d [ i ] * duty_max + ( ( d [ i ] < 0 ) ? -m / 2 : m / 2 ) ) / m;
+    sats ++;
+    return true;
+}
+
+
+uint32_t Mecanum::saturations()
+{
+    return sats;
+}
@@ -0,0 +1,32 @@
+#ifndef __Mecanum_H__
+#define __Mecanum_H__
+
+#include <stdint.h>
+
+
+//ķ˶ѧٶ(vx Ϊvy ǰΪw ʱΪ)ĸӴŵռձ
+//Ӱ X ΰװ(/ķͼ)±0~3Ӧ TIM3/TIM4  CH1~CH4ǰ ǰ  Һ
+//  ǰ = vy + vx - w    ǰ = vy - vx + w
+//   = vy - vx - w    Һ = vy + vx + w
+//w ĵλҲռձȣԭתʱÿӵռձȣߴ粻֪
+//ӳ duty_max ʱĸӰͬһСϳɵ˶ת뾶䣬ֻǱ
+//ֻ㣬Ӳ
+
+
+#define MEC_WHEEL_NUM       4
+
+
+class Mecanum
+{
+    public:
+    Mecanum(int16_t duty_max);
+    bool        solve(int16_t vx, int16_t vy, int16_t w, int16_t duty[MEC_WHEEL_NUM]);    //Сtrue
+    uint32_t    saturations();                          //СĴ
+
+    private:
+    int16_t     duty_max;
+    uint32_t    sats;
+};
+
+
+#endif
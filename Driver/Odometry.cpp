@@ -0,0 +1,102 @@
+#include "Odometry.h"
+
+
+static const uint16_t Odom_Sin [ 65 ] =         //ķ֮һȦ sin*3276864ΣԲֵ
+{
+        0,   804,  1608,  2411,  3212,  4011,  4808,  5602,
+     6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+    12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+    18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+    23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+    27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+    30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+    32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+    32768,
+};
+
+
+
+Odometry::Odometry(uint32_t nm_per_count, uint16_t rot_mm, uint16_t hz)
+{
+    this->nm_per_count=nm_per_count;
+    this->hz=hz;
+    th_per_count = ( (uint64_t)nm_per_count << 40 ) / ( 25132741ull * rot_mm );        //2^32/(8 rot)8*1e6 Լ 25132741
+    reset();
+}
+
+
+void Odometry::reset()
+{
+    uint8_t i;
+
+    x_nm = 0;
+    y_nm = 0;
+    theta = 0;
+    vx = 0;
+    vy = 0;
+    w = 0;
+    for ( i = 0; i < ODOM_WHEEL_NUM; i++ )
+        wheel [ i ] = 0;
+}
+
+
+int32_t Odometry::sin_q15(uint32_t a)
+{
+    uint32_t r = a & 0x3FFFFFFF, idx, frac;
+    int32_t  v;
+
+    if ( a & 0x40000000 )                       //ڶ޵Ų
+        r = 0x40000000 - r;
+    idx = r >> 24;
+    frac = ( r >> 8 ) & 0xFFFF;
+    v = Odom_Sin [ idx ];
+    if ( idx < 64 )
+        v += ( ( Odom_Sin [ idx + 1 ] - v ) * (int32_t)frac ) >> 16;
+    return ( a & 0x80000000 ) ? -v : v;
+}
+
+
+void Odometry::update(const int16_t count[ODOM_WHEEL_NUM])
+{
+    int32_t  fx, fy, fw, dth, s, c;
+    int64_t  dx, dy;
+    uint32_t mid;
+    uint8_t  i;
+
+    fy = (int32_t)count [ 0 ] + count [ 1 ] + count [ 2 ] + count [ 3 ];
+    fx = (int32_t)count [ 0 ] - count [ 1 ] - count [ 2 ] + count [ 3 ];
+    fw = - (int32_t)count [ 0 ] + count [ 1 ] - count [ 2 ] + count [ 3 ];
+
+    dx = (int64_t)fx * nm_per_count / 4;                        //ڵλ(nm)
+    dy = (int64_t)fy * nm_per_count / 4;
+    dth = (int32_t)( ( (int64_t)fw * (int64_t)th_per_count ) >> 8 );
+
+    mid = theta + (uint32_t)( dth / 2 );                        //мĺתԭ
+    s = sin_q15 ( mid );
+    c = sin_q15 ( mid + 0x40000000 );
+    x_nm += ( dx * c - dy * s ) >> 15;
+    y_nm += ( dx * s + dy * c ) >> 15;
+    theta += (uint32_t)dth;
+
+    for ( i = 0; i < ODOM_WHEEL_NUM; i++ )
+        wheel [ i ] = (int16_t)( (int64_t)count [ i ] * nm_per_count * hz / 1000000 );
+    vx = (int16_t)( dx * hz / 1000000 );
+    vy = (int16_t)( dy * hz / 1000000 );
+    w = (int16_t)( ( (int64_t)dth * hz * 6283 ) >> 32 );        //2^32 һȦ mrad
+}
+
+
+void Odometry::get(Odom_Pose *out)
+{
+    uint8_t i;
+
+    out->x_mm = (int32_t)( x_nm / 1000000 );
+    out->y_mm = (int32_t)( y_nm / 1000000 );
+    out->theta = theta;
+    out->theta_mrad = (int16_t)( ( (int64_t)(int32_t)theta * 6283 ) >> 32 );
+    out->vx = vx;
+    out->vy = vy;
+    out->w = w;
+    for ( i = 0; i < ODOM_WHEEL_NUM; i++ )
+        out->wheel [ i ] = wheel [ i ];
+}
@@ -0,0 +1,55 @@
+#ifndef __Odometry_H__
+#define __Odometry_H__
+
+#include <stdint.h>
+
+
+//ķ̼ƣÿڽĸļ仯١ٶȣֳλ(λ)
+//˳ͬ Mecanum.hǰ ǰ  ҺǰתΪ(װɵ߸ķ)
+//  vy = ( ǰ + ǰ +  + Һ ) / 4    vx = ( ǰ - ǰ -  + Һ ) / 4
+//  w  = ( -ǰ + ǰ -  + Һ ) / 4 / rot        rot Ϊǰ־һ־һ
+//λԳϵʱΪԭ㣬y Ϊʱͷx ңʱΪ2^32 ΪһȦȻ
+//ȫ㣬תòң֮úеתڶʱж
+//ӲҲֱӱ
+
+
+#define ODOM_WHEEL_NUM      4
+
+
+struct Odom_Pose
+{
+    int32_t     x_mm;
+    int32_t     y_mm;
+    int16_t     theta_mrad;         //-3142~3141
+    uint32_t    theta;              //2^32 ΪһȦ
+    int16_t     vx;                 //ٶ(mm/s)Ϊ
+    int16_t     vy;                 //ǰΪ
+    int16_t     w;                  //mrad/sʱΪ
+    int16_t     wheel [ ODOM_WHEEL_NUM ];   //(mm/s)
+};
+
+
+class Odometry
+{
+    public:
+    Odometry(uint32_t nm_per_count, uint16_t rot_mm, uint16_t hz);
+    void        update(const int16_t count[ODOM_WHEEL_NUM]);       //һÿӵļ仯
+    void        get(Odom_Pose *out);
+    void        reset();
+    static int32_t sin_q15(uint32_t a);                             //a Ϊ 2^32 һȦ sin*32768
+
+    private:
+    uint32_t    nm_per_count;       //תһ߹ľ(nm)
+    uint64_t    th_per_count;       //w ÿתĽǶ(2^32 һȦQ8)
+    uint16_t    hz;
+    int64_t     x_nm;
+    int64_t     y_nm;
+    uint32_t    theta;
+    int16_t     vx;
+    int16_t     vy;
+    int16_t     w;
+    int16_t     wheel [ ODOM_WHEEL_NUM ];
+};
+
+
+#endif
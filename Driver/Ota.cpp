@@ -0,0 +1,222 @@
+#include "Ota.h"
+
+
+
+static const uint32_t Ota_Crc_Tab [ 16 ] =          //ֽڲ64ֽڣҲͬһű
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+
+static uint32_t Ota_Get32(const uint8_t *p)
+{
+    return p [ 0 ] | ( p [ 1 ] << 8 ) | ( (uint32_t)p [ 2 ] << 16 ) | ( (uint32_t)p [ 3 ] << 24 );
+}
+
+static void Ota_Put32(uint8_t *p, uint32_t v)
+{
+    p [ 0 ] = v;
+    p [ 1 ] = v >> 8;
+    p [ 2 ] = v >> 16;
+    p [ 3 ] = v >> 24;
+}
+
+
+
+
+Ota::Ota(const Ota_Flash *flash)
+{
+    this->flash=flash;
+    state=OTA_STATE_IDLE;
+    size=0;
+    crc=0;
+    chunks=0;
+    next=0;
+    pos=0;
+    clean_from=0;
+    errors=0;
+    gaps=0;
+}
+
+
+uint32_t Ota::crc32(uint32_t crc, const uint8_t *p, uint32_t len)
+{
+    crc = ~crc;
+    while ( len-- )
+    {
+        crc ^= *p++;
+        crc = ( crc >> 4 ) ^ Ota_Crc_Tab [ crc & 0x0F ];
+        crc = ( crc >> 4 ) ^ Ota_Crc_Tab [ crc & 0x0F ];
+    }
+    return ~crc;
+}
+
+
+uint32_t Ota::flash_crc(uint32_t addr, uint32_t len)
+{
+    uint32_t c = 0;
+    uint16_t n;
+
+    while ( len )
+    {
+        n = ( len > sizeof ( buf ) ) ? sizeof ( buf ) : len;
+        flash->read ( addr, buf, n );
+        c = crc32 ( c, buf, n );
+        addr += n;
+        len -= n;
+    }
+    return c;
+}
+
+
+void Ota::mark(uint32_t offset)
+{
+    uint8_t zero = 0x00;
+
+    flash->write ( OTA_HDR_ADDR + offset, &zero, 1 );
+}
+
+
+uint8_t Ota::begin(uint32_t size, uint32_t crc)
+{
+    uint16_t i;
+
+    if ( ( size == 0 ) || ( size > OTA_IMG_MAX ) )
+        return TLM_RES_BAD_ARG;
+
+    this->size = size;
+    this->crc = crc;
+    chunks = ( size + OTA_CHUNK - 1 ) / OTA_CHUNK;
+    errors = 0;
+    gaps = 0;
+
+    flash->read ( OTA_HDR_ADDR, buf, OTA_HDR_DONE + 1 );
+    if ( ( Ota_Get32 ( &buf [ 0 ] ) == OTA_MAGIC ) && ( Ota_Get32 ( &buf [ 4 ] ) == size ) && ( Ota_Get32 ( &buf [ 8 ] ) == crc )
+      && ( buf [ OTA_HDR_DONE ] == 0xFF ) )                 //ͬһ񣬻ûװϣ
+    {
+        if ( buf [ OTA_HDR_READY ] == 0x00 )
+        {
+            next = chunks;
+            pos = size;
+            state = OTA_STATE_READY;
+            return TLM_RES_OK;
+        }
+        flash->read ( OTA_HDR_ADDR + OTA_HDR_CHUNKS, buf, chunks );
+        for ( i = 0; ( i < chunks ) && ( buf [ i ] == 0x00 ); i++ )
+            ;
+        next = i;
+        pos = (uint32_t)next * OTA_CHUNK;
+        clean_from = OTA_CHUNK_MAX;                         //Ŀдһ룬ʼдʱٲ
+        state = OTA_STATE_RECEIVING;
+        return TLM_RES_OK;
+    }
+
+    flash->erase ( OTA_HDR_ADDR, OTA_CHUNK );
+    flash->erase ( OTA_IMG_ADDR, (uint32_t)chunks * OTA_CHUNK );
+    Ota_Put32 ( &buf [ 0 ], OTA_MAGIC );
+    Ota_Put32 ( &buf [ 4 ], size );
+    Ota_Put32 ( &buf [ 8 ], crc );
+    flash->write ( OTA_HDR_ADDR, buf, 12 );
+    next = 0;
+    pos = 0;
+    clean_from = 0;
+    state = OTA_STATE_RECEIVING;
+    return TLM_RES_OK;
+}
+
+
+bool Ota::data(uint32_t offset, const uint8_t *p, uint16_t len)
+{
+    uint16_t idx, n;
+
+    if ( state != OTA_STATE_RECEIVING )
+        return false;
+    if ( ( offset != pos ) || ( offset + len > size ) )
+    {
+        gaps ++;
+        return false;
+    }
+
+    while ( len )
+    {
+        if ( pos % OTA_CHUNK == 0 )                         //µһ
+        {
+            idx = pos / OTA_CHUNK;
+            if ( idx < clean_from )
+                flash->erase ( OTA_IMG_ADDR + pos, OTA_CHUNK );
+            if ( clean_from < idx + 1 )
+                clean_from = idx + 1;
+        }
+        n = OTA_CHUNK - pos % OTA_CHUNK;
+        if ( n > len )
+            n = len;
+        flash->write ( OTA_IMG_ADDR + pos, p, n );
+        pos += n;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+
+bool Ota::chunk(uint16_t index, uint32_t crc)
+{
+    uint32_t start, end;
+
+    if ( state != OTA_STATE_RECEIVING )
+        return false;
+    if ( index < next )                                     //ѾУط
+        return true;
+    if ( index > next )
+        return false;
+
+    start = (uint32_t)index * OTA_CHUNK;
+    end = ( start + OTA_CHUNK < size ) ? start + OTA_CHUNK : size;
+    if ( ( pos != end ) || ( flash_crc ( OTA_IMG_ADDR + start, end - start ) != crc ) )
+    {
+        if ( pos == end )
+            errors ++;
+        pos = start;                                        //һclean_from Ѿ棬ʼдʱȲ
+        return false;
+    }
+    mark ( OTA_HDR_CHUNKS + index );
+    next ++;
+    return true;
+}
+
+
+bool Ota::commit()
+{
+    if ( state == OTA_STATE_READY )
+        return true;
+    if ( ( state != OTA_STATE_RECEIVING ) || ( next != chunks ) )
+        return false;
+    if ( flash_crc ( OTA_IMG_ADDR, size ) != crc )
+    {
+        state = OTA_STATE_FAILED;
+        return false;
+    }
+    mark ( OTA_HDR_READY );
+    state = OTA_STATE_READY;
+    return true;
+}
+
+
+void Ota::abort()
+{
+    if ( state == OTA_STATE_RECEIVING )                     //ݴ begin() ͬһ
+        state = OTA_STATE_IDLE;
+}
+
+
+void Ota::status(Tlm_Ota *out)
+{
+    out->state = state;
+    out->op = TLM_OTA_STATUS;
+    out->arg = 0;
+    out->next = next;
+    out->chunks = chunks;
+    out->errors = errors;
+    out->gaps = gaps;
+}
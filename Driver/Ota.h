@@ -0,0 +1,75 @@
+#ifndef __Ota_H__
+#define __Ota_H__
+
+#include <stdint.h>
+#include "Telemetry.h"
+
+
+//OTAԾESP8266³дW25Q64ݴ(OTA_CHUNK)ضУCRC32ߺӵһûУĿ
+//УͨݴϢǣλ(Boot/Boot.c)ڲflash
+//ݱ밴˳򵽣ƫƲλõݶԿ״̬ next һط
+//Ӳflashд Ota_Flash ṩϵģ⹤(Tools/Ota_Sim)ֱӱ뱾ļ
+//
+//ݴϢ(OTA_HDR_ADDR)ֻڿʼ¾ʱ֮ıǶǰ0xFFд0x00ٲ
+//  0   magic(4) (4) CRC32(4)
+//  16  0x00УͨҪ
+//  17  0x00ѿ
+//  18  0x00ʼˣ֮ڲflashĳҪCRC32Եϲ
+//  256 ÿһֽڣ0x00 ʾһѻضУͨ()
+
+
+#define OTA_CHUNK           4096            //У顢ĵλW25Q64һ
+#define OTA_IMG_ADDR        0x700000        //W25Q64ϵݴ64K
+#define OTA_IMG_MAX         0x7C000         //ڲflash 512K ȥ16K
+#define OTA_HDR_ADDR        0x7F0000
+#define OTA_CHUNK_MAX       ( OTA_IMG_MAX / OTA_CHUNK )
+#define OTA_MAGIC           0x3141544F      //"OTA1"
+#define OTA_HDR_READY       16
+#define OTA_HDR_DONE        17
+#define OTA_HDR_CHUNKS      256
+#define OTA_APP_ADDR        0x08004000      //Ӧóڲflashʼַռǰ16K
+
+#define OTA_STATE_IDLE      0
+#define OTA_STATE_RECEIVING 1
+#define OTA_STATE_READY     2               //Уͨȸλ
+#define OTA_STATE_FAILED    3               //У鲻Ҫ begin()
+
+
+struct Ota_Flash
+{
+    void    (*erase)(uint32_t addr, uint32_t len);                      //addrlen4K룬64KĲֿ
+    void    (*write)(uint32_t addr, const uint8_t *buf, uint16_t len);  //дѲ򣬿Կҳ
+    void    (*read)(uint32_t addr, uint8_t *buf, uint16_t len);
+};
+
+
+class Ota
+{
+    public:
+    Ota(const Ota_Flash *flash);
+    uint8_t     begin(uint32_t size, uint32_t crc);     //ȺCRCݴͬʱ(һ) TLM_RESULT
+    bool        data(uint32_t offset, const uint8_t *p, uint16_t len);     //λõĶfalse
+    bool        chunk(uint16_t index, uint32_t crc);    //һضУ飬ʧܾͻصһĿͷ
+    bool        commit();                               //п鶼УУһΣͨǸ
+    void        abort();
+    void        status(Tlm_Ota *out);                  //op  TLM_OTA_STATUSarg 0ظĳָʱ߸ĵ
+    static uint32_t crc32(uint32_t crc, const uint8_t *p, uint32_t len);   //ͬ zlib  crc32()ֵ0һεĽԽ
+
+    private:
+    const Ota_Flash *   flash;
+    uint8_t             state;
+    uint32_t            size;
+    uint32_t            crc;
+    uint16_t            chunks;
+    uint16_t            next;           //һûУĿ
+    uint32_t            pos;            //һֽ
+    uint16_t            clean_from;     //һǲ
+    uint16_t            errors;
+    uint16_t            gaps;
+    uint8_t             buf [ 256 ];    //ضУ
+    uint32_t    flash_crc(uint32_t addr, uint32_t len);
+    void        mark(uint32_t offset);
+};
+
+
+#endif
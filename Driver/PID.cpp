@@ -0,0 +1,111 @@
+#include "PID.h"
+
+
+
+PID::PID(int32_t kp, int32_t ki, int32_t kd, int32_t out_min, int32_t out_max, uint8_t mode)
+{
+    this->mode=mode;
+    this->kp=kp;
+    this->ki=ki;
+    this->kd=kd;
+    this->out_min=out_min;
+    this->out_max=out_max;
+    sats=0;
+    reset(0,0);
+}
+
+
+void PID::gains(int32_t kp, int32_t ki, int32_t kd)
+{
+    this->kp = kp;
+    this->ki = ki;
+    this->kd = kd;
+}
+
+
+void PID::limits(int32_t out_min, int32_t out_max)
+{
+    this->out_min = out_min;
+    this->out_max = out_max;
+}
+
+
+void PID::reset(int32_t meas, int32_t out)
+{
+    integ = (int64_t)out << PID_Q;                              //ַʽû(ۼ)ڵ
+    last_err = 0;
+    last_meas = meas;
+    prev_meas = meas;
+    this->out = out;
+}
+
+
+int32_t PID::update(int32_t goal, int32_t meas, int32_t ff)
+{
+    int64_t e, lo, hi, u, f, cand;
+
+    e = (int64_t)goal - meas;
+    lo = (int64_t)out_min << PID_Q;
+    hi = (int64_t)out_max << PID_Q;
+    f = (int64_t)ff << PID_Q;
+
+    if ( mode == PID_MODE_INC )
+    {
+        integ += kp * ( e - last_err ) + ki * e
+               - kd * ( (int64_t)meas - 2 * (int64_t)last_meas + prev_meas );       //΢ֶԲֵĿͻ䲻
+        u = integ + f;
+        if ( u > hi )                                           //ۼֵ޷ֱ
+        {
+            integ = hi - f;
+            u = hi;
+            sats ++;
+        }
+        else if ( u < lo )
+        {
+            integ = lo - f;
+            u = lo;
+            sats ++;
+        }
+        last_err = (int32_t)e;
+    }
+    else
+    {
+        u = kp * e - kd * ( (int64_t)meas - last_meas ) + f;   //΢֡ǰ
+        cand = integ + ki * e;
+        if ( cand > hi )                                        //Χ
+            cand = hi;
+        else if ( cand < lo )
+            cand = lo;
+        if ( ( ( u + cand > hi ) && ( e > 0 ) ) || ( ( u + cand < lo ) && ( e < 0 ) ) )
+            cand = integ;                                       //Ѿͣͬһ߻ͣ
+        integ = cand;
+        u += integ;
+        if ( u > hi )
+        {
+            u = hi;
+            sats ++;
+        }
+        else if ( u < lo )
+        {
+            u = lo;
+            sats ++;
+        }
+    }
+
+    prev_meas = last_meas;
+    last_meas = meas;
+    out = (int32_t)( ( u + ( 1 << ( PID_Q - 1 ) ) ) >> PID_Q );
+    return out;
+}
+
+
+int32_t PID::output()
+{
+    return out;
+}
+
+
+uint32_t PID::saturations()
+{
+    return sats;
+}
@@ -1,10 +1,27 @@
 #ifndef __PID_H_
 #define __PID_H_
 
-/*****PID******/
-#define Proportion		0.1			//(Kp)
-#define Integral			0.001		//ֳ(Ki)	Ki=(Kp*T)/Ti
-#define Derivative		0.001		//΢ֳ(Kd)	Kd=(Kp*Td)/T
+#include <stdint.h>
+
+
+//PIDڣÿƻ·һʵQ16(F103ûFPUÿһ)
+//롢λɵ߶(mm/sռձȳ)ΪQ16 PID_K() дСʱ
+//λʽ޷ʱֹͣ(ֱ)΢ֻԲֵ(Ŀͻʱ)޷ǰ
+//ʽͬԭ PID.cÿı仯ۼӣ޷Ͳֱͣ΢ֻͬԲֵ
+//ӲϵĶԱȹ(Tools/Pid_Bench)ֱӱ뱾ļ
+//̼ﻹûϣǿռձ(Move_Vel -> б -> PWM)ٱջʱڿÿһʵ
+
+
+#define PID_Q               16
+#define PID_K(x)            ( (int32_t)( (x) * 65536.0 + ( ( (x) < 0 ) ? -0.5 : 0.5 ) ) )     //С滻Q16ֻڳ
+
+#define PID_MODE_POS        0               //λʽ
+#define PID_MODE_INC        1               //ʽ
+
+/*****Ĭϲ(ԭ PID.c)******/
+#define PID_KP_DEFAULT      PID_K ( 0.1 )       //(Kp)
+#define PID_KI_DEFAULT      PID_K ( 0.001 )     //ֳ(Ki)	Ki=(Kp*T)/Ti
+#define PID_KD_DEFAULT      PID_K ( 0.001 )     //΢ֳ(Kd)	Kd=(Kp*Td)/T
 /*********************/
 
 
@@ -22,19 +39,31 @@
 ******************/
 
 
+class PID
+{
+    public:
+    PID(int32_t kp, int32_t ki, int32_t kd, int32_t out_min, int32_t out_max, uint8_t mode);
+    void        gains(int32_t kp, int32_t ki, int32_t kd);             //Q16(Ki=Kp*T/TiKd=Kp*Td/T)
+    void        limits(int32_t out_min, int32_t out_max);
+    void        reset(int32_t meas, int32_t out);                      //ӵǰֵŶؽ(ֶԶ)
+    int32_t     update(int32_t goal, int32_t meas, int32_t ff);        //ÿڵһΣff ΪǰֱӼ
+    int32_t     output();
+    uint32_t    saturations();                                          //޷Ĵ
 
-
-
-/*******************
-  PID_Out
-ܣPIDڲҷӦڵֵ
-goal_pointĿֵread_pointȡʵֵ
-أӦڵʵֵ
-*******************/
-
-float PID_Out(float goal_point,float read_point);	 
-
+    private:
+    uint8_t     mode;
+    int32_t     kp;
+    int32_t     ki;
+    int32_t     kd;
+    int32_t     out_min;
+    int32_t     out_max;
+    int64_t     integ;          //λʽʽǰ(Q16)
+    int32_t     last_err;       //ʽ
+    int32_t     last_meas;
+    int32_t     prev_meas;      //ʽ΢ҪǰĲֵ
+    int32_t     out;
+    uint32_t    sats;
+};
 
 
 #endif
-
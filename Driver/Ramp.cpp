@@ -0,0 +1,97 @@
+#include "Ramp.h"
+
+
+
+Ramp::Ramp(uint16_t hz)
+{
+    this->hz=hz;
+    acc_max=0;
+    jerk_max=0;
+    goal=0;
+    v=0;
+    a=0;
+}
+
+
+void Ramp::limits(uint32_t acc, uint32_t jerk)
+{
+    uint64_t am = ( (uint64_t)acc << RAMP_Q ) / hz;
+    uint64_t jm = ( (uint64_t)jerk << RAMP_Q ) / hz / hz;
+
+    acc_max = ( am > 0x3FFFFFFF ) ? 0x3FFFFFFF : (int32_t)am;     //һ͵Ŀ꣬Ͳ޲ࣻҲ int32
+    jerk_max = ( jm > 0x3FFFFFFF ) ? 0x3FFFFFFF : (int32_t)jm;
+    if ( ( acc != 0 ) && ( acc_max == 0 ) )                 //̫СҲÿһ
+        acc_max = 1;
+    if ( ( jerk != 0 ) && ( jerk_max == 0 ) )
+        jerk_max = 1;
+}
+
+
+void Ramp::target(int16_t v)
+{
+    goal = v;
+}
+
+
+void Ramp::reset(int16_t v)
+{
+    goal = v;
+    this->v = (int32_t)v << RAMP_Q;
+    a = 0;
+}
+
+
+int16_t Ramp::tick()
+{
+    int32_t e, s, as;
+
+    e = ( (int32_t)goal << RAMP_Q ) - v;
+    if ( ( acc_max == 0 ) || ( ( e == 0 ) && ( a == 0 ) ) )
+    {
+        v = (int32_t)goal << RAMP_Q;
+        a = 0;
+        return goal;
+    }
+
+    s = ( e < 0 ) ? -1 : 1;
+    e *= s;                                                 //¶Ŀķ
+    as = a * s;
+
+    if ( jerk_max == 0 )                                    //Σٶֱӵ
+        as = acc_max;
+    else if ( ( as > 0 ) && ( (int64_t)as * ( as + jerk_max ) >= (int64_t)2 * jerk_max * e ) )
+    {
+        as -= jerk_max;                                     //ڿʼСٶȣ0ʱõĿ
+        if ( as < 0 )
+            as = 0;
+    }
+    else
+    {
+        as += jerk_max;                                     //ļٶҲ jerk Сͻ
+        if ( as > acc_max )
+            as = acc_max;
+    }
+
+    if ( as >= e )                                          //һ͵
+    {
+        v = (int32_t)goal << RAMP_Q;
+        a = 0;
+        return goal;
+    }
+
+    v += as * s;
+    a = as * s;
+    return value();
+}
+
+
+int16_t Ramp::value()
+{
+    return (int16_t)( ( v + ( 1 << ( RAMP_Q - 1 ) ) ) >> RAMP_Q );
+}
+
+
+bool Ramp::idle()
+{
+    return ( v == ( (int32_t)goal << RAMP_Q ) ) && ( a == 0 );
+}
@@ -0,0 +1,38 @@
+#ifndef __Ramp_H__
+#define __Ramp_H__
+
+#include <stdint.h>
+
+
+//ٶб£ٶޡӼٶ޸Ŀֵڶʱжﰴ̶Ƶ tick()
+//jerk Ϊ0ʱٶֱȡޣٶߣٶҲ jerk 仯Sߣ쵽ĿʱǰСٶȣͷ
+//λĿֵͬ(Q15ռձ)acc Ϊÿ룬jerk Ϊÿÿ룻ڲQ15㣬жûиͳ
+//Ŀֵ int16 ķΧ(32767 << 15) Ҳ int32
+//Ӳϵģ⹤(Tools/Ramp_Sim)ֱӱ뱾ļ
+
+
+#define RAMP_Q              15              //ڲٶȡٶȵСλ
+
+
+class Ramp
+{
+    public:
+    Ramp(uint16_t hz);
+    void        limits(uint32_t acc, uint32_t jerk);    //acc Ϊ0ʱޣĿֵЧ
+    void        target(int16_t v);
+    void        reset(int16_t v);                       // vٶ(ͣӹʱ)
+    int16_t     tick();                                 //һڣ
+    int16_t     value();
+    bool        idle();                                 //ѾĿֵ
+
+    private:
+    uint16_t        hz;
+    int32_t         acc_max;        //ÿڵٶȱ仯(Q15)
+    int32_t         jerk_max;       //ÿڵļٶȱ仯(Q15)0Ϊ
+    volatile int16_t goal;
+    int32_t         v;              //ǰ(Q15)
+    int32_t         a;              //ǰٶ(Q15ÿ)
+};
+
+
+#endif
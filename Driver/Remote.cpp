@@ -0,0 +1,159 @@
+#include "Remote.h"
+
+
+
+
+Remote::Remote(Rmt_CmdFunc fn, void *arg)
+{
+    this->fn=fn;
+    this->arg=arg;
+    bulk=0;
+    frames=0;
+    bad=0;
+    dups=0;
+    lost=0;
+    reset();
+}
+
+
+void Remote::reset()
+{
+    n=0;
+    skip=false;
+    have_seq=false;
+    last=0;
+    seen=0;
+}
+
+
+void Remote::set_bulk(Rmt_BulkFunc fn)
+{
+    bulk=fn;
+}
+
+
+bool Remote::check_dup(uint16_t seq)
+{
+    uint16_t d;
+
+    if ( ! have_seq )
+    {
+        have_seq = true;
+        last = seq;
+        seen = 0;
+        return false;
+    }
+
+    d = seq - last;
+    if ( d == 0 )
+        return true;
+
+    if ( d < 0x8000 )                               // last £ǰ d
+    {
+        if ( d <= RMT_WINDOW )
+        {
+            lost += d - 1;
+            seen = ( d == RMT_WINDOW ) ? 0 : ( seen << d );
+            seen |= 1u << ( d - 1 );                //ԭ last
+        }
+        else                                        //̫Զ¿ʼ
+            seen = 0;
+        last = seq;
+        return false;
+    }
+
+    d = last - seq;                                 // last 
+    if ( d > RMT_WINDOW )                           //ԶˣŴͷ
+    {
+        last = seq;
+        seen = 0;
+        return false;
+    }
+    if ( seen & ( 1u << ( d - 1 ) ) )
+        return true;
+    seen |= 1u << ( d - 1 );                        //֮ǰĿȱ
+    if ( lost )
+        lost --;
+    return false;
+}
+
+
+void Remote::frame(uint32_t ts)
+{
+    const uint8_t * p;
+    uint16_t        len;
+    uint8_t         i;
+    Rmt_Cmd         cmd;
+
+    len = Telemetry::cobs_decode ( buf, n, buf );          //󲻻ȱǰдλڶλǰ
+    if ( ( len == 0 ) || ! Telemetry::parse ( buf, len, &cmd .head, &p, &cmd .len )
+      || ( ( cmd .len > TLM_PAYLOAD_MAX ) && ( bulk == 0 ) ) )
+    {
+        bad ++;
+        return;
+    }
+    if ( cmd .len > TLM_PAYLOAD_MAX )
+    {
+        cmd .dup = check_dup ( cmd .head .seq );
+        frames ++;
+        if ( cmd .dup )
+            dups ++;
+        bulk ( &cmd .head, p, cmd .len, cmd .dup, arg );
+        return;
+    }
+    for ( i = 0; i < cmd .len; i++ )
+        cmd .data [ i ] = p [ i ];
+    cmd .dup = check_dup ( cmd .head .seq );
+    cmd .ts = ts;
+    frames ++;
+    if ( cmd .dup )
+        dups ++;
+    fn ( &cmd, arg );
+}
+
+
+void Remote::feed(const uint8_t *p, uint16_t len, uint32_t ts)
+{
+    uint16_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        if ( p [ i ] == 0x00 )
+        {
+            if ( skip )
+                bad ++;
+            else if ( n )
+                frame ( ts );
+            n = 0;
+            skip = false;
+        }
+        else if ( n < sizeof ( buf ) )
+            buf [ n ++ ] = p [ i ];
+        else
+            skip = true;
+    }
+}
+
+
+uint32_t Remote::rx_frames()
+{
+    return frames;
+}
+
+
+uint32_t Remote::bad_frames()
+{
+    return bad;
+}
+
+
+uint32_t Remote::dup_frames()
+{
+    return dups;
+}
+
+
+uint32_t Remote::lost_frames()
+{
+    return lost;
+}
@@ -0,0 +1,63 @@
+#ifndef __Remote_H__
+#define __Remote_H__
+
+#include <stdint.h>
+#include "Telemetry.h"
+
+
+//ңָգѵԷֽ(ͬ Telemetry ֡ʽ)֡У󽻸ص
+//feed() ڽжֽڵãֻյ֡β0x00ʱŽһΣʱ֡(ָʮֽڣOTA֡ٶֽ)
+//֡ڽջԭؽ룬ݳ TLM_PAYLOAD_MAX Ĵָ֡뽻 set_bulk() õĺ
+//ȥأûյӦͬһطѾյ֡ dupֻӦִ
+//Ӳϵģ⹤(Tools/Rmt_Sim)ֱӱ뱾ļ
+
+
+#define RMT_WINDOW         32          //ȥشڣյ32
+
+
+struct Rmt_Cmd
+{
+    Tlm_Head    head;               //head.seq Ϊָţhead.time ΪԷʱʱ
+    uint8_t     len;
+    uint8_t     data [ TLM_PAYLOAD_MAX ];
+    bool        dup;                //طָ
+    uint32_t    ts;                 //յ֡βʱ feed() ʱ
+};
+
+
+typedef void (*Rmt_CmdFunc)(const Rmt_Cmd *cmd, void *arg);     //ڵ feed() ִУcmd ֻڻصڼЧ
+typedef void (*Rmt_BulkFunc)(const Tlm_Head *head, const uint8_t *p, uint8_t len, bool dup, void *arg);     //ͬϣp ֻڻصڼЧ
+
+
+class Remote
+{
+    public:
+    Remote(Rmt_CmdFunc fn, void *arg);
+    void        reset();                                        //Ӻã֡ȥؼ¼
+    void        set_bulk(Rmt_BulkFunc fn);                      //ʱ֡֡
+    void        feed(const uint8_t *p, uint16_t len, uint32_t ts);
+    uint32_t    rx_frames();
+    uint32_t    bad_frames();                                   //COBS/CRC/汾򳬳
+    uint32_t    dup_frames();
+    uint32_t    lost_frames();                                  //пȱûбطϵ֡
+
+    private:
+    Rmt_CmdFunc     fn;
+    Rmt_BulkFunc    bulk;
+    void *          arg;
+    uint8_t         buf [ TLM_BULK_FRAME_MAX ];
+    uint16_t        n;
+    bool            skip;           //̫֡һ0x00
+    bool            have_seq;
+    uint16_t        last;           //յ
+    uint32_t        seen;           //iλʾ last-1-i Ѿյ
+    uint32_t        frames;
+    uint32_t        bad;
+    uint32_t        dups;
+    uint32_t        lost;
+    void        frame(uint32_t ts);
+    bool        check_dup(uint16_t seq);
+};
+
+
+#endif
@@ -0,0 +1,166 @@
+#include "Servo.h"
+
+
+static const uint16_t Servo_Cos [ 65 ] =        //(1-cos(x))/2*32768x 64ΣмԲֵ
+{
+        0,    20,    79,   177,   315,   491,   705,   958,
+     1247,  1573,  1935,  2331,  2761,  3224,  3719,  4244,
+     4799,  5381,  5990,  6624,  7282,  7961,  8661,  9379,
+    10114, 10864, 11628, 12403, 13188, 13980, 14778, 15580,
+    16384, 17188, 17990, 18788, 19580, 20365, 21140, 21904,
+    22654, 23389, 24107, 24807, 25486, 26144, 26778, 27387,
+    27969, 28524, 29049, 29544, 30007, 30437, 30833, 31195,
+    31521, 31810, 32063, 32277, 32453, 32591, 32689, 32748,
+    32768,
+};
+
+
+
+Servo_Traj::Servo_Traj(uint16_t hz, uint8_t num, uint16_t us_min, uint16_t us_max)
+{
+    uint8_t i;
+
+    this->hz=hz;
+    this->num = ( num > SERVO_MAX ) ? SERVO_MAX : num;
+    this->us_min=us_min;
+    this->us_max=us_max;
+    seq = 0;
+    seq_n = 0;
+    seq_i = 0;
+    dwell = 0;
+    for ( i = 0; i < SERVO_MAX; i++ )
+    {
+        from [ i ] = to [ i ] = cur [ i ] = ( us_min + us_max ) / 2;
+        t [ i ] = n [ i ] = 0;
+        ease [ i ] = SERVO_EASE_LINEAR;
+    }
+}
+
+
+uint16_t Servo_Traj::ease_cos(uint16_t p)
+{
+    uint16_t idx = p >> 9, frac = p & 0x1FF;
+
+    if ( idx >= 64 )
+        return 32768;
+    return Servo_Cos [ idx ] + ( ( ( Servo_Cos [ idx + 1 ] - Servo_Cos [ idx ] ) * frac ) >> 9 );
+}
+
+
+void Servo_Traj::set(uint8_t ch, uint16_t us)
+{
+    move ( ch, us, 0, SERVO_EASE_LINEAR );
+}
+
+
+void Servo_Traj::move(uint8_t ch, uint16_t us, uint16_t ms, uint8_t ease)
+{
+    if ( ch >= num )
+        return;
+    if ( us < us_min )
+        us = us_min;
+    if ( us > us_max )
+        us = us_max;
+    from [ ch ] = cur [ ch ];                   //һ뻻Ŀʱӵǰλýߣ
+    to [ ch ] = us;
+    this->ease [ ch ] = ease;
+    t [ ch ] = 0;
+    n [ ch ] = (uint32_t)ms * hz / 1000;
+    if ( n [ ch ] == 0 )
+        cur [ ch ] = us;
+}
+
+
+void Servo_Traj::begin(const Servo_Step *s)
+{
+    uint8_t i;
+
+    for ( i = 0; i < num; i++ )
+        if ( s->mask & ( 1 << i ) )
+            move ( i, s->us [ i ], s->ms, s->ease );
+    dwell = (uint32_t)s->dwell * hz / 1000;
+}
+
+
+bool Servo_Traj::run(const Servo_Step *seq, uint8_t count)
+{
+    if ( this->seq || count == 0 )
+        return false;
+    this->seq = seq;
+    seq_n = count;
+    seq_i = 0;
+    begin ( &seq [ 0 ] );
+    return true;
+}
+
+
+void Servo_Traj::stop()
+{
+    uint8_t i;
+
+    for ( i = 0; i < num; i++ )
+    {
+        to [ i ] = cur [ i ];
+        t [ i ] = n [ i ] = 0;
+    }
+    seq = 0;
+    dwell = 0;
+}
+
+
+void Servo_Traj::tick()
+{
+    bool     moving = false;
+    uint32_t p;
+    uint8_t  i;
+
+    for ( i = 0; i < num; i++ )
+    {
+        if ( t [ i ] >= n [ i ] )
+            continue;
+        t [ i ]++;
+        p = (uint32_t)t [ i ] * 32768 / n [ i ];
+        if ( ease [ i ] == SERVO_EASE_COS )
+            p = ease_cos ( p );
+        cur [ i ] = from [ i ] + (int16_t)( ( ( (int32_t)to [ i ] - from [ i ] ) * (int32_t)p ) >> 15 );
+        if ( t [ i ] < n [ i ] )
+            moving = true;
+    }
+
+    if ( ! seq || moving )
+        return;
+    if ( dwell )
+    {
+        dwell--;
+        return;
+    }
+    if ( ++seq_i < seq_n )
+        begin ( &seq [ seq_i ] );
+    else
+        seq = 0;
+}
+
+
+uint16_t Servo_Traj::value(uint8_t ch)
+{
+    return ( ch < num ) ? cur [ ch ] : 0;
+}
+
+
+bool Servo_Traj::busy()
+{
+    uint8_t i;
+
+    if ( seq )
+        return true;
+    for ( i = 0; i < num; i++ )
+        if ( t [ i ] < n [ i ] )
+            return true;
+    return false;
+}
+
+
+uint8_t Servo_Traj::step()
+{
+    return seq_i;
+}
@@ -0,0 +1,63 @@
+#ifndef __Servo_H__
+#define __Servo_H__
+
+#include <stdint.h>
+
+
+//켣ÿӵǰʱֵĿ꣬Ի(ͷм죬ͣûг)
+//ڶʱжÿ֡(һ50HzPWM) tick() һΣvalue() һ֡Ҫ
+//УһִУÿͬʱλͣһᣬstep() ߵڼ
+//õݴ˾ʲôʱóߣץȡ¾һ run()
+//Ӳ set() move() run() stop() ʱҪж(tick() ж)
+
+
+#define SERVO_MAX           4
+#define SERVO_EASE_LINEAR   0
+#define SERVO_EASE_COS      1
+
+
+struct Servo_Step
+{
+    uint8_t     mask;                   //һЩnλΪn
+    uint16_t    us [ SERVO_MAX ];       //Ŀ(us)mask ûеĲ
+    uint16_t    ms;                     //ʱ0ΪֱĿ
+    uint8_t     ease;                   //SERVO_EASE_*
+    uint16_t    dwell;                  //ֵٵȶÿʼһ(ms)ʵתλҪʱ
+};
+
+
+class Servo_Traj
+{
+    public:
+    Servo_Traj(uint16_t hz, uint8_t num, uint16_t us_min, uint16_t us_max);
+    void        set(uint8_t ch, uint16_t us);                           //ֱȥ
+    void        move(uint8_t ch, uint16_t us, uint16_t ms, uint8_t ease);
+    bool        run(const Servo_Step *seq, uint8_t count);              //һûʱ false
+    void        stop();                                                 //ͣڵǰλãн
+    void        tick();
+    uint16_t    value(uint8_t ch);
+    bool        busy();                                                 //жڶû
+    uint8_t     step();                                                 //ѾĲ(ͣʱ)
+    static uint16_t ease_cos(uint16_t p);                               //p Ϊ(0~32768) (1-cos(p))/2
+
+    private:
+    void        begin(const Servo_Step *s);
+
+    uint16_t    hz;
+    uint8_t     num;
+    uint16_t    us_min;
+    uint16_t    us_max;
+    uint16_t    from [ SERVO_MAX ];
+    uint16_t    to [ SERVO_MAX ];
+    volatile uint16_t cur [ SERVO_MAX ];
+    uint16_t    t [ SERVO_MAX ];        //Ѿ˼֡
+    uint16_t    n [ SERVO_MAX ];        //һ֡
+    uint8_t     ease [ SERVO_MAX ];
+    const Servo_Step * seq;             //0Ϊû
+    uint8_t     seq_n;
+    volatile uint8_t seq_i;
+    uint16_t    dwell;                  //һλҪȼ֡
+};
+
+
+#endif
@@ -0,0 +1,101 @@
+#include "Skew_Est.h"
+
+
+
+Skew_Est::Skew_Est(uint16_t fb_mm, uint16_t lr_mm, uint16_t v_min, uint16_t err_max)
+{
+    span [ 0 ] = fb_mm ? fb_mm : 1;
+    span [ 1 ] = lr_mm ? lr_mm : 1;
+    this->v_min=v_min;
+    this->err_max=err_max;
+    n = 0;
+    rej = 0;
+    reset ();
+}
+
+
+void Skew_Est::reset()
+{
+    ok = false;
+    meas = 0;
+    theta0 = 0;
+}
+
+
+bool Skew_Est::cross(uint8_t pair, int32_t dt_us, int16_t v, int16_t theta_mrad)
+{
+    int32_t th;
+
+    if ( pair >= SKEW_PAIR_NUM )
+        return false;
+    if ( v < (int32_t)v_min && v > -(int32_t)v_min )    //ûѹߵķߣ̫
+    {
+        rej++;
+        return false;
+    }
+    th = (int32_t)( -(int64_t)dt_us * v / ( (int32_t)span [ pair ] * 1000 ) );
+    if ( th > (int32_t)err_max || th < -(int32_t)err_max )
+    {
+        rej++;
+        return false;
+    }
+    meas = th;
+    theta0 = theta_mrad;
+    ok = true;
+    n++;
+    return true;
+}
+
+
+int16_t Skew_Est::error(int16_t theta_mrad)
+{
+    int32_t d;
+
+    if ( ! ok )
+        return 0;
+    d = theta_mrad - theta0;                            //  
+    if ( d > 3141 )
+        d -= 6283;
+    if ( d < -3142 )
+        d += 6283;
+    return meas + d;
+}
+
+
+int16_t Skew_Est::correct(int16_t theta_mrad, uint16_t gain, uint16_t deadband, int16_t w_max)
+{
+    int32_t e = error ( theta_mrad ), w;
+
+    if ( e <= (int32_t)deadband && e >= -(int32_t)deadband )
+        return 0;
+    w = -e * gain / 256;
+    if ( w > w_max )
+        w = w_max;
+    if ( w < -w_max )
+        w = -w_max;
+    return w;
+}
+
+
+bool Skew_Est::valid()
+{
+    return ok;
+}
+
+
+int16_t Skew_Est::last()
+{
+    return meas;
+}
+
+
+uint32_t Skew_Est::count()
+{
+    return n;
+}
+
+
+uint32_t Skew_Est::rejects()
+{
+    return rej;
+}
@@ -0,0 +1,45 @@
+#ifndef __Skew_Est_H__
+#define __Skew_Est_H__
+
+#include <stdint.h>
+
+
+//бƣһѲߴѹͬһߵʱ dt( Line_Timing.h) ϴֱߵĳ٣
+//ߵķϲ˶٣ľǺ(СǶȣ250mrad 1%)
+//  ǰ󴫸(ѹ)    = -dt * vx / ǰ
+//  Ҵ(ǰѹ)    = -dt * vy / Ҿ
+// ʱΪ̼ͬơÿѹһһΣ̼֮ƺı仯ƣתĽǶȥתͷ
+//̫(dt жӳռȴ)̫(˶)ĲҪ
+//correct() ķֵ w(ռձȵλʱΪ)߼ӵ Move_Vel()  w 
+//Ӳϵĳģ(Tools/Skew_Sim)ֱӱ뱾ļ
+
+
+#define SKEW_PAIR_NUM       2               //ͬ LINE_PAIR_NUM0 ǰ1 
+
+
+class Skew_Est
+{
+    public:
+    Skew_Est(uint16_t fb_mm, uint16_t lr_mm, uint16_t v_min, uint16_t err_max);
+    bool        cross(uint8_t pair, int32_t dt_us, int16_t v, int16_t theta_mrad);  //v Ϊѹ߷ĳ(mm/s)theta Ϊʱ̼Ƶĺ򣻲Ҫʱ false
+    int16_t     error(int16_t theta_mrad);                              //ڵĺ(mrad)ûΪ0
+    int16_t     correct(int16_t theta_mrad, uint16_t gain, uint16_t deadband, int16_t w_max);  //w = -*gain/256С deadband ʱΪ0
+    bool        valid();
+    int16_t     last();                                                 //һ
+    uint32_t    count();
+    uint32_t    rejects();
+    void        reset();
+
+    private:
+    uint16_t    span [ SKEW_PAIR_NUM ];
+    uint16_t    v_min;
+    uint16_t    err_max;
+    bool        ok;
+    int16_t     meas;
+    int16_t     theta0;                 //ʱ̼Ƶĺ
+    uint32_t    n;
+    uint32_t    rej;
+};
+
+
+#endif
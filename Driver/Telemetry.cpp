@@ -0,0 +1,450 @@
+#include "Telemetry.h"
+
+
+
+static void Tlm_Put16(uint8_t *p, uint16_t v)
+{
+    p [ 0 ] = v;
+    p [ 1 ] = v >> 8;
+}
+
+static void Tlm_Put32(uint8_t *p, uint32_t v)
+{
+    p [ 0 ] = v;
+    p [ 1 ] = v >> 8;
+    p [ 2 ] = v >> 16;
+    p [ 3 ] = v >> 24;
+}
+
+static uint16_t Tlm_Get16(const uint8_t *p)
+{
+    return p [ 0 ] | ( p [ 1 ] << 8 );
+}
+
+static uint32_t Tlm_Get32(const uint8_t *p)
+{
+    return p [ 0 ] | ( p [ 1 ] << 8 ) | ( (uint32_t)p [ 2 ] << 16 ) | ( (uint32_t)p [ 3 ] << 24 );
+}
+
+
+
+
+Telemetry::Telemetry(Tlm_WriteFunc write)
+{
+    this->write=write;
+    seq=0;
+    frames=0;
+    bytes=0;
+    drops=0;
+}
+
+
+uint16_t Telemetry::crc16(const uint8_t *buf, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    uint8_t  i;
+
+    while ( len-- )
+    {
+        crc ^= (uint16_t)( *buf++ ) << 8;
+        for ( i = 0; i < 8; i++ )
+            crc = ( crc & 0x8000 ) ? ( ( crc << 1 ) ^ 0x1021 ) : ( crc << 1 );
+    }
+    return crc;
+}
+
+
+uint16_t Telemetry::cobs_encode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t code_pos = 0, o = 1, i;
+    uint8_t  code = 1;
+
+    for ( i = 0; i < len; i++ )
+    {
+        if ( in [ i ] == 0 )
+        {
+            out [ code_pos ] = code;
+            code_pos = o ++;
+            code = 1;
+        }
+        else
+        {
+            out [ o ++ ] = in [ i ];
+            if ( ++ code == 0xFF )          //254ֽڣµһ
+            {
+                out [ code_pos ] = code;
+                code_pos = o ++;
+                code = 1;
+            }
+        }
+    }
+    out [ code_pos ] = code;
+    return o;
+}
+
+
+uint16_t Telemetry::cobs_decode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t i = 0, o = 0;
+    uint8_t  code, j;
+
+    while ( i < len )
+    {
+        code = in [ i ++ ];
+        if ( code == 0 )
+            return 0;
+        for ( j = 1; j < code; j++ )
+        {
+            if ( ( i >= len ) || ( in [ i ] == 0 ) )
+                return 0;
+            out [ o ++ ] = in [ i ++ ];
+        }
+        if ( ( code < 0xFF ) && ( i < len ) )
+            out [ o ++ ] = 0;
+    }
+    return o;
+}
+
+
+bool Telemetry::send(uint8_t id, uint32_t time, const uint8_t *payload, uint8_t len)
+{
+    uint8_t  raw [ TLM_RAW_MAX ];
+    uint8_t  frame [ TLM_FRAME_MAX ];
+
+    if ( len > TLM_PAYLOAD_MAX )
+        return false;
+    return put ( id, time, payload, len, raw, frame );
+}
+
+
+bool Telemetry::bulk(uint8_t id, uint32_t time, const uint8_t *payload, uint8_t len)
+{
+    uint8_t  raw [ TLM_BULK_RAW_MAX ];
+    uint8_t  frame [ TLM_BULK_FRAME_MAX ];
+
+    if ( len > TLM_BULK_MAX )
+        return false;
+    return put ( id, time, payload, len, raw, frame );
+}
+
+
+bool Telemetry::put(uint8_t id, uint32_t time, const uint8_t *payload, uint8_t len, uint8_t *raw, uint8_t *frame)
+{
+    uint16_t n, i;
+
+    raw [ 0 ] = TLM_VERSION;
+    raw [ 1 ] = id;
+    Tlm_Put16 ( &raw [ 2 ], seq ++ );       //֡Ҳռţܿ
+    Tlm_Put32 ( &raw [ 4 ], time );
+    for ( i = 0; i < len; i++ )
+        raw [ TLM_HEAD_LEN + i ] = payload [ i ];
+    n = TLM_HEAD_LEN + len;
+    Tlm_Put16 ( &raw [ n ], crc16 ( raw, n ) );
+    n += 2;
+
+    n = cobs_encode ( raw, n, frame );
+    frame [ n ++ ] = 0x00;
+
+    if ( write ( frame, n ) != n )
+    {
+        drops ++;
+        return false;
+    }
+    frames ++;
+    bytes += n;
+    return true;
+}
+
+
+bool Telemetry::parse(const uint8_t *raw, uint16_t len, Tlm_Head *head, const uint8_t **payload, uint8_t *plen)
+{
+    if ( ( len < TLM_HEAD_LEN + 2 ) || ( len > TLM_BULK_RAW_MAX ) )
+        return false;
+    if ( crc16 ( raw, len - 2 ) != Tlm_Get16 ( &raw [ len - 2 ] ) )
+        return false;
+
+    head->ver = raw [ 0 ];
+    head->id = raw [ 1 ];
+    head->seq = Tlm_Get16 ( &raw [ 2 ] );
+    head->time = Tlm_Get32 ( &raw [ 4 ] );
+    *payload = &raw [ TLM_HEAD_LEN ];
+    *plen = len - TLM_HEAD_LEN - 2;
+    return head->ver == TLM_VERSION;
+}
+
+
+uint8_t Telemetry::frame_id(const uint8_t *frame, uint16_t len)
+{
+    if ( ( len < 3 ) || ( frame [ 0 ] < 3 ) )          //汾IDΪ0һCOBSһڶγ֮
+        return 0;
+    return frame [ 2 ];
+}
+
+
+bool Telemetry::pose(uint32_t time, const Tlm_Pose *p)
+{
+    uint8_t b [ 8 ];
+
+    Tlm_Put16 ( &b [ 0 ], p->x_mm );
+    Tlm_Put16 ( &b [ 2 ], p->y_mm );
+    Tlm_Put16 ( &b [ 4 ], p->theta_mrad );
+    b [ 6 ] = p->grid_x;
+    b [ 7 ] = p->grid_y;
+    return send ( TLM_ID_POSE, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::wheel(uint32_t time, const Tlm_Wheel *p)
+{
+    uint8_t b [ 8 ];
+    uint8_t i;
+
+    for ( i = 0; i < 4; i++ )
+        Tlm_Put16 ( &b [ i * 2 ], p->duty [ i ] );
+    return send ( TLM_ID_WHEEL, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::mission(uint32_t time, const Tlm_Mission *p)
+{
+    uint8_t b [ 3 ];
+
+    b [ 0 ] = p->step;
+    b [ 1 ] = p->dir;
+    b [ 2 ] = p->state;
+    return send ( TLM_ID_MISSION, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::vision(uint32_t time, const Tlm_Vision *p)
+{
+    uint8_t b [ 6 ];
+
+    b [ 0 ] = p->kind;
+    b [ 1 ] = p->result;
+    Tlm_Put16 ( &b [ 2 ], p->x );
+    Tlm_Put16 ( &b [ 4 ], p->y );
+    return send ( TLM_ID_VISION, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::ack(uint32_t time, const Tlm_Ack *p)
+{
+    uint8_t b [ 10 ];
+
+    Tlm_Put16 ( &b [ 0 ], p->cmd_seq );
+    b [ 2 ] = p->cmd_id;
+    b [ 3 ] = p->result;
+    Tlm_Put32 ( &b [ 4 ], p->echo );
+    Tlm_Put16 ( &b [ 8 ], p->latency_us );
+    return send ( TLM_ID_ACK, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::ota(uint32_t time, const Tlm_Ota *p)
+{
+    uint8_t b [ 14 ];
+
+    b [ 0 ] = p->state;
+    Tlm_Put16 ( &b [ 1 ], p->next );
+    Tlm_Put16 ( &b [ 3 ], p->chunks );
+    Tlm_Put16 ( &b [ 5 ], p->errors );
+    Tlm_Put16 ( &b [ 7 ], p->gaps );
+    b [ 9 ] = p->op;
+    Tlm_Put32 ( &b [ 10 ], p->arg );
+    return send ( TLM_ID_OTA, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::power(uint32_t time, const Tlm_Power *p)
+{
+    uint8_t b [ 4 ];
+
+    Tlm_Put16 ( &b [ 0 ], p->bat_mv );
+    Tlm_Put16 ( &b [ 2 ], p->scale );
+    return send ( TLM_ID_POWER, time, b, sizeof ( b ) );
+}
+
+
+bool Telemetry::get_pose(const uint8_t *p, uint8_t len, Tlm_Pose *out)
+{
+    if ( len < 8 )
+        return false;
+    out->x_mm = Tlm_Get16 ( &p [ 0 ] );
+    out->y_mm = Tlm_Get16 ( &p [ 2 ] );
+    out->theta_mrad = Tlm_Get16 ( &p [ 4 ] );
+    out->grid_x = p [ 6 ];
+    out->grid_y = p [ 7 ];
+    return true;
+}
+
+
+bool Telemetry::get_wheel(const uint8_t *p, uint8_t len, Tlm_Wheel *out)
+{
+    uint8_t i;
+
+    if ( len < 8 )
+        return false;
+    for ( i = 0; i < 4; i++ )
+        out->duty [ i ] = Tlm_Get16 ( &p [ i * 2 ] );
+    return true;
+}
+
+
+bool Telemetry::get_power(const uint8_t *p, uint8_t len, Tlm_Power *out)
+{
+    if ( len < 4 )
+        return false;
+    out->bat_mv = Tlm_Get16 ( &p [ 0 ] );
+    out->scale = Tlm_Get16 ( &p [ 2 ] );
+    return true;
+}
+
+
+bool Telemetry::get_mission(const uint8_t *p, uint8_t len, Tlm_Mission *out)
+{
+    if ( len < 3 )
+        return false;
+    out->step = p [ 0 ];
+    out->dir = p [ 1 ];
+    out->state = p [ 2 ];
+    return true;
+}
+
+
+bool Telemetry::get_vision(const uint8_t *p, uint8_t len, Tlm_Vision *out)
+{
+    if ( len < 6 )
+        return false;
+    out->kind = p [ 0 ];
+    out->result = p [ 1 ];
+    out->x = Tlm_Get16 ( &p [ 2 ] );
+    out->y = Tlm_Get16 ( &p [ 4 ] );
+    return true;
+}
+
+
+bool Telemetry::get_ack(const uint8_t *p, uint8_t len, Tlm_Ack *out)
+{
+    if ( len < 10 )
+        return false;
+    out->cmd_seq = Tlm_Get16 ( &p [ 0 ] );
+    out->cmd_id = p [ 2 ];
+    out->result = p [ 3 ];
+    out->echo = Tlm_Get32 ( &p [ 4 ] );
+    out->latency_us = Tlm_Get16 ( &p [ 8 ] );
+    return true;
+}
+
+
+bool Telemetry::get_jog(const uint8_t *p, uint8_t len, Tlm_Jog *out)
+{
+    if ( len < 3 )
+        return false;
+    out->dir = p [ 0 ];
+    out->time_ms = Tlm_Get16 ( &p [ 1 ] );
+    return true;
+}
+
+
+bool Telemetry::get_vel(const uint8_t *p, uint8_t len, Tlm_Vel *out)
+{
+    if ( len < 8 )
+        return false;
+    out->vx = Tlm_Get16 ( &p [ 0 ] );
+    out->vy = Tlm_Get16 ( &p [ 2 ] );
+    out->w = Tlm_Get16 ( &p [ 4 ] );
+    out->time_ms = Tlm_Get16 ( &p [ 6 ] );
+    return true;
+}
+
+
+bool Telemetry::get_param(const uint8_t *p, uint8_t len, Tlm_Param *out)
+{
+    if ( len < 5 )
+        return false;
+    out->id = p [ 0 ];
+    out->value = (int32_t)Tlm_Get32 ( &p [ 1 ] );
+    return true;
+}
+
+
+bool Telemetry::get_ota(const uint8_t *p, uint8_t len, Tlm_Ota *out)
+{
+    if ( len < 14 )
+        return false;
+    out->state = p [ 0 ];
+    out->next = Tlm_Get16 ( &p [ 1 ] );
+    out->chunks = Tlm_Get16 ( &p [ 3 ] );
+    out->errors = Tlm_Get16 ( &p [ 5 ] );
+    out->gaps = Tlm_Get16 ( &p [ 7 ] );
+    out->op = p [ 9 ];
+    out->arg = Tlm_Get32 ( &p [ 10 ] );
+    return true;
+}
+
+
+bool Telemetry::get_ota_cmd(const uint8_t *p, uint8_t len, Tlm_Ota_Cmd *out)
+{
+    if ( ( len < TLM_OTA_DATA_HEAD ) || ( ( p [ 0 ] != TLM_OTA_DATA ) && ( len < 9 ) ) )
+        return false;
+    out->op = p [ 0 ];
+    out->arg = Tlm_Get32 ( &p [ 1 ] );
+    out->crc = ( p [ 0 ] != TLM_OTA_DATA ) ? Tlm_Get32 ( &p [ 5 ] ) : 0;
+    return true;
+}
+
+
+uint8_t Telemetry::put_jog(uint8_t *b, const Tlm_Jog *p)
+{
+    b [ 0 ] = p->dir;
+    Tlm_Put16 ( &b [ 1 ], p->time_ms );
+    return 3;
+}
+
+
+uint8_t Telemetry::put_vel(uint8_t *b, const Tlm_Vel *p)
+{
+    Tlm_Put16 ( &b [ 0 ], p->vx );
+    Tlm_Put16 ( &b [ 2 ], p->vy );
+    Tlm_Put16 ( &b [ 4 ], p->w );
+    Tlm_Put16 ( &b [ 6 ], p->time_ms );
+    return 8;
+}
+
+
+uint8_t Telemetry::put_param(uint8_t *b, const Tlm_Param *p)
+{
+    b [ 0 ] = p->id;
+    Tlm_Put32 ( &b [ 1 ], (uint32_t)p->value );
+    return 5;
+}
+
+
+uint8_t Telemetry::put_ota_cmd(uint8_t *b, const Tlm_Ota_Cmd *p)
+{
+    b [ 0 ] = p->op;
+    Tlm_Put32 ( &b [ 1 ], p->arg );
+    if ( p->op == TLM_OTA_DATA )
+        return TLM_OTA_DATA_HEAD;
+    Tlm_Put32 ( &b [ 5 ], p->crc );
+    return 9;
+}
+
+
+uint32_t Telemetry::sent_frames()
+{
+    return frames;
+}
+
+
+uint32_t Telemetry::sent_bytes()
+{
+    return bytes;
+}
+
+
+uint32_t Telemetry::drop_frames()
+{
+    return drops;
+}
@@ -0,0 +1,213 @@
+#ifndef __Telemetry_H__
+#define __Telemetry_H__
+
+#include <stdint.h>
+
+
+//ң֡ESP8266͸ԣ printf ı
+//֡ʽ(COBSǰֽݾΪС)
+//  汾(1) ϢID(1) (2) ʱms(4) (n) CRC16(2)
+//  CRC16-CCITT(ʽ0x1021ֵ0xFFFF)ǰ汾ݣ֡COBS0x00β
+//  Ϣݵĸʽ˾͸ TLM_VERSION˰汾
+//ԷСңָ(TLM_ID_CMD_*)ͬ֡ʽʱֶԵʱ䣬СӦԭʱ
+//ӲϵĽ빤(Tools/Tlm_Decode)ֱӱ뱾ļ
+
+
+#define TLM_VERSION        1
+#define TLM_HEAD_LEN       8
+#define TLM_PAYLOAD_MAX    32
+#define TLM_RAW_MAX        ( TLM_HEAD_LEN + TLM_PAYLOAD_MAX + 2 )
+#define TLM_FRAME_MAX      ( TLM_RAW_MAX + TLM_RAW_MAX / 254 + 2 )     //COBSӽβ0x00
+#define TLM_BULK_MAX       240                                        //֡(ԡСOTA)ݳ
+#define TLM_BULK_RAW_MAX   ( TLM_HEAD_LEN + TLM_BULK_MAX + 2 )
+#define TLM_BULK_FRAME_MAX ( TLM_BULK_RAW_MAX + TLM_BULK_RAW_MAX / 254 + 2 )
+
+
+enum TLM_ID         //ϢID
+{
+    TLM_ID_POSE     = 0x01,         //λ
+    TLM_ID_WHEEL    = 0x02,         //ĸӵռձ
+    TLM_ID_MISSION  = 0x03,         //
+    TLM_ID_VISION   = 0x04,         //ͷʶ
+    TLM_ID_ACK      = 0x05,         //ָӦ
+    TLM_ID_OTA      = 0x06,         //OTA״̬
+    TLM_ID_POWER    = 0x07,         //صѹռձȲ
+
+    TLM_ID_CMD_JOG      = 0x10,     //ԡС㶯ʱԶͣ
+    TLM_ID_CMD_STOP     = 0x11,     //ͣ
+    TLM_ID_CMD_MISSION  = 0x12,     //ʼ(ͬKey2)
+    TLM_ID_CMD_PARAM    = 0x13,     //޸Ĳ
+    TLM_ID_CMD_PING     = 0x14,     //ֻӦ𣬲ʱ
+    TLM_ID_CMD_SUB      = 0x15,     //(ģʽ)1ֽڣnλΪҪյ TLM_ID n
+    TLM_ID_CMD_OTA      = 0x16,     //OTA(Tlm_Ota_Cmd)Ӧ𣬽 TLM_ID_OTA
+    TLM_ID_CMD_VEL      = 0x17,     //ٶ(Tlm_Vel)ʱԶͣͬ㶯
+};
+
+
+enum TLM_RESULT     //Ӧ
+{
+    TLM_RES_OK      = 0,
+    TLM_RES_DUP     = 1,            //طָ֮ǰѾִйִ
+    TLM_RES_BUSY    = 2,            //ǰ״ִ̬(е㶯)
+    TLM_RES_BAD_ARG = 3,
+    TLM_RES_UNKNOWN = 4,            //ʶָ
+};
+
+
+struct Tlm_Head
+{
+    uint8_t     ver;
+    uint8_t     id;
+    uint16_t    seq;                //ÿһ֡1Ϣã˾ݴͳƶ֡
+    uint32_t    time;               //ʱ(ms)
+};
+
+struct Tlm_Pose                     //8ֽ
+{
+    int16_t     x_mm;               //̼λ(mm)
+    int16_t     y_mm;
+    int16_t     theta_mrad;         //(0.001rad)
+    int8_t      grid_x;             //Ѳߴĸ
+    int8_t      grid_y;
+};
+
+struct Tlm_Wheel                    //8ֽ
+{
+    int16_t     duty [ 4 ];         //תΪ-1000~1000
+};
+
+struct Tlm_Power                    //4ֽ
+{
+    uint16_t    bat_mv;             //صѹ(mV)
+    uint16_t    scale;              //ռձȲϵ4096Ϊ1
+};
+
+struct Tlm_Mission                  //3ֽ
+{
+    uint8_t     step;               //TaskTurn 
+    uint8_t     dir;                //ǰʻ
+    uint8_t     state;              //0:ֹͣ 1:
+};
+
+struct Tlm_Vision                   //6ֽ
+{
+    uint8_t     kind;               //0: 1:ά 2:ɫ
+    uint8_t     result;
+    int16_t     x;                  //Ŀͼеλ()
+    int16_t     y;
+};
+
+
+struct Tlm_Ack                     //10ֽ
+{
+    uint16_t    cmd_seq;            //Ӧָ
+    uint8_t     cmd_id;
+    uint8_t     result;             //TLM_RESULT
+    uint32_t    echo;               //ָ֡ͷʱ䣬ԭ
+    uint16_t    latency_us;         //Сյָ֡Чʱ(us)65535Ϊ65535
+};
+
+struct Tlm_Jog                      //3ֽ
+{
+    uint8_t     dir;                //ͬ User_main.c  Diretion0ǰ 1 2 3 4ͣ 5ǰ 6ǰ 7 8Һ
+    uint16_t    time_ms;            //ʱ䣬ڼûµĵ㶯ͣ
+};
+
+struct Tlm_Vel                      //8ֽ
+{
+    int16_t     vx;                 //ƽƣռձȵλ(-1000~1000) Mecanum.h
+    int16_t     vy;                 //ǰ
+    int16_t     w;                  //ʱת
+    uint16_t    time_ms;            //ʱ䣬ڼûµٶȻ㶯ͣ
+};
+
+struct Tlm_Param                    //5ֽ
+{
+    uint8_t     id;                 //TLM_PARAM_*
+    int32_t     value;
+};
+
+#define TLM_PARAM_MOVE_SPEED     0          //ʻPWM(0~1000)
+#define TLM_PARAM_CORRECT_TIME   1          //ĩβʻʱ(ms)
+#define TLM_PARAM_RAMP_ACC       2          //ռձбµļٶ(ÿ룬0Ϊ)
+#define TLM_PARAM_RAMP_JERK      3          //Ӽٶ(ÿÿ룬0Ϊ)
+
+struct Tlm_Ota_Cmd                  //9ֽڣ(1) arg(4) crc(4)TLM_OTA_DATA Ϊ(1) ƫ(4) 
+{
+    uint8_t     op;                 //TLM_OTA_*
+    uint32_t    arg;                //BEGIN:񳤶 DATA:ƫ CHUNK:16λ COMMIT:0ʱУͨλظԭ
+    uint32_t    crc;                //BEGIN:CRC32 CHUNK:һCRC32
+};
+
+#define TLM_OTA_BEGIN       0       //ʼ(ȺCRCϴͬʱ)
+#define TLM_OTA_DATA        1
+#define TLM_OTA_CHUNK       2       //һ(OTA_CHUNKֽ)꣬У
+#define TLM_OTA_COMMIT      3       //У飬ͨ´ϵ翽
+#define TLM_OTA_ABORT       4
+#define TLM_OTA_STATUS      5       //ֻһ֡ TLM_ID_OTA
+#define TLM_OTA_DATA_HEAD   5       //֡ǰֽ
+
+struct Tlm_Ota                      //14ֽ
+{
+    uint8_t     state;              //Ota.h  OTA_STATE_*
+    uint8_t     op;                 //ظָ(TLM_OTA_*)ʱΪ TLM_OTA_STATUS
+    uint32_t    arg;                //ָ argϳʱĻظ
+    uint16_t    next;               //һûУͨĿ飬Դŷ
+    uint16_t    chunks;             //ܿ
+    uint16_t    errors;             //Уʧܴ
+    uint16_t    gaps;               //ݲ(ڻ򻺳)֡
+};
+
+
+typedef uint16_t (*Tlm_WriteFunc)(const uint8_t *buf, uint16_t len);     //֡дֽŲ·0
+
+
+class Telemetry
+{
+    public:
+    Telemetry(Tlm_WriteFunc write);
+    bool        pose(uint32_t time, const Tlm_Pose *p);
+    bool        wheel(uint32_t time, const Tlm_Wheel *p);
+    bool        mission(uint32_t time, const Tlm_Mission *p);
+    bool        vision(uint32_t time, const Tlm_Vision *p);
+    bool        ack(uint32_t time, const Tlm_Ack *p);
+    bool        ota(uint32_t time, const Tlm_Ota *p);
+    bool        power(uint32_t time, const Tlm_Power *p);
+    bool        send(uint8_t id, uint32_t time, const uint8_t *payload, uint8_t len);     //falseʾͻ֡
+    bool        bulk(uint8_t id, uint32_t time, const uint8_t *payload, uint8_t len);     // TLM_BULK_MAXջԼ500ֽڣԶ
+    uint32_t    sent_frames();
+    uint32_t    sent_bytes();
+    uint32_t    drop_frames();
+
+    static uint16_t crc16(const uint8_t *buf, uint16_t len);
+    static uint16_t cobs_encode(const uint8_t *in, uint16_t len, uint8_t *out);     //out len+len/254+1 ֽڣβ0x00
+    static uint16_t cobs_decode(const uint8_t *in, uint16_t len, uint8_t *out);     //inβ0x00outԾin(ԭؽ)ʽ󷵻0
+    static bool     parse(const uint8_t *raw, uint16_t len, Tlm_Head *head, const uint8_t **payload, uint8_t *plen);    //汾CRC
+    static uint8_t  frame_id(const uint8_t *frame, uint16_t len);      //ֱ֡ȡϢIDʽԷ0
+    static bool     get_pose(const uint8_t *p, uint8_t len, Tlm_Pose *out);
+    static bool     get_wheel(const uint8_t *p, uint8_t len, Tlm_Wheel *out);
+    static bool     get_mission(const uint8_t *p, uint8_t len, Tlm_Mission *out);
+    static bool     get_vision(const uint8_t *p, uint8_t len, Tlm_Vision *out);
+    static bool     get_ack(const uint8_t *p, uint8_t len, Tlm_Ack *out);
+    static bool     get_jog(const uint8_t *p, uint8_t len, Tlm_Jog *out);
+    static bool     get_vel(const uint8_t *p, uint8_t len, Tlm_Vel *out);
+    static bool     get_param(const uint8_t *p, uint8_t len, Tlm_Param *out);
+    static bool     get_ota(const uint8_t *p, uint8_t len, Tlm_Ota *out);
+    static bool     get_power(const uint8_t *p, uint8_t len, Tlm_Power *out);
+    static bool     get_ota_cmd(const uint8_t *p, uint8_t len, Tlm_Ota_Cmd *out);     //TLM_OTA_DATA ֻȡƫ
+    static uint8_t  put_jog(uint8_t *b, const Tlm_Jog *p);         //Զָãݳ
+    static uint8_t  put_vel(uint8_t *b, const Tlm_Vel *p);
+    static uint8_t  put_param(uint8_t *b, const Tlm_Param *p);
+    static uint8_t  put_ota_cmd(uint8_t *b, const Tlm_Ota_Cmd *p); //TLM_OTA_DATA  TLM_OTA_DATA_HEADݽں
+
+    private:
+    bool        put(uint8_t id, uint32_t time, const uint8_t *payload, uint8_t len, uint8_t *raw, uint8_t *frame);
+    Tlm_WriteFunc   write;
+    uint16_t        seq;
+    uint32_t        frames;
+    uint32_t        bytes;
+    uint32_t        drops;
+};
+
+
+#endif
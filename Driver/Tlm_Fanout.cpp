@@ -0,0 +1,175 @@
+#include "Tlm_Fanout.h"
+
+
+
+Tlm_Fanout::Tlm_Fanout(Fan_SendFunc send)
+{
+    uint8_t i;
+
+    this->send=send;
+    next=0;
+    inflight=FAN_CLIENT_NUM;
+    inflight_frames=0;
+    for ( i = 0; i < FAN_CLIENT_NUM; i++ )
+        client [ i ] .open=false;
+}
+
+
+void Tlm_Fanout::open(uint8_t id, uint32_t time)
+{
+    Client * c;
+
+    if ( id >= FAN_CLIENT_NUM )
+        return;
+    c = &client [ id ];
+    c->open = false;                                    //publish() ڱȹ
+    c->topics = FAN_TOPIC_ALL;
+    c->backoff = 0;
+    c->skip = 0;
+    c->head = c->tail = 0;
+    c->st.frames = 0;
+    c->st.bytes = 0;
+    c->st.drops = 0;
+    c->st.fails = 0;
+    c->st.queued = 0;
+    c->st.queued_max = 0;
+    c->st.open_time = time;
+    if ( inflight == id )                               //ӵķͽ㵽
+        inflight = FAN_CLIENT_NUM;
+    c->open = true;
+}
+
+
+void Tlm_Fanout::close(uint8_t id)
+{
+    if ( id < FAN_CLIENT_NUM )
+        client [ id ] .open = false;
+}
+
+
+void Tlm_Fanout::subscribe(uint8_t id, uint8_t topics)
+{
+    if ( id < FAN_CLIENT_NUM )
+        client [ id ] .topics = topics;
+}
+
+
+bool Tlm_Fanout::is_open(uint8_t id)
+{
+    return ( id < FAN_CLIENT_NUM ) && client [ id ] .open;
+}
+
+
+uint8_t Tlm_Fanout::topics(uint8_t id)
+{
+    return ( id < FAN_CLIENT_NUM ) ? client [ id ] .topics : 0;
+}
+
+
+bool Tlm_Fanout::stat(uint8_t id, Fan_Stat *out)
+{
+    if ( ! is_open ( id ) )
+        return false;
+    *out = client [ id ] .st;
+    out->queued = client [ id ] .tail - client [ id ] .head;
+    return true;
+}
+
+
+uint16_t Tlm_Fanout::publish(const uint8_t *frame, uint16_t len)
+{
+    uint8_t  id = Telemetry::frame_id ( frame, len );
+    uint8_t  i;
+    uint16_t j, used;
+    Client * c;
+
+    for ( i = 0; i < FAN_CLIENT_NUM; i++ )
+    {
+        c = &client [ i ];
+        if ( ! c->open || ( id >= 8 ) || ! ( c->topics & ( 1u << id ) ) )
+            continue;
+
+        used = c->tail - c->head;
+        if ( used + len > FAN_QUEUE_LEN )               //ֻͻ˵ģĿͻճ
+        {
+            c->st.drops ++;
+            continue;
+        }
+        for ( j = 0; j < len; j++ )
+            c->queue [ ( c->tail + j ) & ( FAN_QUEUE_LEN - 1 ) ] = frame [ j ];
+        c->tail += len;
+        if ( used + len > c->st.queued_max )
+            c->st.queued_max = used + len;
+    }
+    return len;
+}
+
+
+void Tlm_Fanout::failed(Client *c)
+{
+    c->st.fails ++;
+    c->backoff = ( c->backoff == 0 ) ? 1 : ( ( c->backoff >= FAN_BACKOFF_MAX / 2 ) ? FAN_BACKOFF_MAX : c->backoff * 2 );
+    c->skip = c->backoff;
+}
+
+
+bool Tlm_Fanout::pump()
+{
+    uint8_t  i, id;
+    uint16_t n, j, frames;
+    bool     ok, prev_lost = false;
+    Client * c = 0;
+
+    for ( i = 0; i < FAN_CLIENT_NUM; i++ )              //˱еĿͻÿ pump() һ
+    {
+        if ( client [ i ] .skip )
+            client [ i ] .skip --;
+    }
+
+    for ( i = 0; i < FAN_CLIENT_NUM; i++ )              //һֻһͻ
+    {
+        id = ( next + i ) % FAN_CLIENT_NUM;
+        if ( client [ id ] .open && ( client [ id ] .skip == 0 ) && ( client [ id ] .tail != client [ id ] .head ) )
+        {
+            c = &client [ id ];
+            break;
+        }
+    }
+    if ( c == 0 )
+        return false;
+    next = ( id + 1 ) % FAN_CLIENT_NUM;
+
+    n = c->tail - c->head;                              //ﶼ֡ȫ
+    frames = 0;
+    for ( j = 0; j < n; j++ )
+    {
+        out [ j ] = c->queue [ ( c->head + j ) & ( FAN_QUEUE_LEN - 1 ) ];
+        if ( out [ j ] == 0x00 )
+            frames ++;
+    }
+
+    ok = send ( id, out, n, &prev_lost );
+    if ( inflight < FAN_CLIENT_NUM )                    //һεĽʱ֪
+    {
+        if ( prev_lost )
+        {
+            client [ inflight ] .st.drops += inflight_frames;
+            failed ( &client [ inflight ] );
+        }
+        else
+            client [ inflight ] .backoff = 0;           //ȷϷȥ˲Ų˱
+    }
+    inflight = FAN_CLIENT_NUM;
+
+    if ( ! ok )
+    {
+        failed ( c );
+        return true;
+    }
+    c->head += n;
+    c->st.frames += frames;
+    c->st.bytes += n;
+    inflight = id;
+    inflight_frames = frames;
+    return true;
+}
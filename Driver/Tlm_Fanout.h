@@ -0,0 +1,74 @@
+#ifndef __Tlm_Fanout_H__
+#define __Tlm_Fanout_H__
+
+#include <stdint.h>
+#include "Telemetry.h"
+
+
+//ңַESP8266ʱ FAN_CLIENT_NUM ͻˣԶҪϢ( TLM_ID)
+//publish() һ֡ŽÿĿͻ˵ĶУзŲ¾ֻͻ˵һ֡ȴ
+//pump() ÿֵһݵĿͻˣŶӵ֡һηʧܵĿͻ˱ɴβֵͻ˲סͻ
+//֡ϢõģֻһֵĿͻ˲ܰ㶪֡˶ٿ stat()
+//Ӳϵģ⹤(Tools/Fan_Sim)ֱӱ뱾ļ
+
+
+#define FAN_CLIENT_NUM     4               //ͻӺ0~3ESP8266ӺŸĲ
+#define FAN_QUEUE_LEN      256             //ÿͻ˵ķͶ(ֽ)2
+#define FAN_BACKOFF_MAX    128             //ʧܺ pump() ͻÿʧܶҪռסģһʱ
+#define FAN_TOPIC_ALL      ( ( 1u << TLM_ID_POSE ) | ( 1u << TLM_ID_WHEEL ) | ( 1u << TLM_ID_MISSION ) | ( 1u << TLM_ID_VISION ) | ( 1u << TLM_ID_OTA ) | ( 1u << TLM_ID_POWER ) )     //ϺĬ϶
+
+
+struct Fan_Stat
+{
+    uint32_t    frames;             //ģ֡
+    uint32_t    bytes;
+    uint32_t    drops;              //ûŽȥ֡Ͻģʧܵ֡
+    uint32_t    fails;              //ʧܴ
+    uint16_t    queued;             //ǰŶӵֽ
+    uint16_t    queued_max;
+    uint32_t    open_time;          //ʱ open() ʱ(ms)ƽ
+};
+
+
+//һ(֡)idfalseʾûȥڶ´ٷ
+//ͽҪԺ֪(ESP8266  SEND OK)һνȥݷʧʱ *prev_lost
+typedef bool (*Fan_SendFunc)(uint8_t id, const uint8_t *buf, uint16_t len, bool *prev_lost);
+
+
+class Tlm_Fanout
+{
+    public:
+    Tlm_Fanout(Fan_SendFunc send);
+    void        open(uint8_t id, uint32_t time);                //ͻϣնкͳƣ FAN_TOPIC_ALL
+    void        close(uint8_t id);
+    void        subscribe(uint8_t id, uint8_t topics);          //nλΪ TLM_ID nʱ
+    uint16_t    publish(const uint8_t *frame, uint16_t len);    //һ֡(Telemetry )ֱ Tlm_WriteFuncǷlen
+    bool        pump();                                         //һͻ˷һΣûпɷķfalse
+    bool        is_open(uint8_t id);
+    uint8_t     topics(uint8_t id);
+    bool        stat(uint8_t id, Fan_Stat *out);                //ûӷfalse
+
+    private:
+    struct Client
+    {
+        bool        open;
+        uint8_t     topics;
+        uint8_t     backoff;        //ʧܺҪĴÿʧһμӱ
+        uint8_t     skip;           //ҪĴ
+        uint16_t    head;           //ждλãΪŶֽ
+        uint16_t    tail;
+        uint8_t     queue [ FAN_QUEUE_LEN ];
+        Fan_Stat    st;
+    };
+
+    Fan_SendFunc    send;
+    Client          client [ FAN_CLIENT_NUM ];
+    uint8_t         next;           //´δĸͻ˿ʼ
+    uint8_t         inflight;       //һνģĿͻˣFAN_CLIENT_NUM ʾû
+    uint16_t        inflight_frames;
+    uint8_t         out [ FAN_QUEUE_LEN ];      //ƻʱƴһ
+    void        failed(Client *c);
+};
+
+
+#endif
@@ -39,7 +39,7 @@ W25Q64::W25Q64(W25Q64_Gpio *W25Q64_GPIO)
 void W25Q64::Init_Gpio()
 {
     this->gpio->CS->mode(GPIO_Mode_Out_PP,GPIO_Speed_50MHz);
-    this->gpio->MISO->mode(GPIO_Mode_AF_PP,GPIO_Speed_50MHz);
+    this->gpio->MISO->mode(GPIO_Mode_IN_FLOATING,GPIO_Speed_50MHz);     //ģʽMISO
     this->gpio->MOSI->mode(GPIO_Mode_AF_PP,GPIO_Speed_50MHz);
     this->gpio->SCK->mode(GPIO_Mode_AF_PP,GPIO_Speed_50MHz);
 }
@@ -52,13 +52,13 @@ inline void W25Q64::CS_Set()
 
 inline void W25Q64::CS_Reset()
 {
-    this->CS_Reset();
+    this->gpio->CS->reset();
 }
 
-void W25Q64::Init_SPI3()
+void W25Q64::Init_SPI()
 {
-    SPI W25Q64_SPI3;
-    W25Q64_SPI3.inti(SPI3,SPI_Direction_2Lines_FullDuplex,SPI_Mode_Master,SPI_DataSize_8b,SPI_CPOL_High,SPI_CPHA_2Edge,SPI_NSS_Soft,SPI_BaudRatePrescaler_4,SPI_FirstBit_MSB,7);
+    SPI W25Q64_SPI;
+    W25Q64_SPI.inti(SPI1,SPI_Direction_2Lines_FullDuplex,SPI_Mode_Master,SPI_DataSize_8b,SPI_CPOL_High,SPI_CPHA_2Edge,SPI_NSS_Soft,SPI_BaudRatePrescaler_4,SPI_FirstBit_MSB,7);
 }
 
 
@@ -66,31 +66,38 @@ void W25Q64::Init()
 {
     W25Q64::Init_Gpio();
     W25Q64::CS_Set();
-    W25Q64::Init_SPI3();
+    W25Q64::Init_SPI();
+}
+
+//շһֽڡֻյĻջžֽڣݻһλ
+uint8_t W25Q64::Xfer(uint8_t data)
+{
+    SPI W25Q64_SPI;
+    uint8_t reply = 0;
+    W25Q64_SPI.send_8b(SPI1,data,&reply);
+    return reply;
 }
 
 void W25Q64::Enable_Write()
 {
-    SPI W25Q64_SPI3;
     W25Q64::CS_Reset();
-    W25Q64_SPI3.send_8b(SPI3,W25X_WriteEnable);
+    W25Q64::Xfer(W25X_WriteEnable);
     W25Q64::CS_Set();
 }
 
 void W25Q64::Wait_WriteEnd()
 {
    uint8_t FLASH_Status = 0;
-   SPI W25Q64_SPI3;
   W25Q64::CS_Reset();
 
   /*  ״̬Ĵ  */
-   W25Q64_SPI3.send_8b(SPI3,W25X_ReadStatusReg);
+   W25Q64::Xfer(W25X_ReadStatusReg);
 
   /* FLASHæµȴ */
   do
   {
     /* ȡFLASHоƬ״̬Ĵ */ 
-     W25Q64_SPI3.send_8b(SPI3,Dummy_Byte,&FLASH_Status); 
+     FLASH_Status=W25Q64::Xfer(Dummy_Byte); 
   }
   while ((FLASH_Status & WIP_Flag) == SET);  /* д־ */
 
@@ -100,7 +107,6 @@ void W25Q64::Wait_WriteEnd()
 
 void W25Q64::SectorErase(uint32_t SectorAddr)
 {
-  SPI W25Q64_SPI3;
     /* FLASHдʹ */
   W25Q64::Enable_Write();
   W25Q64::Wait_WriteEnd();
@@ -108,13 +114,13 @@ void W25Q64::SectorErase(uint32_t SectorAddr)
   /* ѡFLASH: CS͵ƽ */
   W25Q64::CS_Reset();
   /* ָ*/
-  W25Q64_SPI3.send_8b(SPI3,W25X_SectorErase); 
+  W25Q64::Xfer(W25X_SectorErase); 
   /*Ͳַĸλ*/
-  W25Q64_SPI3.send_8b(SPI3,(SectorAddr & 0xFF0000) >> 16);     
+  W25Q64::Xfer((SectorAddr & 0xFF0000) >> 16);     
   /* Ͳַλ */
-  W25Q64_SPI3.send_8b(SPI3,(SectorAddr & 0xFF00) >> 8); 
+  W25Q64::Xfer((SectorAddr & 0xFF00) >> 8); 
   /* Ͳַĵλ */
-  W25Q64_SPI3.send_8b(SPI3,SectorAddr & 0xFF); 
+  W25Q64::Xfer(SectorAddr & 0xFF); 
   /* ֹͣź FLASH: CS ߵƽ */
   W25Q64::CS_Set();
   /* ȴ*/
@@ -122,13 +128,26 @@ void W25Q64::SectorErase(uint32_t SectorAddr)
 }
 
 
+void W25Q64::BlockErase(uint32_t BlockAddr)
+{
+  W25Q64::Enable_Write();
+  W25Q64::Wait_WriteEnd();
+  W25Q64::CS_Reset();
+  W25Q64::Xfer(W25X_BlockErase); 
+  W25Q64::Xfer((BlockAddr & 0xFF0000) >> 16);     
+  W25Q64::Xfer((BlockAddr & 0xFF00) >> 8); 
+  W25Q64::Xfer(BlockAddr & 0xFF); 
+  W25Q64::CS_Set();
+  W25Q64::Wait_WriteEnd();    
+}
+
+
 void W25Q64::BulkErase()
 {
-  SPI W25Q64_SPI3;
     /* FLASHдʹ */
   W25Q64::Enable_Write();
   W25Q64::CS_Reset();  
-  W25Q64_SPI3.send_8b(SPI3,W25X_ChipErase); 
+  W25Q64::Xfer(W25X_ChipErase); 
   W25Q64::CS_Set(); 
   W25Q64::Wait_WriteEnd();    
 }
@@ -136,19 +155,18 @@ void W25Q64::BulkErase()
 
 void W25Q64::PageWrite(uint8_t* p_Data,uint32_t WriteAddr,uint16_t Data_Length)
 {
-  SPI W25Q64_SPI3;
   /* FLASHдʹ */
   W25Q64::Enable_Write();
   /* ѡFLASH: CS͵ƽ */
    W25Q64::CS_Reset();  
   /* дҳдָ*/
-  W25Q64_SPI3.send_8b(SPI3,W25X_PageProgram);
+  W25Q64::Xfer(W25X_PageProgram);
   /*дַĸλ*/
-  W25Q64_SPI3.send_8b(SPI3,(WriteAddr & 0xFF0000) >> 16);   
+  W25Q64::Xfer((WriteAddr & 0xFF0000) >> 16);   
   /*дַλ*/
-  W25Q64_SPI3.send_8b(SPI3,(WriteAddr & 0xFF00) >> 8); 
+  W25Q64::Xfer((WriteAddr & 0xFF00) >> 8); 
   /*дַĵλ*/
-  W25Q64_SPI3.send_8b(SPI3,WriteAddr & 0xFF); 
+  W25Q64::Xfer(WriteAddr & 0xFF); 
 
   if(Data_Length > FLASH_PageSize)
   {
@@ -158,7 +176,7 @@ void W25Q64::PageWrite(uint8_t* p_Data,uint32_t WriteAddr,uint16_t Data_Length)
   while (Data_Length--)
   {
     /* ͵ǰҪдֽ */
-    W25Q64_SPI3.send_8b(SPI3,*p_Data);
+    W25Q64::Xfer(*p_Data);
     /* ָһֽ */
     p_Data++;
   }
@@ -258,28 +276,27 @@ void W25Q64::Write(uint8_t* p_Data,uint32_t WriteAddr,uint16_t Data_Length)
 
 void W25Q64::Read(uint8_t* p_Data,uint32_t ReadAddr,uint16_t Data_Length)
 {
-  SPI W25Q64_SPI3;
     
   /* ѡFLASH: CS͵ƽ */
   W25Q64::CS_Reset();
 
   /*   ָ */
-  W25Q64_SPI3.send_8b(SPI3,W25X_ReadData);
+  W25Q64::Xfer(W25X_ReadData);
 
   /*   ַλ */
-  W25Q64_SPI3.send_8b(SPI3,(ReadAddr & 0xFF0000) >> 16);
+  W25Q64::Xfer((ReadAddr & 0xFF0000) >> 16);
 
   /*   ַλ */
-  W25Q64_SPI3.send_8b(SPI3,(ReadAddr& 0xFF00) >> 8);
+  W25Q64::Xfer((ReadAddr& 0xFF00) >> 8);
 
   /*   ַλ */
-  W25Q64_SPI3.send_8b(SPI3,ReadAddr & 0xF);
+  W25Q64::Xfer(ReadAddr & 0xFF);
 	
 	/* ȡ */
   while (Data_Length--) /* while there is data to be read */
   {
     /* ȡһֽ*/
-     W25Q64_SPI3.send_8b(SPI3,Dummy_Byte,p_Data);
+     *p_Data=W25Q64::Xfer(Dummy_Byte);
     /* ָһֽڻ */
     p_Data++;
   }
@@ -291,25 +308,23 @@ void W25Q64::Read(uint8_t* p_Data,uint32_t ReadAddr,uint16_t Data_Length)
 
 void W25Q64::PowerDown_Mode(FunctionalState ok)
 {
-    SPI W25Q64_SPI3;
     W25Q64::CS_Reset();
-    W25Q64_SPI3.send_8b(SPI3,(ok? W25X_PowerDown:W25X_ReleasePowerDown));
+    W25Q64::Xfer((ok? W25X_PowerDown:W25X_ReleasePowerDown));
     W25Q64::CS_Set(); 
 }
 
 void W25Q64::Get_DeviceID( uint8_t* ID)
 {
-  SPI W25Q64_SPI3;
   /* Select the FLASH: Chip Select low */
   W25Q64::CS_Reset();
 
   /* Send "RDID " instruction */
-  W25Q64_SPI3.send_8b(SPI3,W25X_DeviceID);
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte);
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte);
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte);
+  W25Q64::Xfer(W25X_DeviceID);
+  W25Q64::Xfer(Dummy_Byte);
+  W25Q64::Xfer(Dummy_Byte);
+  W25Q64::Xfer(Dummy_Byte);
   /* Read a byte from the FLASH */
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte,ID);
+  *ID=W25Q64::Xfer(Dummy_Byte);
   /* Deselect the FLASH: Chip Select high */
   W25Q64::CS_Set(); 
 }
@@ -318,20 +333,19 @@ void W25Q64::Get_ID( uint32_t* ID)
 {
 
   uint8_t Temp0=0,Temp1=0,Temp2=0;
-  SPI W25Q64_SPI3;
 
   /* ʼͨѶCS͵ƽ */
   W25Q64::CS_Reset();
 
   /* JEDECָȡID */
-  W25Q64_SPI3.send_8b(SPI3,W25X_JedecDeviceID);
+  W25Q64::Xfer(W25X_JedecDeviceID);
 
   /* ȡһֽ */
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte,&Temp0);
+  Temp0=W25Q64::Xfer(Dummy_Byte);
   /* ȡһֽ */
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte,&Temp1);
+  Temp1=W25Q64::Xfer(Dummy_Byte);
   /* ȡһֽ */
-  W25Q64_SPI3.send_8b(SPI3,Dummy_Byte,&Temp2);
+  Temp2=W25Q64::Xfer(Dummy_Byte);
 
  /* ֹͣͨѶCSߵƽ */
   W25Q64::CS_Set(); 
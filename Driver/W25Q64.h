@@ -33,8 +33,9 @@ class W25Q64
         W25Q64(W25Q64_Gpio *W25Q64_GPIO);
         void Init();
         void SectorErase(uint32_t SectorAddr);  //  
+        void BlockErase(uint32_t BlockAddr);    //64K飬16ֿö
         void BulkErase();                       //Ƭ      
-        void Write(uint8_t* p_Data,uint32_t WriteAddr,uint16_t Data_Length);    //WriteAddrдData_LengthֽڣȲ
+        void Write(uint8_t* p_Data,uint32_t WriteAddr,uint16_t Data_Length);    //WriteAddrдData_LengthֽڣԿҳҪȲ
         void Read(uint8_t* p_Data,uint32_t ReadAddr,uint16_t Data_Length);      //ReadAddrȡData_Lengthֽڴ洢*p_Data
         void PowerDown_Mode(FunctionalState ok);                                //ģʽ
         void Get_DeviceID( uint8_t* ID);                                         //ѯ豸ID
@@ -45,7 +46,8 @@ class W25Q64
         void Init_Gpio();
         inline void CS_Set();
         inline void CS_Reset();
-        void  Init_SPI3();
+        void  Init_SPI();
+        uint8_t Xfer(uint8_t data);
         void  Enable_Write();
         void  Wait_WriteEnd();
         void PageWrite(uint8_t* p_Data,uint32_t WriteAddr,uint16_t Data_Length);   //ҳд, Data_LengthSPI_FLASH_PerWritePageSize
@@ -85,7 +85,35 @@ void ADC::cmd_dma(ADC_TypeDef* ADCx, FunctionalState NewState)
 	ADC_DMACmd(ADCx,NewState);
 }
 
-uint16_t get(ADC_TypeDef* ADCx)
+void ADC::inti_scan
+	(
+	ADC_TypeDef* ADCx,
+	DMA_Channel_TypeDef* DMAy_Channelx,
+	uint16_t *buf,
+	uint16_t size,
+	uint8_t NVIC_IRQChannel,
+	uint8_t NVIC_IRQChannelPreemptionPriority,
+	uint8_t NVIC_IRQChannelSubPriority
+	)
+{
+	DMA dma;
+	dma.inti(DMAy_Channelx,(uint32_t)&ADCx->DR,(uint32_t)buf,DMA_DIR_PeripheralSRC,size,
+					 DMA_PeripheralInc_Disable,DMA_MemoryInc_Enable,DMA_PeripheralDataSize_HalfWord,DMA_MemoryDataSize_HalfWord,
+					 DMA_Mode_Circular,DMA_Priority_High,DMA_M2M_Disable,(ADCx==ADC1)?RCC_AHBPeriph_DMA1:RCC_AHBPeriph_DMA2);
+	DMA_ITConfig(DMAy_Channelx,DMA_IT_HT|DMA_IT_TC,ENABLE);		//ǰһ롢һһж
+	
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel=NVIC_IRQChannel;
+	NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=NVIC_IRQChannelPreemptionPriority;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=NVIC_IRQChannelSubPriority;
+	NVIC_Init(&NVIC_InitStructure);
+	
+	ADC_DMACmd(ADCx,ENABLE);
+	ADC_SoftwareStartConvCmd(ADCx, ENABLE);
+}
+
+uint16_t ADC::get(ADC_TypeDef* ADCx)
 {
 	 return (uint16_t) ADCx->DR;
 }
@@ -3,6 +3,7 @@
 
 #include "stm32f10x.h"                  // Device header
 #include "gpio.h"
+#include "dma.h"
 #include "stm32f10x_rcc.h"              // Keil::Device:StdPeriph Drivers:RCC
 
 
@@ -155,6 +156,7 @@ ADC_IT_JEOC		ע
 
 class ADC																			
 {
+	public:
 	void inti_adc																//ĬϿͨADC		δжADC_SoftwareStartConvCmd(ADCx, ENABLE)ʼadcת
 	(
 	uint32_t RCC_APB2Periph,										//ADCͨʱ		RCC_APB2Periph_ADC1		RCC_APB2Periph_ADC2		RCC_APB2Periph_ADC3
@@ -191,6 +193,17 @@ class ADC
 	
 	void cmd_dma(ADC_TypeDef* ADCx, FunctionalState NewState);	//ADCxDMA,öӦDMAãdma.h
 	
+	void inti_scan															//ɨ裬DMAѭᵽbuf/ȫжϣʼת
+	(																						//ֻADC1(DMA1_Channel1)ADC3(DMA2_Channel5)DMAȵ inti_adc()  inti_channel()
+	ADC_TypeDef* ADCx,													//ADC1	ADC3
+	DMA_Channel_TypeDef* DMAy_Channelx,					//ADC1:DMA1_Channel1	ADC3:DMA2_Channel5
+	uint16_t *buf,															//룬ÿΪɨ
+	uint16_t size,															//buf ĵ
+	uint8_t NVIC_IRQChannel,										//DMA1_Channel1_IRQn	DMA2_Channel4_5_IRQn
+	uint8_t NVIC_IRQChannelPreemptionPriority,	//ռȼ
+	uint8_t NVIC_IRQChannelSubPriority					//ȼ
+	);
+	
 	
 	uint16_t get(ADC_TypeDef* ADCx);   				  //ADCxͨתֵ
 	
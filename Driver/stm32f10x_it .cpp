@@ -17,145 +17,260 @@
 
     
     
-void EXTI0_IRQHandler()
+void EXTI0_IRQHandler()     //Key1ֻϵͳ OSIntEnter()
 {
-    OS_ERR err;
-    OSIntEnter();       //ж
-    
+    CPU_TS ts=CPU_TS_TmrRd();
     if(EXTI_GetITStatus(EXTI_Line0) != RESET)
     {
-        OSTaskSemPost(&Key1_Scan_TCB,OS_OPT_POST_NONE,&err);        //Key1_ScanϢ
         EXTI_ClearITPendingBit(EXTI_Line0);
+        Debounce_Edge(DEB_KEY1,ts);         //TIM7ж﷢Key1_Scan
     }
-    
-    OSIntExit();       //˳ж   
-    
-    
 }
 
 	
 
-void EXTI4_IRQHandler()
+void EXTI4_IRQHandler()     //Key2
 {
-    OS_ERR err;
-    
-    OSIntEnter();       //ж
+    CPU_TS ts=CPU_TS_TmrRd();
     if(EXTI_GetITStatus(EXTI_Line4) != RESET)
     {
-        OSTaskSemPost(&Key2_Scan_TCB,OS_OPT_POST_NONE,&err);        //Key2_ScanϢ
         EXTI_ClearITPendingBit(EXTI_Line4);
+        Debounce_Edge(DEB_KEY2,ts);
     }
-    
-    OSIntExit();       //˳ж   
-    
 }
 
-void USART1_IRQHandler() 
+void TIM6_IRQHandler()      //ĽģCTRL_HZ
 {
     OS_ERR err;
-    char * p_mem_blk;
     OSIntEnter();       //ж
-    p_mem_blk =(char*) OSMemGet(&mem,&err);
-    if(USART_GetITStatus(USART1,USART_IT_RXNE) != RESET)
+    if(TIM_GetITStatus(TIM6,TIM_IT_Update) != RESET)
     {
-		* p_mem_blk = USART_ReceiveData ( USART1 );     //ȡյ
-		
-		OSTaskQPost ((OS_TCB      *)&USART1_Get_TCB,      //ĿĿƿ
-                     (void        *)p_mem_blk,             //Ϣݵ׵ַ
-                     (OS_MSG_SIZE  )1,                     //Ϣ
-                     (OS_OPT       )OS_OPT_POST_FIFO,      //Ϣеڶ
-                     (OS_ERR      *)&err);                 //ش        
+        TIM_ClearITPendingBit(TIM6,TIM_IT_Update);
+        if(Ctrl_Release())          //һûʱһγʱ
+            OSTaskSemPost(&Ctrl_TCB,OS_OPT_POST_NONE,&err);
+    }
+    OSIntExit();       //˳ж
+}
+
+
+
+void TIM5_IRQHandler()      //е۶ʱ߲һ֡Ƚʱ
+{
+    OSIntEnter();       //ж
+    if(TIM_GetITStatus(TIM5,TIM_IT_Update) != RESET)
+    {
+        TIM_ClearITPendingBit(TIM5,TIM_IT_Update);
+        Servo_Frame();
+    }
+    if(TIM_GetITStatus(TIM5,TIM_IT_CC1) != RESET)
+    {
+        TIM_ClearITPendingBit(TIM5,TIM_IT_CC1);
+        Servo_Edge(0);
+    }
+    if(TIM_GetITStatus(TIM5,TIM_IT_CC2) != RESET)
+    {
+        TIM_ClearITPendingBit(TIM5,TIM_IT_CC2);
+        Servo_Edge(1);
+    }
+    OSIntExit();       //˳ж
+}
+
+
+
+void DMA1_Channel1_IRQHandler()     //ADC1ɨDMA/ȫصѹ
+{
+    OSIntEnter();       //ж
+    if(DMA_GetITStatus(DMA1_IT_HT1) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_HT1);
+        Adc_Feed(0);
+    }
+    if(DMA_GetITStatus(DMA1_IT_TC1) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_TC1);
+        Adc_Feed(1);
+    }
+    OSIntExit();       //˳ж
+}
+
+
+
+void EXTI15_10_IRQHandler()     //ҺֱA B(E12 E13)
+{
+    OSIntEnter();       //ж
+    if(EXTI_GetITStatus(EXTI_Line12) != RESET || EXTI_GetITStatus(EXTI_Line13) != RESET)
+    {
+        EXTI_ClearITPendingBit(EXTI_Line12 | EXTI_Line13);
+        Odom_Exti();
+    }
+    OSIntExit();       //˳ж
+}
+
+
+
+static uint16_t USART1_RX_Tail;     //ѾUSART1_Getλ
+
+static void USART1_RX_Post(const uint8_t *p,uint16_t len)
+{
+    OS_ERR err;
+    OSTaskQPost ((OS_TCB      *)&USART1_Get_TCB,      //ĿĿƿ
+                 (void        *)p,                    //ϢΪDMAеƬ
+                 (OS_MSG_SIZE  )len,                  //Ƭγ
+                 (OS_OPT       )OS_OPT_POST_FIFO,     //Ϣеڶ
+                 (OS_ERR      *)&err);                //ش
+}
+
+static void USART1_RX_Update()      //ϴλõDMAǰдλ֮ݽ
+{
+    uint16_t head = USART1_RX_BUF_SIZE - DMA_GetCurrDataCounter(DMA1_Channel5);
+
+    if(head == USART1_RX_BUF_SIZE)
+        head = 0;
+    if(head == USART1_RX_Tail)
+        return;
+
+    if(head < USART1_RX_Tail)       //DMAѻƣȷβ
+    {
+        USART1_RX_Post(&USART1_RX_Buf[USART1_RX_Tail],USART1_RX_BUF_SIZE - USART1_RX_Tail);
+        USART1_RX_Tail = 0;
+    }
+    if(head > USART1_RX_Tail)
+        USART1_RX_Post(&USART1_RX_Buf[USART1_RX_Tail],head - USART1_RX_Tail);
+
+    USART1_RX_Tail = head;
+}
+
+void USART1_IRQHandler() 
+{
+    OSIntEnter();       //ж
+    if(USART_GetITStatus(USART1,USART_IT_IDLE) != RESET)
+    {
+        USART1_RX_Update();
+        USART_ReceiveData( USART1 );        //б־λ(ȶUSART_SRȻUSART_DR)
     }
     OSIntExit();       //˳ж   
    
 }
 
 
+void DMA1_Channel5_IRQHandler()     //USART1DMA/ȫ
+{
+    OSIntEnter();       //ж
+    if(DMA_GetITStatus(DMA1_IT_HT5) != RESET || DMA_GetITStatus(DMA1_IT_TC5) != RESET)
+    {
+        USART1_RX_Update();
+        DMA_ClearITPendingBit(DMA1_IT_HT5 | DMA1_IT_TC5);
+    }
+    OSIntExit();       //˳ж
+}
+
+
 
-void EXTI1_IRQHandler()     //ǰ
+#if SENSOR_SIGNAL_QUEUE
+static void Sensor_Signal(OS_FLAGS sensors)     //Աõľÿȡһڴ顢һϢ
 {
     OS_ERR err;
     char * p_mem_blk;
-    OSIntEnter();       //ж
-    p_mem_blk =(char*) OSMemGet(&mem,&err);
-    if(EXTI_GetITStatus(EXTI_Line1) != RESET)
+    uint8_t id;
+    for(id=1;id<=4;id++)
     {
-		* p_mem_blk = 1;     //ȡյ        
-		OSTaskQPost ((OS_TCB      *)&Position_TCB,      //ĿĿƿ
+        if(!(sensors&SENSOR_FLAG(id)))
+            continue;
+        p_mem_blk =(char*) OSMemGet(&mem,&err);
+        * p_mem_blk = id;     //ȡյ        
+        OSTaskQPost ((OS_TCB      *)&Position_TCB,      //ĿĿƿ
                      (void        *)p_mem_blk,             //Ϣݵ׵ַ
                      (OS_MSG_SIZE  )1,                     //Ϣ
                      (OS_OPT       )OS_OPT_POST_FIFO,      //Ϣеڶ
                      (OS_ERR      *)&err);                 //ش  
-        EXTI_ClearITPendingBit(EXTI_Line4);
     }
-    
-    OSIntExit();       //˳ж   
-    
 }
+#else
+static void Sensor_Signal(OS_FLAGS sensors)     //Ĵһλڴ棬Position ûüȡʱλһ
+{
+    OS_ERR err;
+    OSFlagPost(&Sensor_Flags,sensors,OS_OPT_POST_FLAG_SET,&err);
+}
+#endif
 
 
-void EXTI2_IRQHandler()     //󴫸
+
+void TIM7_IRQHandler()      //DEB_HZ
 {
     OS_ERR err;
-    char * p_mem_blk;
-    OSIntEnter();       //ж
-    p_mem_blk =(char*) OSMemGet(&mem,&err);
+    CPU_TS ts=CPU_TS_TmrRd();
+    OS_FLAGS sensors=0;
+    uint8_t fired,i;
+    if(TIM_GetITStatus(TIM7,TIM_IT_Update) != RESET)
+    {
+        TIM_ClearITPendingBit(TIM7,TIM_IT_Update);
+        fired=Debounce_Tick();
+        if(fired)                   //ûģϵͳ
+        {
+            OSIntEnter();       //ж
+            if(fired&(1<<DEB_KEY1))
+                OSTaskSemPost(&Key1_Scan_TCB,OS_OPT_POST_NONE,&err);        //Key1_ScanϢ
+            if(fired&(1<<DEB_KEY2))
+                OSTaskSemPost(&Key2_Scan_TCB,OS_OPT_POST_NONE,&err);
+            for(i=DEB_FRONT;i<DEB_LINE_NUM;i++)
+                if(fired&(1<<i))
+                    sensors|=SENSOR_FLAG(i-DEB_FRONT+1);
+            if(sensors)
+            {
+                Sensor_Signal(sensors);
+                Isr_Time(ISR_TIME_SIGNAL,CPU_TS_TmrRd()-ts);
+            }
+            OSIntExit();       //˳ж
+        }
+    }
+}
+
+
+
+void EXTI1_IRQHandler()     //ǰֻϵͳ
+{
+    CPU_TS ts=CPU_TS_TmrRd();      //ȼѹʱ
+    if(EXTI_GetITStatus(EXTI_Line1) != RESET)
+    {
+        EXTI_ClearITPendingBit(EXTI_Line1);
+        Debounce_Edge(DEB_FRONT,ts);
+    }
+    Isr_Time(ISR_TIME_EDGE,CPU_TS_TmrRd()-ts);
+}
+
+
+void EXTI2_IRQHandler()     //󴫸
+{
+    CPU_TS ts=CPU_TS_TmrRd();
     if(EXTI_GetITStatus(EXTI_Line2) != RESET)
     {
-		* p_mem_blk = 2;     //ȡյ        
-		OSTaskQPost ((OS_TCB      *)&Position_TCB,      //ĿĿƿ
-                     (void        *)p_mem_blk,             //Ϣݵ׵ַ
-                     (OS_MSG_SIZE  )1,                     //Ϣ
-                     (OS_OPT       )OS_OPT_POST_FIFO,      //Ϣеڶ
-                     (OS_ERR      *)&err);                 //ش  
-        EXTI_ClearITPendingBit(EXTI_Line4);
+        EXTI_ClearITPendingBit(EXTI_Line2);
+        Debounce_Edge(DEB_BACK,ts);
     }
-    
-    OSIntExit();       //˳ж   
-    
+    Isr_Time(ISR_TIME_EDGE,CPU_TS_TmrRd()-ts);
 }
 
 
 void EXTI3_IRQHandler()         //󴫸
 {
-    OS_ERR err;
-    char * p_mem_blk;
-    OSIntEnter();       //ж
-    p_mem_blk =(char*) OSMemGet(&mem,&err);
+    CPU_TS ts=CPU_TS_TmrRd();
     if(EXTI_GetITStatus(EXTI_Line3) != RESET)
     {
-		* p_mem_blk = 3;     //ȡյ        
-		OSTaskQPost ((OS_TCB      *)&Position_TCB,      //ĿĿƿ
-                     (void        *)p_mem_blk,             //Ϣݵ׵ַ
-                     (OS_MSG_SIZE  )1,                     //Ϣ
-                     (OS_OPT       )OS_OPT_POST_FIFO,      //Ϣеڶ
-                     (OS_ERR      *)&err);                 //ش  
-        EXTI_ClearITPendingBit(EXTI_Line4);
+        EXTI_ClearITPendingBit(EXTI_Line3);
+        Debounce_Edge(DEB_LEFT,ts);
     }
-    
-    OSIntExit();       //˳ж   
-    
+    Isr_Time(ISR_TIME_EDGE,CPU_TS_TmrRd()-ts);
 }
 
 void EXTI9_5_IRQHandler()       //Ҵ
 {
-    OS_ERR err;
-    char * p_mem_blk;
-    OSIntEnter();       //ж
-    p_mem_blk =(char*) OSMemGet(&mem,&err);
+    CPU_TS ts=CPU_TS_TmrRd();
     if(EXTI_GetITStatus(EXTI_Line5) != RESET)
     {
-		* p_mem_blk = 4;     //ȡյ        
-		OSTaskQPost ((OS_TCB      *)&Position_TCB,      //ĿĿƿ
-                     (void        *)p_mem_blk,             //Ϣݵ׵ַ
-                     (OS_MSG_SIZE  )1,                     //Ϣ
-                     (OS_OPT       )OS_OPT_POST_FIFO,      //Ϣеڶ
-                     (OS_ERR      *)&err);                 //ش  
-        EXTI_ClearITPendingBit(EXTI_Line4);
+        EXTI_ClearITPendingBit(EXTI_Line5);
+        Debounce_Edge(DEB_RIGHT,ts);
     }
-    
-    OSIntExit();       //˳ж   
-    
+    Isr_Time(ISR_TIME_EDGE,CPU_TS_TmrRd()-ts);
 }
 
 
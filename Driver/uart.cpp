@@ -1,5 +1,14 @@
 #include "uart.h"
+#include "dma.h"
 #include "stdio.h"
+#include <string.h>
+
+#define USART1_TX_BUF_SIZE   512                //printfͻС
+
+static uint8_t USART1_TX_Buf[USART1_TX_BUF_SIZE];
+UART_DMA_TX USART1_TX(USART1,DMA1_Channel4,DMA1_IT_TC4,USART1_TX_Buf,USART1_TX_BUF_SIZE);
+
+static UART_DMA_TX* UART_DMA_TX_List[3];        //Ѿʼķͻ
 
  UART::UART(GPIO *RX,GPIO *TX)
 {
@@ -66,6 +75,131 @@ uint16_t UART::receive_data()
 }
 
 
+
+UART_DMA_TX::UART_DMA_TX(USART_TypeDef* USARTx,DMA_Channel_TypeDef* DMAy_Channelx,uint32_t DMAy_IT_TC,uint8_t *buf,uint16_t size)
+{
+	this->USARTx=USARTx;
+	this->DMAy_Channelx=DMAy_Channelx;
+	this->DMAy_IT_TC=DMAy_IT_TC;
+	this->buf=buf;
+	this->size=size;
+	head=0;
+	tail=0;
+	dma_len=0;
+	drop=0;
+	ready=false;
+}
+
+void UART_DMA_TX::inti(uint8_t NVIC_IRQChannel,uint8_t NVIC_IRQChannelPreemptionPriority,uint8_t NVIC_IRQChannelSubPriority)
+{
+	DMA tx_dma;
+	uint32_t primask;
+	
+	tx_dma.inti(DMAy_Channelx,(uint32_t)&USARTx->DR,(uint32_t)buf,DMA_DIR_PeripheralDST,0,
+	            DMA_PeripheralInc_Disable,DMA_MemoryInc_Enable,DMA_PeripheralDataSize_Byte,DMA_MemoryDataSize_Byte,
+	            DMA_Mode_Normal,DMA_Priority_Medium,DMA_M2M_Disable,RCC_AHBPeriph_DMA1);
+	tx_dma.cmd(DMAy_Channelx,DISABLE);            //ʱstart()
+	DMA_ITConfig(DMAy_Channelx,DMA_IT_TC,ENABLE);
+	
+	NVIC_InitTypeDef NVIC_mode;
+	NVIC_mode.NVIC_IRQChannel=NVIC_IRQChannel;
+	NVIC_mode.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_mode.NVIC_IRQChannelPreemptionPriority=NVIC_IRQChannelPreemptionPriority;
+	NVIC_mode.NVIC_IRQChannelSubPriority=NVIC_IRQChannelSubPriority;
+	NVIC_Init(&NVIC_mode);
+	
+	USART_DMACmd(USARTx,USART_DMAReq_Tx,ENABLE);
+	primask=__get_PRIMASK();
+	__disable_irq();
+	ready=true;
+	start();                                     //ͳʼǰѾд
+	__set_PRIMASK(primask);
+	
+	for(uint8_t i=0;i<3;i++)
+	{
+		if(UART_DMA_TX_List[i]==0||UART_DMA_TX_List[i]==this)
+		{
+			UART_DMA_TX_List[i]=this;
+			break;
+		}
+	}
+}
+
+UART_DMA_TX* UART_DMA_TX::find(USART_TypeDef* USARTx)
+{
+	for(uint8_t i=0;i<3;i++)
+	{
+		if(UART_DMA_TX_List[i]!=0&&UART_DMA_TX_List[i]->USARTx==USARTx)
+			return UART_DMA_TX_List[i];
+	}
+	return 0;
+}
+
+void UART_DMA_TX::start()           //жʱãDMAβһ
+{
+	uint16_t n;
+	
+	if(!ready||dma_len!=0||head==tail)
+		return;
+	n=(head>tail)?(head-tail):(size-tail);      //ĩβĲһδ
+	DMAy_Channelx->CCR&=~DMA_CCR1_EN;
+	DMAy_Channelx->CMAR=(uint32_t)&buf[tail];
+	DMAy_Channelx->CNDTR=n;
+	dma_len=n;
+	DMAy_Channelx->CCR|=DMA_CCR1_EN;
+}
+
+uint16_t UART_DMA_TX::write(const void *data,uint16_t len,bool wait)
+{
+	const uint8_t *p=(const uint8_t *)data;
+	uint32_t primask;
+	uint16_t used,first;
+	
+	if(len==0)
+		return 0;
+	
+	while(1)
+	{
+		primask=__get_PRIMASK();
+		__disable_irq();                     //ֻ±꣬ʱlenȣȴ
+		used=(uint16_t)((head+size-tail)%size);
+		if(len<size-used)
+			break;
+		if(!wait||!ready||len>=size)        //inti()֮ǰDMAڳռ䣬ȥѭ
+		{
+			drop+=len;
+			__set_PRIMASK(primask);
+			return 0;
+		}
+		__set_PRIMASK(primask);              //DMAжڳռ
+	}
+	
+	first=(len<size-head)?len:(size-head);
+	memcpy(&buf[head],p,first);
+	memcpy(&buf[0],p+first,len-first);
+	head=(uint16_t)((head+len)%size);
+	start();
+	__set_PRIMASK(primask);
+	return len;
+}
+
+void UART_DMA_TX::irq()
+{
+	if(DMA_GetITStatus(DMAy_IT_TC)!=RESET)
+	{
+		DMA_ClearITPendingBit(DMAy_IT_TC);
+		tail=(uint16_t)((tail+dma_len)%size);
+		dma_len=0;
+		start();                                 //ŷһ
+	}
+}
+
+uint32_t UART_DMA_TX::drop_count()
+{
+	return drop;
+}
+
+
  #ifdef __cplusplus
 extern "C"
 {
@@ -73,12 +207,30 @@ extern "C"
 	
 	int std::fputc(int ch, FILE *f)
 {
-USART_SendData(USART1, (uint8_t) ch);
-while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);	
+uint8_t c=(uint8_t)ch;
+USART1_TX.write(&c,1,false);        //ȴڣ
 return (ch);
 }
 
 
+uint16_t log_write(const char *str,uint16_t len)
+{
+	return USART1_TX.write(str,len,false);
+}
+
+
+uint32_t log_drop_count(void)
+{
+	return USART1_TX.drop_count();
+}
+
+
+void DMA1_Channel4_IRQHandler()     //USART1DMA
+{
+	USART1_TX.irq();
+}
+
+
 int std::fgetc(FILE *f)
 {
 	while (USART_GetFlagStatus(USART1, USART_FLAG_RXNE) == RESET);
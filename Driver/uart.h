@@ -103,4 +103,48 @@ class UART
 
 
 
+/*
+UART_DMA_TX  DMAͻλ
+	write() ֻݿλͷأDMAں̨ͣDMAжŷһΣʽ䣩
+	ʱ wait=false ֱӶۼ dropwait=true ȴDMAڳռ䣨ڲܶݣATָinti()֮ǰȴ
+	
+	
+	USARTx					USART1/USART2/USART3
+	DMAy_Channelx		ӦķDMAͨ	USART1_TX:DMA1_Channel4	USART2_TX:DMA1_Channel7	USART3_TX:DMA1_Channel2
+	DMAy_IT_TC			ͨĴжϱ־	 DMA1_IT_TC4
+	buf	size				λʵʿ size-1 ֽ
+	
+	inti()	DMAͨ䷢жϣжϺе irq()
+*/
+
+class UART_DMA_TX
+{
+	public:
+	UART_DMA_TX(USART_TypeDef* USARTx,DMA_Channel_TypeDef* DMAy_Channelx,uint32_t DMAy_IT_TC,uint8_t *buf,uint16_t size);
+	void inti(uint8_t NVIC_IRQChannel,uint8_t NVIC_IRQChannelPreemptionPriority,uint8_t NVIC_IRQChannelSubPriority);
+	uint16_t write(const void *data,uint16_t len,bool wait);   //дֽʱ0
+	void irq();                                                 //DMAͨжϺе
+	uint32_t drop_count();                                      //򻺳ֽ
+	static UART_DMA_TX* find(USART_TypeDef* USARTx);           //Ѿinti()Ĵڣûз0
+	
+	private:
+	void start();
+	USART_TypeDef* USARTx;
+	DMA_Channel_TypeDef* DMAy_Channelx;
+	uint32_t DMAy_IT_TC;
+	uint8_t *buf;
+	uint16_t size;
+	volatile uint16_t head;            //дλ
+	volatile uint16_t tail;            //DMAλ
+	volatile uint16_t dma_len;         //ڷ͵ĳȣ0ʾDMA
+	volatile uint32_t drop;
+	bool ready;                        //inti()֮DMA
+};
+
+extern UART_DMA_TX USART1_TX;           //USART1(printf)ͻ
+
+
+
+
+
 #endif
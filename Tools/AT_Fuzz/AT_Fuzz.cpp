@@ -0,0 +1,324 @@
+/*
+AT_Parser ģԣڵУ
+
+ESP8266Ӧ(OK/ERROR/FAIL/SEND OK/SEND FAIL/ͨ/'>'/+IPD)
+ĿСĻС USART3_IRQHandler һд뻺 feed()
+ֳıʱһ¡ݶƴԭһ¡ָ붼ڻ
+ÿιһδֽڣָֻ뷶Χ( -fsanitize Խ)
+
+УڱĿ¼£
+	g++ -O1 -g -fsanitize=address,undefined -I../../Driver -o AT_Fuzz AT_Fuzz.cpp ../../Driver/AT_Parser.cpp
+	./AT_Fuzz [] []
+
+ libFuzzer
+	clang++ -g -fsanitize=fuzzer,address,undefined -DAT_LIBFUZZER -I../../Driver AT_Fuzz.cpp ../../Driver/AT_Parser.cpp
+*/
+
+#include "AT_Parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+struct Fuzz_Tok
+{
+    AT_Token    tok;
+    std::string str;            //еݣIPDΪݣPROMPTΪ
+    uint8_t     id;
+};
+
+
+static uint32_t Fuzz_Seed = 1;
+
+static uint32_t Fuzz_Rand(void)                         //xorshift32
+{
+    Fuzz_Seed ^= Fuzz_Seed << 13;
+    Fuzz_Seed ^= Fuzz_Seed >> 17;
+    Fuzz_Seed ^= Fuzz_Seed << 5;
+    return Fuzz_Seed;
+}
+
+static uint32_t Fuzz_Range(uint32_t n)
+{
+    return Fuzz_Rand() % n;
+}
+
+
+//ģ USART3_IRQHandler Ľջ
+static char                  Fuzz_Buf [ 1024 ];
+static uint16_t              Fuzz_Size;                 //ʹõĻС
+static uint16_t              Fuzz_Len;
+static std::vector<Fuzz_Tok> Fuzz_Out;
+static bool                  Fuzz_Bad;
+static AT_Parser *           Fuzz_Parser;
+
+static void Fuzz_Token(AT_Token tok, const char *p, uint16_t len, void *arg)
+{
+    Fuzz_Tok t;
+
+    if ( tok == AT_TOK_IPD )
+    {
+        if ( p != 0 || len > AT_IPD_MAX_LEN )
+            Fuzz_Bad = true;
+    }
+    else if ( tok >= AT_TOK_OK && tok <= AT_TOK_SEND_FAIL )
+    {
+        if ( p == 0 || strlen ( p ) != len )            //ؼַָ
+            Fuzz_Bad = true;
+    }
+    else if ( ( len == 0 && tok != AT_TOK_LINE ) || p < Fuzz_Buf || p + len > Fuzz_Buf + Fuzz_Len )
+    {
+        printf ( "slice out of buffer: tok %d off %ld len %u filled %u\n", tok, (long)( p - Fuzz_Buf ), len, Fuzz_Len );
+        Fuzz_Bad = true;
+        return;
+    }
+
+    if ( tok == AT_TOK_IPD_DATA && ! Fuzz_Out.empty() && Fuzz_Out.back().tok == AT_TOK_IPD_DATA )
+    {
+        Fuzz_Out.back().str.append ( p, len );          //ֶθƴȽ
+        return;
+    }
+    t.tok = tok;
+    t.id = Fuzz_Parser->ipd_id();
+    if ( tok != AT_TOK_IPD && tok != AT_TOK_PROMPT )
+        t.str.assign ( p, len );
+    if ( tok == AT_TOK_IPD )
+        t.str.assign ( len, '\0' );                     //ֻǳ
+    Fuzz_Out.push_back ( t );
+}
+
+
+static void Fuzz_Feed(AT_Parser *parser, const std::string &stream, bool one_byte)
+{
+    size_t   i = 0;
+    uint16_t n;
+
+    while ( i < stream.size() )
+    {
+        if ( Fuzz_Len >= Fuzz_Size - 1 )                //˴ͷд
+        {
+            parser->rebase ( Fuzz_Buf );
+            Fuzz_Len = 0;
+        }
+        n = one_byte ? 1 : 1 + Fuzz_Range ( 64 );
+        if ( n > Fuzz_Size - 1 - Fuzz_Len )
+            n = Fuzz_Size - 1 - Fuzz_Len;
+        if ( n > stream.size() - i )
+            n = stream.size() - i;
+        memcpy ( Fuzz_Buf + Fuzz_Len, stream.data() + i, n );
+        Fuzz_Len += n;
+        i += n;
+        parser->feed ( Fuzz_Len );
+    }
+}
+
+
+static void Fuzz_Line(std::string &stream, std::vector<Fuzz_Tok> &expect)
+{
+    static const char *key [ ] = { "OK", "ERROR", "FAIL", "SEND OK", "SEND FAIL" };
+    static const AT_Token tok [ ] = { AT_TOK_OK, AT_TOK_ERROR, AT_TOK_FAIL, AT_TOK_SEND_OK, AT_TOK_SEND_FAIL };
+    static const char chars [ ] = "abcXYZ019 ,:+.\"\r";
+    Fuzz_Tok    t;
+    std::string line, text;
+    uint32_t    i, n;
+
+    t.id = 0;
+    if ( Fuzz_Range ( 2 ) )
+    {
+        i = Fuzz_Range ( 5 );
+        line = key [ i ];
+        t.tok = tok [ i ];
+    }
+    else
+    {
+        line = chars [ Fuzz_Range ( 6 ) ];              //Կո'>''+'ͷ
+        n = Fuzz_Range ( 40 );
+        for ( i = 0; i < n; i++ )
+            line += chars [ Fuzz_Range ( sizeof ( chars ) - 1 ) ];
+        t.tok = AT_TOK_LINE;
+    }
+    if ( Fuzz_Range ( 4 ) == 0 )
+        line = "\r" + line;
+
+    for ( i = 0; i < line.size(); i++ )
+        if ( line [ i ] != '\r' )
+            text += line [ i ];
+    if ( t.tok == AT_TOK_LINE )
+    {
+        for ( i = 0; i < 5; i++ )                       //ɵڹؼ
+            if ( text == key [ i ] )
+                t.tok = tok [ i ];
+    }
+
+    stream += line + "\r\n";
+    if ( text.empty() )                                 //ֻ'\r'Ŀв
+        return;
+    t.str = line;
+    while ( ! t.str.empty() && t.str [ t.str.size() - 1 ] == '\r' )
+        t.str.erase ( t.str.size() - 1 );
+    if ( t.tok != AT_TOK_LINE )
+        t.str = text;
+    expect.push_back ( t );
+}
+
+
+static void Fuzz_Ipd(std::string &stream, std::vector<Fuzz_Tok> &expect)
+{
+    static const char *evil [ ] = { "\r\n", "OK\r\n", "+IPD,1,3:", ">", "ERROR" };
+    Fuzz_Tok t;
+    uint32_t len = Fuzz_Range ( 8 ) ? Fuzz_Range ( 64 ) : Fuzz_Range ( AT_IPD_MAX_LEN + 1 );
+    std::string data;
+    char     head [ 32 ];
+
+    t.id = Fuzz_Range ( 5 );
+    while ( data.size() < len )                         //дؼ
+    {
+        if ( Fuzz_Range ( 8 ) == 0 )
+            data += evil [ Fuzz_Range ( 5 ) ];
+        else
+            data += (char)Fuzz_Range ( 256 );
+    }
+    data.resize ( len );
+
+    if ( Fuzz_Range ( 2 ) )
+        sprintf ( head, "+IPD,%u,%u:", t.id, len );
+    else
+    {
+        sprintf ( head, "+IPD,%u:", len );
+        t.id = 0;
+    }
+    stream += head;
+    stream += data;
+
+    t.tok = AT_TOK_IPD;
+    t.str.assign ( len, '\0' );
+    expect.push_back ( t );
+    if ( len )
+    {
+        t.tok = AT_TOK_IPD_DATA;
+        t.str = data;
+        expect.push_back ( t );
+    }
+}
+
+
+static bool Fuzz_Same(const Fuzz_Tok &a, const Fuzz_Tok &b, bool wrapped)
+{
+    if ( a.tok != b.tok )
+        return false;
+    if ( a.tok == AT_TOK_IPD || a.tok == AT_TOK_IPD_DATA )
+        return a.id == b.id && a.str == b.str;
+    if ( wrapped && a.tok == AT_TOK_LINE )              //;صͷʱֻʣ
+        return b.str.size() <= a.str.size() && a.str.compare ( a.str.size() - b.str.size(), b.str.size(), b.str ) == 0;
+    return a.str == b.str;
+}
+
+
+static bool Fuzz_Round(uint32_t round)
+{
+    std::vector<Fuzz_Tok> expect;
+    std::string           stream, noise;
+    AT_Parser             parser ( Fuzz_Token, 0 );
+    Fuzz_Tok              t;
+    bool                  one_byte = Fuzz_Range ( 2 );
+    uint32_t              i, n = 1 + Fuzz_Range ( 60 );
+
+    Fuzz_Parser = &parser;
+    Fuzz_Size = Fuzz_Range ( 3 ) ? sizeof ( Fuzz_Buf ) : 16 + Fuzz_Range ( sizeof ( Fuzz_Buf ) - 16 );
+    Fuzz_Len = 0;
+    Fuzz_Out.clear();
+    Fuzz_Bad = false;
+    parser.reset ( Fuzz_Buf );
+
+    for ( i = 0; i < n; i++ )
+    {
+        switch ( Fuzz_Range ( 4 ) )
+        {
+            case 0:
+                Fuzz_Ipd ( stream, expect );
+                break;
+            case 1:
+                stream += Fuzz_Range ( 2 ) ? "> " : ">\r\n";
+                t.tok = AT_TOK_PROMPT;
+                t.str.clear();
+                t.id = 0;
+                expect.push_back ( t );
+                break;
+            default:
+                Fuzz_Line ( stream, expect );
+                break;
+        }
+    }
+    Fuzz_Feed ( &parser, stream, one_byte );
+
+    if ( Fuzz_Bad || Fuzz_Out.size() != expect.size() )
+    {
+        printf ( "round %u: %u tokens, expected %u\n", round, (unsigned)Fuzz_Out.size(), (unsigned)expect.size() );
+        return false;
+    }
+    for ( i = 0; i < expect.size(); i++ )
+    {
+        if ( ! Fuzz_Same ( expect [ i ], Fuzz_Out [ i ], stream.size() >= Fuzz_Size - 1u ) )
+        {
+            printf ( "round %u: token %u differs (tok %d/%d)\n", round, i, expect [ i ].tok, Fuzz_Out [ i ].tok );
+            return false;
+        }
+    }
+
+    n = Fuzz_Range ( 4096 );                            //ιֽڣֻԽ
+    for ( i = 0; i < n; i++ )
+        noise += (char)( Fuzz_Range ( 4 ) ? Fuzz_Range ( 256 ) : "+IPD,:0123456789>\r\n" [ Fuzz_Range ( 19 ) ] );
+    Fuzz_Feed ( &parser, noise, one_byte );
+    if ( Fuzz_Bad )
+    {
+        printf ( "round %u: bad slice on random input\n", round );
+        return false;
+    }
+    return true;
+}
+
+
+#ifdef AT_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    AT_Parser   parser ( Fuzz_Token, 0 );
+    std::string stream ( (const char *)data, size );
+
+    Fuzz_Parser = &parser;
+    Fuzz_Seed = size + 1;
+    Fuzz_Size = size ? 16 + data [ 0 ] * 3 : sizeof ( Fuzz_Buf );
+    Fuzz_Len = 0;
+    Fuzz_Out.clear();
+    Fuzz_Bad = false;
+    parser.reset ( Fuzz_Buf );
+    Fuzz_Feed ( &parser, stream, size & 1 );
+    if ( Fuzz_Bad )
+        abort();
+    return 0;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+    uint32_t rounds = argc > 1 ? strtoul ( argv [ 1 ], 0, 0 ) : 20000;
+    uint32_t i;
+
+    Fuzz_Seed = argc > 2 ? strtoul ( argv [ 2 ], 0, 0 ) : 12345;
+    if ( Fuzz_Seed == 0 )
+        Fuzz_Seed = 1;
+
+    for ( i = 0; i < rounds; i++ )
+    {
+        if ( ! Fuzz_Round ( i ) )
+            return 1;
+    }
+    printf ( "AT_Parser: %u rounds OK\n", rounds );
+    return 0;
+}
+
+#endif
@@ -0,0 +1,375 @@
+/*
+ESP8266 ATָģڵУ
+
+ʱģ 115200 µESP8266Ӧ𣬰 Driver/AT_Cmd.cppAT_Parser.cpp ԭ
+Ƚ Set_STA_Mode() ھɵ"ͺ̶ʱ"ʽ AT_Cmd ¼ʽµúʱ
+ٰ WiFi_Task ķͼƻUDPң( CIPSEND)ÿ10msռôڵʱ䣬ÿ֡һ SEND OK ÿһ(SEND OK ¸)ַʽ
+
+УڱĿ¼£
+	g++ -O2 -I../../Driver -o ESP8266_Sim ESP8266_Sim.cpp ../../Driver/AT_Cmd.cpp ../../Driver/AT_Parser.cpp ../../Driver/Telemetry.cpp
+	./ESP8266_Sim
+
+ָӦʱ Sim_Reply ʵģõĵֵд޸ġ
+*/
+
+#include "AT_Cmd.h"
+#include "Telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+#define SIM_BYTE_US        87                   //115200 8N1 һֽԼ 86.8us
+#define SIM_READY_MS       350                  //ϵ絽ӡ ready ʱ
+#define SIM_QUEUE_LEN      4096
+#define SIM_SEND_MS        3                    //CIPSEND 뵽 SEND OK ʱ(UDPȶԷȷ)
+
+
+struct Sim_Reply
+{
+    const char * cmd;               //ָǰ׺
+    uint32_t     latency_ms;        //ģ鴦ʱ
+    const char * reply;
+};
+
+static const Sim_Reply Sim_Table [ ] =
+{
+    { "AT+CWMODE=",   3,    "\r\nOK\r\n" },
+    { "AT+CWJAP=",    2600, "WIFI CONNECTED\r\nWIFI GOT IP\r\n\r\nOK\r\n" },
+    { "AT+CIPMUX=",   2,    "\r\nOK\r\n" },
+    { "AT+CIPSTART=", 120,  "CONNECT\r\n\r\nOK\r\n" },
+    { "AT+CIPMODE=",  2,    "\r\nOK\r\n" },
+    { "AT+CIPSEND=",  1,    "\r\nOK\r\n> " },             //ӷָ֮ͣȵ
+    { "AT+CIPSEND",   4,    "\r\nOK\r\n\r\n>" },
+    { "AT",           1,    "\r\nOK\r\n" },
+};
+
+
+static uint64_t Sim_Us;                                 //ʱ
+static uint64_t Sim_TxFree_Us;                          //ڷͿʱ
+
+static struct { uint64_t t; char ch; } Sim_Queue [ SIM_QUEUE_LEN ];  //ģ齫Ҫֽ
+static uint32_t Sim_QHead, Sim_QTail;
+
+static char     Sim_Line [ 256 ];                       //ģյĵǰָ
+static uint16_t Sim_LineLen;
+
+static uint16_t Sim_DataLeft;                           //CIPSEND Ҫյֽ
+static uint16_t Sim_DataLen;
+
+static char     Sim_RxBuf [ 1024 ];                     //MCUջ
+static uint16_t Sim_RxLen;
+
+static AT_Cmd * Sim_At;                                 //0ʾɷʽ÷ִʽ
+static bool     Sim_Event;                              //൱ ESP8266_RxSem 
+
+static void Sim_Token(AT_Token tok, const char *p, uint16_t len, void *arg)
+{
+    if ( Sim_At && Sim_At->on_token ( tok, p, len ) )
+        Sim_Event = true;
+}
+static AT_Parser Sim_Parser ( Sim_Token, 0 );
+
+
+static void Sim_Emit(uint64_t t, const char *str)       //ģtʱ̿ʼstr
+{
+    for ( ; *str; str++, t += SIM_BYTE_US )
+    {
+        Sim_Queue [ Sim_QTail % SIM_QUEUE_LEN ].t = t;
+        Sim_Queue [ Sim_QTail % SIM_QUEUE_LEN ].ch = *str;
+        Sim_QTail ++;
+    }
+}
+
+static void Sim_Exec(const char *line)                  //ģִһָ
+{
+    uint64_t t = Sim_TxFree_Us;
+    unsigned i;
+
+    if ( Sim_QHead != Sim_QTail && Sim_Queue [ ( Sim_QTail - 1 ) % SIM_QUEUE_LEN ].t > t )
+        t = Sim_Queue [ ( Sim_QTail - 1 ) % SIM_QUEUE_LEN ].t;      //ģ鰴˳
+
+    for ( i = 0; i < sizeof ( Sim_Table ) / sizeof ( Sim_Table [ 0 ] ); i++ )
+    {
+        if ( strncmp ( line, Sim_Table [ i ].cmd, strlen ( Sim_Table [ i ].cmd ) ) == 0 )
+        {
+            if ( strncmp ( line, "AT+CIPSEND=", 11 ) == 0 )
+            {
+                const char * comma = strchr ( line, ',' );
+                Sim_DataLen = Sim_DataLeft = atoi ( comma ? comma + 1 : line + 11 );
+            }
+            Sim_Emit ( t + Sim_Table [ i ].latency_ms * 1000u, Sim_Table [ i ].reply );
+            return;
+        }
+    }
+    Sim_Emit ( t + 1000u, "\r\nERROR\r\n" );
+}
+
+static bool Sim_Deliver(uint64_t until, bool stop_on_event)     //until֮ǰֽڷŽջ
+{
+    char ch;
+
+    while ( Sim_QHead != Sim_QTail && Sim_Queue [ Sim_QHead % SIM_QUEUE_LEN ].t <= until )
+    {
+        ch = Sim_Queue [ Sim_QHead % SIM_QUEUE_LEN ].ch;
+        if ( Sim_Queue [ Sim_QHead % SIM_QUEUE_LEN ].t > Sim_Us )
+            Sim_Us = Sim_Queue [ Sim_QHead % SIM_QUEUE_LEN ].t;
+        Sim_QHead ++;
+
+        if ( Sim_RxLen >= sizeof ( Sim_RxBuf ) - 1 )   // USART3_IRQHandler ͬ˴ͷд
+        {
+            Sim_Parser.rebase ( Sim_RxBuf );
+            Sim_RxLen = 0;
+        }
+        Sim_RxBuf [ Sim_RxLen ++ ] = ch;
+        Sim_RxBuf [ Sim_RxLen ] = '\0';
+        Sim_Parser.feed ( Sim_RxLen );
+
+        if ( stop_on_event && Sim_Event )
+        {
+            Sim_Event = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static void Sim_Port_Send(const char *str)
+{
+    for ( ; *str; str++ )
+    {
+        if ( Sim_TxFree_Us < Sim_Us )
+            Sim_TxFree_Us = Sim_Us;
+        Sim_TxFree_Us += SIM_BYTE_US;
+
+        if ( *str == '\n' )
+        {
+            Sim_Line [ Sim_LineLen ] = '\0';
+            if ( Sim_LineLen && Sim_Line [ Sim_LineLen - 1 ] == '\r' )
+                Sim_Line [ Sim_LineLen - 1 ] = '\0';
+            Sim_Exec ( Sim_Line );
+            Sim_LineLen = 0;
+        }
+        else if ( Sim_LineLen < sizeof ( Sim_Line ) - 1 )
+            Sim_Line [ Sim_LineLen ++ ] = *str;
+    }
+}
+
+static void Sim_Port_Write(const void *buf, uint16_t len)      //CIPSEND 
+{
+    char reply [ 48 ];
+
+    if ( Sim_TxFree_Us < Sim_Us )
+        Sim_TxFree_Us = Sim_Us;
+    Sim_TxFree_Us += (uint64_t)len * SIM_BYTE_US;
+    if ( ( Sim_DataLeft == 0 ) || ( len < Sim_DataLeft ) )
+    {
+        Sim_DataLeft -= ( len < Sim_DataLeft ) ? len : Sim_DataLeft;
+        return;
+    }
+    Sim_DataLeft = 0;
+    snprintf ( reply, sizeof ( reply ), "\r\nRecv %u bytes\r\n\r\nSEND OK\r\n", Sim_DataLen );
+    Sim_Emit ( Sim_TxFree_Us + SIM_SEND_MS * 1000u, reply );
+}
+
+static uint32_t Sim_Port_Now(void)
+{
+    return (uint32_t)( Sim_Us / 1000u );
+}
+
+static void Sim_Port_Wait(uint32_t ms)
+{
+    uint64_t deadline = Sim_Us + ms * 1000u;
+
+    if ( ! Sim_Deliver ( deadline, true ) )
+        Sim_Us = deadline;
+}
+
+static void Sim_Port_Sleep(uint32_t ms)
+{
+    Sim_Us += ms * 1000u;
+    Sim_Deliver ( Sim_Us, false );
+}
+
+static void Sim_Port_RxClear(void)
+{
+    Sim_Deliver ( Sim_Us, false );                      //ѾﵫûҪֽڶ
+    Sim_RxLen = 0;
+    Sim_RxBuf [ 0 ] = '\0';
+    Sim_Parser.rebase ( Sim_RxBuf );
+    Sim_Event = false;
+}
+
+static const char * Sim_Port_RxBuf(void)
+{
+    return Sim_RxBuf;
+}
+
+static const AT_Port Sim_Port =
+{
+    Sim_Port_Send,
+    Sim_Port_Now,
+    Sim_Port_Wait,
+    Sim_Port_Sleep,
+    Sim_Port_RxClear,
+    Sim_Port_RxBuf,
+    Sim_Port_Write,
+};
+
+
+static void Sim_PowerOn(void)
+{
+    Sim_Us = 0;
+    Sim_TxFree_Us = 0;
+    Sim_QHead = Sim_QTail = 0;
+    Sim_LineLen = 0;
+    Sim_RxLen = 0;
+    Sim_RxBuf [ 0 ] = '\0';
+    Sim_Parser.reset ( Sim_RxBuf );
+    Sim_Event = false;
+    Sim_Emit ( SIM_READY_MS * 1000u, "\r\nready\r\n" );
+}
+
+
+//ɷʽͺ̶ʱ waittime ٲӦԭ ESP8266::Cmd
+static bool Legacy_Cmd(const char *cmd, const char *reply1, const char *reply2, uint32_t waittime)
+{
+    Sim_Port_RxClear();
+    Sim_Port_Send ( cmd );
+    Sim_Port_Send ( "\r\n" );
+    if ( reply1 == 0 && reply2 == 0 )
+        return true;
+    Sim_Port_Sleep ( waittime );
+    return ( reply1 && strstr ( Sim_RxBuf, reply1 ) ) || ( reply2 && strstr ( Sim_RxBuf, reply2 ) );
+}
+
+static uint32_t Legacy_Set_STA_Mode(void)
+{
+    Sim_At = 0;
+    Sim_PowerOn();
+    Sim_Port_Sleep ( 1000 );                                                    //AT_Test
+    while ( ! Legacy_Cmd ( "AT", "OK", 0, 500 ) );
+    Legacy_Cmd ( "AT+CWMODE=1", "OK", "no change", 2500 );                      //Set_NetMode
+    while ( ! Legacy_Cmd ( "AT+CWJAP=\"ssid\",\"pwd\"", "OK", 0, 5000 ) );      //JoinAP
+    Legacy_Cmd ( "AT+CIPMUX=0", "OK", 0, 500 );                                 //MultipleId
+    while ( ! Legacy_Cmd ( "AT+CIPSTART=\"TCP\",\"192.168.0.11\",8080", "OK", "ALREAY CONNECT", 4000 ) );
+    while ( ! ( Legacy_Cmd ( "AT+CIPMODE=1", "OK", 0, 500 ) && Legacy_Cmd ( "AT+CIPSEND", "OK", ">", 500 ) ) );
+    return Sim_Port_Now();
+}
+
+
+//·ʽ ESP8266::Set_STA_Mode() ָͬУ AT_Cmd ִ
+static uint32_t Engine_Set_STA_Mode(void)
+{
+    AT_Cmd at ( &Sim_Port );
+
+    Sim_At = &at;
+    Sim_PowerOn();
+    at.exec ( 0, "ready", 0, 1000 );                                            //AT_Test
+    while ( ! at.exec ( "AT", "OK", 0, 500 ) );
+    at.submit ( "AT+CWMODE=1", "OK", "no change", 2500, 0, 0 );
+    at.submit ( "AT+CIPMUX=0", "OK", 0, 500, 0, 0 );
+    at.process();
+    while ( ! at.exec ( "AT+CWJAP=\"ssid\",\"pwd\"", "OK", 0, 5000 ) );
+    while ( ! at.exec ( "AT+CIPSTART=\"TCP\",\"192.168.0.11\",8080", "OK", "ALREAY CONNECT", 4000 ) );
+    while ( ! ( at.exec ( "AT+CIPMODE=1", "OK", 0, 500 ) && at.exec ( "AT+CIPSEND", "OK", ">", 500 ) ) );
+    return Sim_Port_Now();
+}
+
+
+//UDPң⣺ WiFi_Task ļƻ1룬batchΪʱڵ֡ƴһ(Tlm_Flush)ÿ֡һ CIPSEND
+static uint8_t  Udp_Buf [ 256 ];
+static uint16_t Udp_Len;
+static bool     Udp_Batch;
+static AT_Cmd * Udp_At;
+static uint32_t Udp_Fail;
+
+static uint16_t Udp_Write(const uint8_t *buf, uint16_t len)
+{
+    char cmd [ 32 ];
+
+    if ( Udp_Batch )
+    {
+        memcpy ( &Udp_Buf [ Udp_Len ], buf, len );
+        Udp_Len += len;
+        return len;
+    }
+    snprintf ( cmd, sizeof ( cmd ), "AT+CIPSEND=1,%u", len );
+    if ( ! Udp_At->send_data ( cmd, buf, len, 500, true ) )
+        Udp_Fail ++;
+    return len;
+}
+
+static double Engine_Udp_Tlm(bool batch, uint32_t *worst_us, uint32_t *late)
+{
+    AT_Cmd      at ( &Sim_Port );
+    Telemetry   tlm ( Udp_Write );
+    Tlm_Pose    pose = { 0, 0, 0, 0, 0 };
+    Tlm_Wheel   wheel = { { 200, 200, 200, 200 } };
+    Tlm_Mission mission = { 0, 0, 1 };
+    Tlm_Vision  vision = { 2, 1, 160, 120 };
+    char        cmd [ 32 ];
+    uint64_t    start, t0;
+    uint32_t    n;
+
+    Sim_At = &at;
+    Udp_At = &at;
+    Udp_Batch = batch;
+    Udp_Fail = 0;
+    *worst_us = 0;
+    *late = 0;
+    Sim_PowerOn();
+    Sim_QHead = Sim_QTail = 0;                                                  //Ѿã ready
+    start = Sim_Us;
+    Udp_Len = 0;
+    for ( n = 0; n < 100; n++ )
+    {
+        t0 = Sim_Us;
+        tlm.pose ( n * 10, &pose );
+        if ( n % 5 == 0 )
+            tlm.wheel ( n * 10, &wheel );
+        if ( n % 20 == 0 )
+            tlm.mission ( n * 10, &mission );
+        if ( n % 20 == 10 )
+            tlm.vision ( n * 10, &vision );
+        if ( batch && ( n % 2 == 1 ) )                                          //TLM_FLUSH_DIV
+        {
+            snprintf ( cmd, sizeof ( cmd ), "AT+CIPSEND=1,%u", Udp_Len );
+            if ( ! at.send_data ( cmd, Udp_Buf, Udp_Len, 500, false ) )    //ͬ Tlm_FlushSEND OK һ
+                Udp_Fail ++;
+            Udp_Len = 0;
+        }
+        if ( Sim_Us - t0 > *worst_us )
+            *worst_us = Sim_Us - t0;
+        if ( Sim_Us < start + ( n + 1 ) * 10000u )                              //OS_OPT_TIME_PERIODIC˵һϿʼ
+            Sim_Us = start + ( n + 1 ) * 10000u;
+        else
+            ( *late ) ++;
+    }
+    Udp_Fail += at.send_fails();
+    return ( Sim_Us - start ) / 100.0 / 1000.0;
+}
+
+
+int main(void)
+{
+    uint32_t legacy = Legacy_Set_STA_Mode();
+    uint32_t engine = Engine_Set_STA_Mode();
+    uint32_t worst_frame, worst_batch, late_frame, late_batch, fail_frame;
+    double   per_frame, per_batch;
+
+    printf ( "Set_STA_Mode  fixed delay_ms : %5u ms\n", (unsigned)legacy );
+    printf ( "Set_STA_Mode  AT_Cmd events  : %5u ms\n", (unsigned)engine );
+    printf ( "(CWJAP alone takes %u ms in this model)\n", (unsigned)Sim_Table [ 1 ].latency_ms );
+
+    per_frame = Engine_Udp_Tlm ( false, &worst_frame, &late_frame );
+    fail_frame = Udp_Fail;
+    per_batch = Engine_Udp_Tlm ( true, &worst_batch, &late_batch );
+    printf ( "UDP telemetry, CIPSEND per frame  : period %.2f ms, worst tick %.2f ms, %u/100 ticks late, fails %u\n",
+             per_frame, worst_frame / 1000.0, late_frame, fail_frame );
+    printf ( "UDP telemetry, CIPSEND per 2 ticks: period %.2f ms, worst tick %.2f ms, %u/100 ticks late, fails %u\n",
+             per_batch, worst_batch / 1000.0, late_batch, Udp_Fail );
+    return ( engine < legacy ) && ( per_batch < 10.05 ) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+ңַģڵУ
+
+ Driver/Tlm_Fanout.cppTelemetry.cpp ԭʱģģʽ(WIFI_LINK_SERVER)
+WiFi_Task ķͼƻ(λ100Hz/5/20Ӿ/20ģʱÿ pump() һ)115200 CIPSEND ĺʱ
+ĸͻˣԿͼ¼ȫֻֻӾĸֻλˡ
+ڶֻ(SEND OK Ҫ -s Ż ESP8266_SEND_TIMEOUT ʧ)ͻǷӰ졣
+
+УڱĿ¼£
+	g++ -O2 -I../../Driver -o Fan_Sim Fan_Sim.cpp ../../Driver/Tlm_Fanout.cpp ../../Driver/Telemetry.cpp
+	./Fan_Sim [-t ] [-s ͻ SEND OK ʱms]
+*/
+
+#include "Tlm_Fanout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+#define SIM_BYTE_US        87              //115200 8N1
+#define SIM_TICK_US        10000
+#define SIM_SEND_TIMEOUT   100             //ͬ ESP8266_SEND_TIMEOUT
+#define SIM_SEND_OK_MS     3               //ͻ뵽 SEND OK
+
+
+static uint64_t Sim_Us;
+static uint64_t Sim_Start_Us;              //һηͽݵʱ̣SEND OK ĳʱ
+static uint64_t Sim_Done_Us;               //һη͵ SEND OK ʱ
+static bool     Sim_Pending;
+static uint8_t  Sim_Slow = 0xFF;           //ͻ˵Ӻ
+static uint32_t Sim_Slow_Ms;
+
+
+//һ CIPSENDָ'>'ݽDMAͷأSEND OK һ(ͬ Tlm_Flush õ Send_Id(...,false))
+static bool Sim_Send(uint8_t id, const uint8_t *buf, uint16_t len, bool *prev_lost)
+{
+    uint64_t limit;
+
+    (void)buf;
+    if ( Sim_Pending )                                          //AT_Cmd::settle()
+    {
+        limit = Sim_Start_Us + SIM_SEND_TIMEOUT * 1000u;
+        *prev_lost = Sim_Done_Us > limit;
+        if ( Sim_Us < ( *prev_lost ? limit : Sim_Done_Us ) )
+            Sim_Us = *prev_lost ? limit : Sim_Done_Us;
+        Sim_Pending = false;
+    }
+    Sim_Us += ( 17 + 8 ) * SIM_BYTE_US + 1000;                  //"AT+CIPSEND=n,len"  "OK\r\n> "
+    Sim_Start_Us = Sim_Us;
+    Sim_Done_Us = Sim_Us + len * SIM_BYTE_US + ( id == Sim_Slow ? Sim_Slow_Ms : SIM_SEND_OK_MS ) * 1000u + 28 * SIM_BYTE_US;
+    Sim_Pending = true;
+    return true;
+}
+
+static bool Sim_Busy(void)                                      //ESP8266::Send_Busy()
+{
+    return Sim_Pending && ( Sim_Us < Sim_Done_Us ) && ( Sim_Us < Sim_Start_Us + SIM_SEND_TIMEOUT * 1000u );
+}
+
+
+static Tlm_Fanout *Sim_Fan;
+static uint16_t Sim_Write(const uint8_t *buf, uint16_t len)
+{
+    return Sim_Fan->publish ( buf, len );
+}
+
+
+static void Sim_Run(uint32_t seconds, uint8_t slow, uint32_t slow_ms)
+{
+    static const char * name [ 4 ] = { "dashboard", "logger", "phone", "pose-only" };
+    Tlm_Fanout  fan ( Sim_Send );
+    Telemetry   tlm ( Sim_Write );
+    Tlm_Pose    pose = { 0, 0, 0, 0, 0 };
+    Tlm_Wheel   wheel = { { 200, 200, 200, 200 } };
+    Tlm_Mission mission = { 0, 0, 1 };
+    Tlm_Vision  vision = { 2, 1, 160, 120 };
+    Fan_Stat    st;
+    uint32_t    n, t, late = 0, offered [ 4 ] = { 0 };
+    uint8_t     i;
+
+    Sim_Fan = &fan;
+    Sim_Us = 0;
+    Sim_Pending = false;
+    Sim_Slow = slow;
+    Sim_Slow_Ms = slow_ms;
+    for ( i = 0; i < 4; i++ )
+        fan.open ( i, 0 );
+    fan.subscribe ( 2, ( 1u << TLM_ID_MISSION ) | ( 1u << TLM_ID_VISION ) );
+    fan.subscribe ( 3, 1u << TLM_ID_POSE );
+
+    for ( n = 0; n < seconds * 100; n++ )
+    {
+        if ( Sim_Us < (uint64_t)n * SIM_TICK_US )               //OS_OPT_TIME_PERIODIC
+            Sim_Us = (uint64_t)n * SIM_TICK_US;
+        else if ( n )
+            late ++;
+        t = Sim_Us / 1000;
+        tlm.pose ( t, &pose );
+        offered [ 0 ] ++; offered [ 1 ] ++; offered [ 3 ] ++;
+        if ( n % 5 == 0 )
+        {
+            tlm.wheel ( t, &wheel );
+            offered [ 0 ] ++; offered [ 1 ] ++;
+        }
+        if ( n % 20 == 0 )
+        {
+            tlm.mission ( t, &mission );
+            offered [ 0 ] ++; offered [ 1 ] ++; offered [ 2 ] ++;
+        }
+        if ( n % 20 == 10 )
+        {
+            tlm.vision ( t, &vision );
+            offered [ 0 ] ++; offered [ 1 ] ++; offered [ 2 ] ++;
+        }
+        if ( ! Sim_Busy () )                                    //ͬ Fan_Flush()
+            fan.pump ();
+    }
+
+    printf ( "%u s, %s, %u/%u ticks late\n", seconds, slow < 4 ? "phone slow" : "all clients healthy", late, seconds * 100 );
+    for ( i = 0; i < 4; i++ )
+    {
+        fan.stat ( i, &st );
+        printf ( "  %-10s offered %5u  sent %5u  dropped %5u (%4.1f%%)  fails %3u  %5.0f B/s  queue max %u\n",
+                 name [ i ], offered [ i ], st.frames, st.drops, offered [ i ] ? 100.0 * st.drops / offered [ i ] : 0.0,
+                 st.fails, st.bytes / (double)seconds, st.queued_max );
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t seconds = 20, slow_ms = 300;
+    int      opt;
+
+    while ( ( opt = getopt ( argc, argv, "t:s:" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 't': seconds = atoi ( optarg ); break;
+            case 's': slow_ms = atoi ( optarg ); break;
+            default:
+                fprintf ( stderr, "usage: %s [-t seconds] [-s slow_send_ok_ms]\n", argv [ 0 ] );
+                return 1;
+        }
+    }
+    Sim_Run ( seconds, 0xFF, 0 );
+    Sim_Run ( seconds, 2, slow_ms );
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+·ģڵУ
+
+ Driver/Link_Sup.cpp ԭʱģ(WiFi_Supervise) UDP ģʽµ ESP8266
+	ѯ AT+CIPSTATUS Լ 8msȵ㲻ʱ AT+CWJAP 5s ʱʧܣʱԼ 3s ϣ
+	ϵķʱ AT+CIPSTART Լ 1s ʧܣʱԼ 50ms 
+Ĭϳ( -o ׷)ȵ 10~25s Ͽ 40~41s ȵ 60~62s Ͽһ 120s  90s ĳʱϿ
+ӡÿζϿķʱͻָʱ䡢ռģʱ(ڼ Send_Id Ȳģ飬ңӦ)
+Լ˱(ʧ̶ܺ LINK_BACKOFF_MIN )ʱʱϿڼռģʱȽϡ
+
+УڱĿ¼£
+	g++ -O2 -I../../Driver -o Link_Sim Link_Sim.cpp ../../Driver/Link_Sup.cpp
+	./Link_Sim [-t ] [-o ȵϿʼ:]... [-v]
+*/
+
+#include "Link_Sup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+
+#define SIM_POLL_MS        8
+#define SIM_JOIN_MS        3000
+#define SIM_JOIN_FAIL_MS   5000            //ͬ ESP8266::JoinAP() ĳʱ
+#define SIM_LINK_MS        50
+#define SIM_LINK_FAIL_MS   1000
+
+
+struct Sim_Outage
+{
+    uint32_t    start;          //ms
+    uint32_t    end;
+    bool        ap;             //ȵϿֻǵϵķ
+};
+
+static std::vector<Sim_Outage> Sim_Outages;
+
+
+static bool Sim_Down(uint32_t t, bool ap)
+{
+    size_t i;
+
+    for ( i = 0; i < Sim_Outages.size(); i++ )
+    {
+        if ( ( t >= Sim_Outages [ i ] .start ) && ( t < Sim_Outages [ i ] .end ) && ( Sim_Outages [ i ] .ap || ! ap ) )
+            return true;
+    }
+    return false;
+}
+
+
+struct Sim_Result
+{
+    uint32_t    busy_ms;        //ģ鱻ռŵʱ
+    uint32_t    busy_long_ms;   //ڳʱϿڼ
+    Link_Stat   st;
+};
+
+
+static void Sim_Run(uint32_t seconds, bool fixed, bool verbose, Sim_Result *res)
+{
+    Link_Sup    sup;
+    uint32_t    now = 0, wait, cost, busy = 0, busy_long = 0, last = 0;
+    uint8_t     act;
+    bool        joined = true, tcp = true, ok, join = false, was_up = true;
+    const Sim_Outage * longest = 0;
+    size_t      i;
+
+    for ( i = 0; i < Sim_Outages.size(); i++ )
+    {
+        if ( longest == 0 || Sim_Outages [ i ] .end - Sim_Outages [ i ] .start > longest->end - longest->start )
+            longest = &Sim_Outages [ i ];
+    }
+
+    sup.start ( now, true );
+    while ( now < seconds * 1000u )
+    {
+        if ( Sim_Down ( now, true ) )                           //ȵˣģϵӸû
+            joined = false;
+        if ( Sim_Down ( now, false ) )
+            tcp = false;
+
+        act = sup.next ( now, &wait );
+        if ( fixed && ( act == LINK_ACT_NONE ) && ! sup.is_up () )       //˱ܣϴʧܺǸ LINK_BACKOFF_MIN 
+        {
+            if ( now >= last + LINK_BACKOFF_MIN )
+                act = LINK_ACT_RECONNECT;
+            else
+                wait = last + LINK_BACKOFF_MIN - now;
+        }
+        switch ( act )
+        {
+            case LINK_ACT_POLL:
+                cost = SIM_POLL_MS;
+                ok = joined && tcp;
+                join = ! joined;
+                now += cost;
+                sup.polled ( now, ok );
+                break;
+
+            case LINK_ACT_RECONNECT:
+                cost = 0;
+                ok = true;
+                if ( join )
+                {
+                    ok = ! Sim_Down ( now, true );
+                    cost += ok ? SIM_JOIN_MS : SIM_JOIN_FAIL_MS;
+                    joined = ok;
+                }
+                if ( ok )
+                {
+                    ok = ! Sim_Down ( now + cost, false );
+                    cost += ok ? SIM_LINK_MS : SIM_LINK_FAIL_MS;
+                    tcp = ok;
+                }
+                if ( ! ok )
+                    join = true;
+                now += cost;
+                last = now;
+                sup.reconnected ( now, ok );
+                break;
+
+            default:
+                now += wait;
+                continue;
+        }
+        busy += cost;
+        if ( longest && now > longest->start && now - cost < longest->end )
+            busy_long += cost;
+        if ( verbose && sup.is_up () != was_up )
+            printf ( "  %7.3f s  %s\n", now / 1000.0, sup.is_up () ? "up" : "down" );
+        was_up = sup.is_up ();
+    }
+    res->busy_ms = busy;
+    res->busy_long_ms = busy_long;
+    sup.stat ( now, &res->st );
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const Sim_Outage def [ ] = { { 10000, 25000, true }, { 40000, 41000, false }, { 60000, 62000, true }, { 120000, 210000, true } };
+    uint32_t    seconds = 240, start, len;
+    bool        verbose = false;
+    Sim_Result  back, fixed;
+    Sim_Outage  o;
+    int         opt;
+    size_t      i;
+
+    Sim_Outages.assign ( def, def + sizeof ( def ) / sizeof ( def [ 0 ] ) );
+    while ( ( opt = getopt ( argc, argv, "t:o:v" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 't': seconds = atoi ( optarg ); break;
+            case 'o':
+                if ( sscanf ( optarg, "%u:%u", &start, &len ) != 2 )
+                    return 1;
+                o.start = start * 1000u;
+                o.end = ( start + len ) * 1000u;
+                o.ap = true;
+                Sim_Outages.push_back ( o );
+                break;
+            case 'v': verbose = true; break;
+            default:
+                fprintf ( stderr, "usage: %s [-t seconds] [-o start_s:len_s]... [-v]\n", argv [ 0 ] );
+                return 1;
+        }
+    }
+
+    printf ( "outages:" );
+    for ( i = 0; i < Sim_Outages.size(); i++ )
+        printf ( " %s %u-%us", Sim_Outages [ i ] .ap ? "ap" : "server", Sim_Outages [ i ] .start / 1000, Sim_Outages [ i ] .end / 1000 );
+    printf ( "\n" );
+
+    Sim_Run ( seconds, false, verbose, &back );
+    Sim_Run ( seconds, true, false, &fixed );
+
+    printf ( "%u s: up %u s, %u downs, %u/%u reconnects, recover last %u ms max %u ms avg %u ms\n",
+             seconds, back.st.up_total / 1000, back.st.downs, back.st.reconnects, back.st.attempts,
+             back.st.recover_last, back.st.recover_max, back.st.recover_avg );
+    printf ( "module held by supervisor: backoff %u ms (%u ms in longest outage), fixed %u ms retry %u ms (%u ms in longest outage)\n",
+             back.busy_ms, back.busy_long_ms, LINK_BACKOFF_MIN, fixed.busy_ms, fixed.busy_long_ms );
+    return 0;
+}
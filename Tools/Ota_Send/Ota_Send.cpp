@@ -0,0 +1,348 @@
+/*
+OTAͶˣڵУ
+
+³(.bin 0x08004000 ʼľ)ESP8266СдW25Q64ݴ Driver/Ota.h
+ΪTCPС( Tools/Ota_Sim)Сʱ(WIFI_LINK_SERVER) -c С
+ȷ BEGIN(ȡCRC32)Сݴļ¼ظӵڼ鿪ʼ()ÿ(4K)֡һ CHUNK(CRC)
+ -w ûȷϣУĻظ next ûԽһ(У鲻м䶪֡)ʹ next ط
+CHUNK  arg 16λطִΣСڻظһѾ·ϵĿĻظٴط
+ߺСϣٷ BEGIN ûУĿȫȷϺ COMMIT-r ҪСУͨλ򿽱
+ʱӡʹ(115200 8N1 Լ 11520 B/s)֮ȡ
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Ota_Send Ota_Send.cpp ../../Driver/Remote.cpp ../../Driver/Telemetry.cpp ../../Driver/Ota.cpp
+
+÷
+	./Ota_Send -f app.bin [-p 8080] [-w ] [-r]
+	./Ota_Send -f app.bin -c 192.168.123.169 [-p 8080] ...     С
+*/
+
+#include "Remote.h"
+#include "Ota.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <vector>
+
+
+#define SND_DATA           ( TLM_BULK_MAX - TLM_OTA_DATA_HEAD )     //һֽ֡
+#define SND_LINE_BPS       11520                                   //115200 8N1
+#define SND_STATUS_MS      1000            //ôûлظͲѯһ(UDPģʽ»ظܶ)
+#define SND_STALL_MS       3000            //ôûչʹСȷϵλط
+#define SND_BEGIN_MS       5000            //ݴҪһ
+
+
+static const char *  Snd_State [ ] = { "idle", "receiving", "ready", "failed" };
+
+static int           Snd_Sock = -1;
+static uint64_t      Snd_Start;
+static std::vector<uint8_t> Snd_Img;
+static uint32_t      Snd_Crc;
+static uint16_t      Snd_Chunks;
+static uint16_t      Snd_Cursor;           //һҪĿ
+static uint16_t      Snd_Confirmed;        //Сȷϵ next
+static uint16_t      Snd_Epoch;            //ÿط1 CHUNK  arg 16λ
+static bool          Snd_HaveSt;
+static Tlm_Ota       Snd_St;
+static uint64_t      Snd_StTime, Snd_Progress;
+static uint32_t      Snd_Rewinds, Snd_DataBytes, Snd_Sessions;
+
+
+static uint64_t Snd_Now(void)
+{
+    struct timespec t;
+    clock_gettime ( CLOCK_MONOTONIC, &t );
+    return (uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000 - Snd_Start;
+}
+
+
+static uint16_t Snd_Write(const uint8_t *buf, uint16_t len)
+{
+    uint16_t done = 0;
+    int      n;
+
+    while ( done < len )
+    {
+        n = write ( Snd_Sock, buf + done, len - done );
+        if ( n <= 0 )
+            return done;
+        done += n;
+    }
+    return len;
+}
+
+static Telemetry tlm ( Snd_Write );
+
+
+static void Snd_Cmd(uint8_t op, uint32_t arg, uint32_t crc)
+{
+    Tlm_Ota_Cmd c;
+    uint8_t     b [ 9 ];
+
+    c .op = op;
+    c .arg = arg;
+    c .crc = crc;
+    tlm .send ( TLM_ID_CMD_OTA, Snd_Now () / 1000, b, Telemetry::put_ota_cmd ( b, &c ) );
+}
+
+
+static void Snd_Chunk(uint16_t idx)
+{
+    Tlm_Ota_Cmd c;
+    uint8_t     b [ TLM_BULK_MAX ];
+    uint32_t    start = (uint32_t)idx * OTA_CHUNK, end, off, n;
+
+    end = ( start + OTA_CHUNK < Snd_Img .size () ) ? start + OTA_CHUNK : Snd_Img .size ();
+    c .op = TLM_OTA_DATA;
+    for ( off = start; off < end; off += n )
+    {
+        n = ( end - off > SND_DATA ) ? SND_DATA : end - off;
+        c .arg = off;
+        Telemetry::put_ota_cmd ( b, &c );
+        memcpy ( &b [ TLM_OTA_DATA_HEAD ], &Snd_Img [ off ], n );
+        tlm .bulk ( TLM_ID_CMD_OTA, Snd_Now () / 1000, b, TLM_OTA_DATA_HEAD + n );
+        Snd_DataBytes += n;
+    }
+    Snd_Cmd ( TLM_OTA_CHUNK, idx | ( (uint32_t)Snd_Epoch << 16 ), Ota::crc32 ( 0, &Snd_Img [ start ], end - start ) );
+}
+
+
+static void Snd_Rewind(uint16_t to, const char *why)
+{
+    if ( to >= Snd_Cursor )
+        return;
+    printf ( "  rewind %u -> %u (%s)\n", Snd_Cursor, to, why );
+    Snd_Cursor = to;
+    Snd_Epoch ++;                                           //Ѿ·ϵĿĻظٴط
+    Snd_Rewinds ++;
+}
+
+
+static void Snd_Frame_In(const Rmt_Cmd *f, void *arg)     //Сֻ֡OTA״̬
+{
+    uint16_t idx;
+
+    if ( ( f->head .id != TLM_ID_OTA ) || ! Telemetry::get_ota ( f->data, f->len, &Snd_St ) )
+        return;
+    Snd_HaveSt = true;
+    Snd_StTime = Snd_Now ();
+    if ( Snd_St .state != OTA_STATE_RECEIVING )
+        return;
+    if ( Snd_St .next > Snd_Confirmed )
+    {
+        Snd_Confirmed = Snd_St .next;
+        Snd_Progress = Snd_StTime;
+    }
+    idx = Snd_St .arg & 0xFFFF;
+    if ( ( Snd_St .op == TLM_OTA_CHUNK ) && ( Snd_St .arg >> 16 == Snd_Epoch ) && ( Snd_St .next <= idx ) )
+        Snd_Rewind ( Snd_St .next, Snd_St .next < idx ? "earlier reply lost" : "chunk failed" );      //һûȫУ鲻
+}
+
+static Remote rmt ( Snd_Frame_In, 0 );
+
+
+static bool Snd_Poll(int ms)                               //Сֽڣ߷false
+{
+    struct pollfd pfd;
+    uint8_t       in [ 4096 ];
+    int           n;
+
+    pfd .fd = Snd_Sock;
+    pfd .events = POLLIN;
+    if ( poll ( &pfd, 1, ms ) <= 0 )
+        return true;
+    n = read ( Snd_Sock, in, sizeof ( in ) );
+    if ( n <= 0 )
+        return false;
+    rmt .feed ( in, n, 0 );
+    return true;
+}
+
+
+static bool Snd_Wait_State(uint8_t op, uint32_t arg, uint32_t crc, uint32_t timeout_ms, bool done)     //ָȻظdone ʱҪȵ RECEIVING
+{
+    uint64_t sent;
+    int      tries;
+
+    for ( tries = 0; tries < 3; tries ++ )
+    {
+        Snd_HaveSt = false;
+        Snd_Cmd ( op, arg, crc );
+        sent = Snd_Now ();
+        while ( Snd_Now () - sent < timeout_ms * 1000ull )
+        {
+            if ( ! Snd_Poll ( 10 ) )
+                return false;
+            if ( Snd_HaveSt && ( Snd_St .op == op ) && ! ( done && Snd_St .state == OTA_STATE_RECEIVING ) )
+                return true;
+        }
+    }
+    return false;
+}
+
+
+static int Snd_Session(bool reset, uint16_t window)        //һӣ0ɣ1Ҫ2ʧ
+{
+    uint64_t t0, t1;
+    uint32_t bytes0 = Snd_DataBytes, n;
+
+    Snd_Sessions ++;
+    if ( ! Snd_Wait_State ( TLM_OTA_BEGIN, Snd_Img .size (), Snd_Crc, SND_BEGIN_MS, false ) )
+        return 1;
+    if ( Snd_St .state == OTA_STATE_READY )
+    {
+        printf ( "car already has this image staged\n" );
+        Snd_Confirmed = Snd_Cursor = Snd_Chunks;
+    }
+    else if ( Snd_St .state != OTA_STATE_RECEIVING )
+    {
+        printf ( "begin refused: state %s\n", Snd_State [ Snd_St .state & 3 ] );
+        return 2;
+    }
+    else
+    {
+        Snd_Confirmed = Snd_Cursor = Snd_St .next;
+        printf ( "begin: %u chunks, resume from %u\n", Snd_St .chunks, Snd_St .next );
+    }
+    Snd_Epoch ++;
+
+    t0 = Snd_Progress = Snd_StTime = Snd_Now ();
+    while ( Snd_Confirmed < Snd_Chunks )
+    {
+        if ( ( Snd_Cursor < Snd_Chunks ) && ( Snd_Cursor < Snd_Confirmed + window ) )
+        {
+            Snd_Chunk ( Snd_Cursor ++ );
+            continue;
+        }
+        if ( ! Snd_Poll ( 10 ) )
+            return 1;
+        if ( Snd_Now () - Snd_Progress > SND_STALL_MS * 1000ull )
+        {
+            Snd_Progress = Snd_Now ();
+            Snd_Rewind ( Snd_Confirmed, "stalled" );
+        }
+        else if ( Snd_Now () - Snd_StTime > SND_STATUS_MS * 1000ull )
+        {
+            Snd_StTime = Snd_Now ();
+            Snd_Cmd ( TLM_OTA_STATUS, 0, 0 );
+        }
+    }
+    t1 = Snd_Now ();
+    n = Snd_DataBytes - bytes0;
+    if ( n && t1 > t0 )
+        printf ( "transfer: %u bytes sent in %.2f s, %.0f B/s = %.0f%% of line rate\n", n,
+                 ( t1 - t0 ) / 1e6, n * 1e6 / ( t1 - t0 ), n * 1e8 / ( t1 - t0 ) / SND_LINE_BPS );
+
+    if ( ! Snd_Wait_State ( TLM_OTA_COMMIT, reset, 0, SND_BEGIN_MS, true ) )
+        return 1;
+    printf ( "commit: %s, %u chunk errors, %u gaps\n", Snd_State [ Snd_St .state & 3 ], Snd_St .errors, Snd_St .gaps );
+    return ( Snd_St .state == OTA_STATE_READY ) ? 0 : 2;
+}
+
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_in addr;
+    int                port = 8080, window = 2, opt, s = -1, on = 1, res;
+    bool               reset = false;
+    const char *       car = 0, * file = 0;
+    FILE *             f;
+    long               size;
+    uint64_t           t0;
+
+    while ( ( opt = getopt ( argc, argv, "f:c:p:w:r" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'f': file = optarg; break;
+            case 'c': car = optarg; break;
+            case 'p': port = atoi ( optarg ); break;
+            case 'w': window = atoi ( optarg ); break;
+            case 'r': reset = true; break;
+            default:
+                file = 0;
+                break;
+        }
+    }
+    if ( ! file || window < 1 )
+    {
+        fprintf ( stderr, "usage: %s -f image.bin [-c car_ip] [-p port] [-w window_chunks] [-r]\n", argv [ 0 ] );
+        return 1;
+    }
+    f = fopen ( file, "rb" );
+    if ( ! f )
+    {
+        perror ( file );
+        return 1;
+    }
+    fseek ( f, 0, SEEK_END );
+    size = ftell ( f );
+    fseek ( f, 0, SEEK_SET );
+    if ( size <= 0 || size > OTA_IMG_MAX )
+    {
+        fprintf ( stderr, "image size %ld out of range (max %u)\n", size, OTA_IMG_MAX );
+        return 1;
+    }
+    Snd_Img .resize ( size );
+    if ( fread ( Snd_Img .data (), 1, size, f ) != (size_t)size )
+        return 1;
+    fclose ( f );
+    Snd_Crc = Ota::crc32 ( 0, Snd_Img .data (), size );
+    Snd_Chunks = ( size + OTA_CHUNK - 1 ) / OTA_CHUNK;
+    printf ( "%s: %ld bytes, %u chunks, crc32 %08X\n", file, size, Snd_Chunks, Snd_Crc );
+
+    Snd_Start = 0;
+    Snd_Start = Snd_Now ();
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr .sin_family = AF_INET;
+    addr .sin_port = htons ( port );
+    if ( ! car )
+    {
+        s = socket ( AF_INET, SOCK_STREAM, 0 );
+        setsockopt ( s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof ( on ) );
+        addr .sin_addr .s_addr = htonl ( INADDR_ANY );
+        if ( bind ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 || listen ( s, 1 ) < 0 )
+        {
+            perror ( "listen" );
+            return 1;
+        }
+    }
+    else
+        inet_pton ( AF_INET, car, &addr .sin_addr );
+
+    t0 = Snd_Now ();
+    do
+    {
+        if ( car )                                          //СǷ
+        {
+            Snd_Sock = socket ( AF_INET, SOCK_STREAM, 0 );
+            while ( connect ( Snd_Sock, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 )
+                sleep ( 1 );
+        }
+        else
+        {
+            fprintf ( stderr, "waiting on port %d\n", port );
+            Snd_Sock = accept ( s, 0, 0 );
+        }
+        setsockopt ( Snd_Sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+        rmt .reset ();
+        res = Snd_Session ( reset, window );
+        close ( Snd_Sock );
+        if ( res == 1 )
+            printf ( "car disconnected at chunk %u, waiting to resume\n", Snd_Confirmed );
+    }
+    while ( res == 1 );
+
+    printf ( "%s after %.2f s, %u session(s), %u rewinds, %u data bytes for %ld image bytes\n",
+             res ? "FAILED" : "done", ( Snd_Now () - t0 ) / 1e6, Snd_Sessions, Snd_Rewinds, Snd_DataBytes, size );
+    if ( s >= 0 )
+        close ( s );
+    return res;
+}
@@ -0,0 +1,331 @@
+/*
+OTAģ⣨ڵУСESP8266
+
+ Tools/Ota_Sendյֽڰ115200(ÿֽԼ87usESP8266ÿTCPټ +IPD ͷ)
+Driver/Remote.cpp ֡ User/config.cpp һOTA֡Ž OTA_RING_SIZE ֽڵĻλ
+""ȡ Driver/Ota.cppW25Q64ڴģ(ֻܰ1д0)дֲĵʱռס
+ڼֽ˶֡״̬֡ء
+-e  һһдʱһλ(ԿУʧܺط)-k ֽ յôֽںϿ1()
+-l ֱ Ĵյֽ(֡CRCԶ֡ط)
+COMMIT ģ򣺼ݴǲУCRC32ӡ
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Ota_Sim Ota_Sim.cpp ../../Driver/Remote.cpp ../../Driver/Telemetry.cpp ../../Driver/Ota.cpp
+
+÷
+	./Ota_Sim [-a 127.0.0.1] [-p 8080] [-e ]... [-k ֽ] [-l ֱ]
+*/
+
+#include "Remote.h"
+#include "Ota.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <deque>
+#include <set>
+#include <vector>
+
+
+#define SIM_BYTE_US        ( 1e7 / 115200 )     //8N1һֽ
+#define SIM_IPD_BYTES      12                   //"+IPD,0,1460:"
+#define SIM_SEGMENT        1460
+#define SIM_RING_SIZE      4096                 //ͬ config.h  OTA_RING_SIZE
+#define SIM_FLASH_SIZE     0x800000
+#define SIM_SPI_US         0.45                 //SPI 18MHz һֽ
+#define SIM_PAGE_US        700                  //W25Q64 ʱ
+#define SIM_SECTOR_US      45000
+#define SIM_BLOCK_US       150000
+
+#define SIM_REPLY          0x01                 //Sim_Task() ķֵæ״̬
+#define SIM_BOOT           0x02                 //  ģ
+#define SIM_RESET          0x04                 //  Ȼλ
+
+
+static std::vector<uint8_t>  Sim_Flash ( SIM_FLASH_SIZE, 0xFF );
+static double                Sim_Cost;          //βռסʱ(us)
+static std::set<uint32_t>    Sim_Corrupt;       //һдʱһλĿ
+
+static std::deque<std::vector<uint8_t> > Sim_Ring;
+static uint32_t              Sim_RingBytes, Sim_RingMax, Sim_RingDrops;
+
+static Tlm_Ota_Cmd           Sim_Cmd;           //ڴָæظ
+static int                   Sim_Sock = -1;
+static uint64_t              Sim_Start;
+
+
+static uint64_t Sim_Now(void)
+{
+    struct timespec t;
+    clock_gettime ( CLOCK_MONOTONIC, &t );
+    return (uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000 - Sim_Start;
+}
+
+
+static void Sim_Erase(uint32_t addr, uint32_t len)        //ͬ config.cpp  Ota_Erase()
+{
+    uint32_t end = addr + len;
+
+    while ( addr < end )
+    {
+        if ( ( ( addr & 0xFFFF ) == 0 ) && ( end - addr >= 0x10000 ) )
+        {
+            memset ( &Sim_Flash [ addr ], 0xFF, 0x10000 );
+            Sim_Cost += SIM_BLOCK_US;
+            addr += 0x10000;
+        }
+        else
+        {
+            memset ( &Sim_Flash [ addr & ~( OTA_CHUNK - 1 ) ], 0xFF, OTA_CHUNK );
+            Sim_Cost += SIM_SECTOR_US;
+            addr += OTA_CHUNK;
+        }
+    }
+}
+
+static void Sim_Write(uint32_t addr, const uint8_t *buf, uint16_t len)
+{
+    uint32_t chunk = ( addr - OTA_IMG_ADDR ) / OTA_CHUNK;
+    uint16_t i;
+
+    for ( i = 0; i < len; i++ )
+        Sim_Flash [ addr + i ] &= buf [ i ];
+    if ( ( addr >= OTA_IMG_ADDR ) && ( addr < OTA_IMG_ADDR + OTA_IMG_MAX ) && Sim_Corrupt .erase ( chunk ) )
+    {
+        Sim_Flash [ addr ] ^= 0x01;
+        printf ( "  car: chunk %u written with a flipped bit\n", chunk );
+    }
+    Sim_Cost += ( ( addr + len - 1 ) / 256 - addr / 256 + 1 ) * SIM_PAGE_US + len * SIM_SPI_US;
+}
+
+static void Sim_Read(uint32_t addr, uint8_t *buf, uint16_t len)
+{
+    memcpy ( buf, &Sim_Flash [ addr ], len );
+    Sim_Cost += ( len + 4 ) * SIM_SPI_US;
+}
+
+static const Ota_Flash sim_flash = { Sim_Erase, Sim_Write, Sim_Read };
+static Ota ota ( &sim_flash );
+
+
+static uint16_t Sim_Send(const uint8_t *buf, uint16_t len)
+{
+    int n = write ( Sim_Sock, buf, len );
+    return ( n == len ) ? len : 0;
+}
+
+static Telemetry tlm ( Sim_Send );
+
+
+static void Sim_Put(const uint8_t *p, uint8_t len)        //ͬ config.cpp  Ota_Put()"ж"
+{
+    if ( len < TLM_OTA_DATA_HEAD )
+        return;
+    if ( SIM_RING_SIZE - Sim_RingBytes < len + 1u )
+    {
+        Sim_RingDrops ++;
+        return;
+    }
+    Sim_Ring .push_back ( std::vector<uint8_t> ( p, p + len ) );
+    Sim_RingBytes += len + 1;
+    if ( Sim_RingBytes > Sim_RingMax )
+        Sim_RingMax = Sim_RingBytes;
+}
+
+static void Sim_OnCmd(const Rmt_Cmd *cmd, void *arg)
+{
+    if ( cmd->head .id == TLM_ID_CMD_OTA )
+        Sim_Put ( cmd->data, cmd->len );
+}
+
+static void Sim_Bulk(const Tlm_Head *head, const uint8_t *p, uint8_t len, bool dup, void *arg)
+{
+    if ( ( head->id == TLM_ID_CMD_OTA ) && ! dup )
+        Sim_Put ( p, len );
+}
+
+static Remote rmt ( Sim_OnCmd, 0 );
+
+
+static void Sim_Boot(void)                                  //ͬ Boot/Boot.c ļ飬Ŀ
+{
+    uint32_t size, crc;
+
+    memcpy ( &size, &Sim_Flash [ OTA_HDR_ADDR + 4 ], 4 );
+    memcpy ( &crc, &Sim_Flash [ OTA_HDR_ADDR + 8 ], 4 );
+    printf ( "boot: magic %s, ready %02X, done %02X, %u bytes, staged crc32 %08X, header crc32 %08X -> %s\n",
+             ( *(uint32_t *)&Sim_Flash [ OTA_HDR_ADDR ] == OTA_MAGIC ) ? "ok" : "bad",
+             Sim_Flash [ OTA_HDR_ADDR + OTA_HDR_READY ], Sim_Flash [ OTA_HDR_ADDR + OTA_HDR_DONE ], size,
+             Ota::crc32 ( 0, &Sim_Flash [ OTA_IMG_ADDR ], size ), crc,
+             ( Sim_Flash [ OTA_HDR_ADDR + OTA_HDR_READY ] == 0x00 && Ota::crc32 ( 0, &Sim_Flash [ OTA_IMG_ADDR ], size ) == crc )
+             ? "would copy" : "would skip" );
+}
+
+
+static uint8_t Sim_Task(void)                               //ͬ config.cpp  Ota_Run()һҪæ
+{
+    std::vector<uint8_t> b = Sim_Ring .front ();
+    Tlm_Ota_Cmd & c = Sim_Cmd;
+    uint8_t     todo = SIM_REPLY;
+
+    Sim_Ring .pop_front ();
+    Sim_RingBytes -= b .size () + 1;
+    if ( ! Telemetry::get_ota_cmd ( b .data (), b .size (), &c ) )
+        return 0;
+    switch ( c .op )
+    {
+        case TLM_OTA_BEGIN:
+            ota .begin ( c .arg, c .crc );
+            break;
+        case TLM_OTA_DATA:
+            ota .data ( c .arg, &b [ TLM_OTA_DATA_HEAD ], b .size () - TLM_OTA_DATA_HEAD );
+            todo = 0;
+            break;
+        case TLM_OTA_CHUNK:
+            ota .chunk ( (uint16_t)c .arg, c .crc );
+            break;
+        case TLM_OTA_COMMIT:
+            todo |= SIM_BOOT;
+            if ( ota .commit () && c .arg )
+                todo |= SIM_RESET;
+            break;
+        case TLM_OTA_ABORT:
+            ota .abort ();
+            break;
+    }
+    return todo;
+}
+
+
+static int Sim_Connect(const char *host, int port)
+{
+    struct sockaddr_in addr;
+    int                s, on = 1;
+
+    s = socket ( AF_INET, SOCK_STREAM, 0 );
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr .sin_family = AF_INET;
+    addr .sin_port = htons ( port );
+    inet_pton ( AF_INET, host, &addr .sin_addr );
+    while ( connect ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 )
+    {
+        close ( s );
+        usleep ( 200000 );
+        s = socket ( AF_INET, SOCK_STREAM, 0 );
+    }
+    setsockopt ( s, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+    return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *       host = "127.0.0.1";
+    int                port = 8080, opt, n, i, loss = 0;
+    long               kill_at = -1;
+    uint8_t            in [ SIM_SEGMENT ];
+    std::deque<std::pair<uint8_t, double> > rx;             //ѵESP8266ûӴڳֽںͳʱ(us)
+    double             rx_end = 0, t;                       //һֽڳڵʱ
+    uint64_t           now, busy = 0, task_us = 0;
+    uint32_t           total = 0;
+    uint8_t            todo = 0;
+    struct pollfd      pfd;
+    Tlm_Ota            st;
+
+    while ( ( opt = getopt ( argc, argv, "a:p:e:k:l:" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'a': host = optarg; break;
+            case 'p': port = atoi ( optarg ); break;
+            case 'e': Sim_Corrupt .insert ( atoi ( optarg ) ); break;
+            case 'k': kill_at = atol ( optarg ); break;
+            case 'l': loss = atoi ( optarg ); break;
+            default:
+                fprintf ( stderr, "usage: %s [-a host] [-p port] [-e chunk]... [-k bytes] [-l ppm]\n", argv [ 0 ] );
+                return 1;
+        }
+    }
+    Sim_Start = 0;
+    Sim_Start = Sim_Now ();
+    srand ( 1 );
+    rmt .set_bulk ( Sim_Bulk );
+    Sim_Sock = Sim_Connect ( host, port );
+
+    while ( 1 )
+    {
+        now = Sim_Now ();
+        pfd .fd = Sim_Sock;
+        pfd .events = POLLIN;
+        if ( poll ( &pfd, 1, ( rx .empty () && Sim_Ring .empty () ) ? 100 : 0 ) > 0 )
+        {
+            n = read ( Sim_Sock, in, sizeof ( in ) );
+            if ( n <= 0 )
+                break;
+            t = ( ( rx_end > now ) ? rx_end : now ) + SIM_IPD_BYTES * SIM_BYTE_US;     //+IPD ͷҲռʱ
+            for ( i = 0; i < n; i++ )
+            {
+                t += SIM_BYTE_US;
+                rx .push_back ( std::make_pair ( ( loss && rand () % 1000000 < loss ) ? in [ i ] ^ 0x55 : in [ i ], t ) );
+            }
+            rx_end = t;
+        }
+
+        while ( ! rx .empty () && rx .front () .second <= now )          //USART3 ж
+        {
+            rmt .feed ( &rx .front () .first, 1, 0 );
+            rx .pop_front ();
+            total ++;
+        }
+
+        if ( kill_at >= 0 && total >= (uint32_t)kill_at )           //ߣESP8266ûֽû
+        {
+            printf ( "  car: link dropped after %u bytes\n", total );
+            close ( Sim_Sock );
+            rx .clear ();
+            kill_at = -1;
+            sleep ( 1 );
+            rmt .reset ();
+            Sim_Sock = Sim_Connect ( host, port );
+            continue;
+        }
+
+        if ( now >= busy && todo )                                  //дŻ״̬
+        {
+            ota .status ( &st );
+            st .op = Sim_Cmd .op;
+            st .arg = Sim_Cmd .arg;
+            tlm .ota ( now / 1000, &st );
+            if ( todo & SIM_BOOT )
+                Sim_Boot ();
+            if ( todo & SIM_RESET )
+            {
+                printf ( "car: reset requested\n" );
+                break;
+            }
+            todo = 0;
+        }
+        if ( now >= busy && ! Sim_Ring .empty () )                 //
+        {
+            Sim_Cost = 0;
+            todo = Sim_Task ();
+            busy = now + (uint64_t)Sim_Cost;
+            task_us += (uint64_t)Sim_Cost;
+        }
+        else if ( busy > now + 1000 )
+            usleep ( 200 );
+    }
+
+    ota .status ( &st );
+    printf ( "car: %u bytes in, %u frames (%u bad, %u lost), ring max %u/%u bytes, %u ring drops, ota %u chunk errors %u gaps, flash busy %.2f s\n",
+             total, rmt .rx_frames (), rmt .bad_frames (), rmt .lost_frames (), Sim_RingMax, SIM_RING_SIZE, Sim_RingDrops,
+             st .errors, st .gaps, task_us / 1e6 );
+    close ( Sim_Sock );
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*
+PIDԱȹߣڵУ
+
+Driver/PID.cpp Q16PIDͬ㷨ĸ汾ԭ PID.c ĸʽ
+1. Աջһģ(һ׹ԣռձȽmm/sֵ̼Ƶķֱȡ)ӡԾӦߵƫ
+2. طͬһĿ/У rdtsc ÿ update ʱڣ汾ÿεĸӼˡȽϴ
+FPUͶࣻF103ÿӡˡȽ϶ǼʮڵĿ⺯ã
+汾ֻм SMULL/ӷϵʵڿ CPU_TS_TmrRd() ͬѭǰʱ
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Pid_Bench Pid_Bench.cpp ../../Driver/PID.cpp
+
+÷
+	./Pid_Bench [-i ʽ] [-n طŴ] [-v ӡÿһ]
+*/
+
+#include "PID.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <x86intrin.h>
+
+
+#define SIM_HZ              100             //ͬ config.h  ODOM_HZ
+#define SIM_STEPS           600
+#define SIM_GAIN            1.2f            //ռձ1000ʱ̬1200mm/s
+#define SIM_TAU             0.08f           //ʱ䳣(s)
+#define SIM_RES             12.083f         //̼һһӦٶ(mm/s)
+#define SIM_KP              0.4
+#define SIM_KI              0.08
+#define SIM_KD              0.05
+#define SIM_OUT_MAX         1000
+
+
+struct Sim_Ops                              //F103ÿһζһ⺯
+{
+    uint32_t add, mul, cmp;
+};
+static Sim_Ops Ops;
+
+struct Cnt_Float                            // floatÿһ
+{
+    float v;
+    Cnt_Float(float v = 0) : v ( v ) {}
+    Cnt_Float operator + (Cnt_Float b) const { Ops.add ++; return v + b.v; }
+    Cnt_Float operator - (Cnt_Float b) const { Ops.add ++; return v - b.v; }
+    Cnt_Float operator * (Cnt_Float b) const { Ops.mul ++; return v * b.v; }
+    Cnt_Float & operator += (Cnt_Float b) { Ops.add ++; v += b.v; return *this; }
+    bool operator > (Cnt_Float b) const { Ops.cmp ++; return v > b.v; }
+    bool operator < (Cnt_Float b) const { Ops.cmp ++; return v < b.v; }
+};
+
+
+template <typename T> class Pid_Float       // PID.cpp һ㷨ø
+{
+    public:
+    Pid_Float(T kp, T ki, T kd, T lo, T hi, uint8_t mode)
+    {
+        this->kp=kp;
+        this->ki=ki;
+        this->kd=kd;
+        this->lo=lo;
+        this->hi=hi;
+        this->mode=mode;
+        integ=0;
+        last_err=0;
+        last_meas=0;
+        prev_meas=0;
+    }
+    __attribute__((noinline)) T update(T goal, T meas, T ff)
+    {
+        T e = goal - meas, u, cand;
+
+        if ( mode == PID_MODE_INC )
+        {
+            integ += kp * ( e - last_err ) + ki * e - kd * ( meas - T ( 2 ) * last_meas + prev_meas );
+            u = integ + ff;
+            if ( u > hi )
+            {
+                integ = hi - ff;
+                u = hi;
+            }
+            else if ( u < lo )
+            {
+                integ = lo - ff;
+                u = lo;
+            }
+            last_err = e;
+        }
+        else
+        {
+            u = kp * e - kd * ( meas - last_meas ) + ff;
+            cand = integ + ki * e;
+            if ( cand > hi )
+                cand = hi;
+            else if ( cand < lo )
+                cand = lo;
+            if ( ( ( u + cand > hi ) && ( e > T ( 0 ) ) ) || ( ( u + cand < lo ) && ( e < T ( 0 ) ) ) )
+                cand = integ;
+            integ = cand;
+            u += integ;
+            if ( u > hi )
+                u = hi;
+            else if ( u < lo )
+                u = lo;
+        }
+        prev_meas = last_meas;
+        last_meas = meas;
+        return u;
+    }
+
+    private:
+    T       kp, ki, kd, lo, hi, integ, last_err, last_meas, prev_meas;
+    uint8_t mode;
+};
+
+
+struct Pid_Old                              //ԭ PID.cʽû޷زֵӱ仯
+{
+    float goal_point, last_Error, pre_Error, Kp, Ki, Kd;
+};
+
+__attribute__((noinline)) static float Pid_Old_Out(Pid_Old *pid, float goal_point, float read_point)
+{
+    float this_Error, FeedBack;
+
+    pid->goal_point = goal_point;
+    this_Error = pid->goal_point - read_point;
+    FeedBack = ( pid->Kp + pid->Ki + pid->Kd ) * this_Error - ( pid->Kp + 2 * pid->Kd ) * pid->last_Error + pid->Kd * pid->pre_Error;
+    pid->pre_Error = pid->last_Error;
+    pid->last_Error = this_Error;
+    return read_point + FeedBack;
+}
+
+
+static int32_t Sim_Goal(int n)              //Ծ0  600  -400  300  0 mm/s
+{
+    static const int32_t g [ ] = { 0, 600, -400, 300, 0, 0 };
+    return g [ n * 5 / SIM_STEPS ];
+}
+
+
+static int32_t Sim_Meas(float v)
+{
+    return (int32_t)lrintf ( v / SIM_RES ) * (int32_t)lrintf ( SIM_RES * 1000 ) / 1000;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint8_t     mode = PID_MODE_POS;
+    int         reps = 20000, opt, i, r;
+    bool        verbose = false;
+    float       vq = 0, vf = 0, uf, d, dmax = 0, umax = 0;
+    int32_t     uq, goal [ SIM_STEPS ], meas [ SIM_STEPS ];
+    uint64_t    t0, cq, cf, co;
+    volatile int32_t  sink_q = 0;
+    volatile float    sink_f = 0;
+
+    for ( opt = 1; opt < argc; opt++ )
+    {
+        if ( ! strcmp ( argv [ opt ], "-i" ) )
+            mode = PID_MODE_INC;
+        else if ( ! strcmp ( argv [ opt ], "-n" ) && opt + 1 < argc )
+            reps = atoi ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-v" ) )
+            verbose = true;
+        else
+        {
+            fprintf ( stderr, "usage: %s [-i] [-n reps] [-v]\n", argv [ 0 ] );
+            return 1;
+        }
+    }
+
+    PID         q ( PID_K ( SIM_KP ), PID_K ( SIM_KI ), PID_K ( SIM_KD ), -SIM_OUT_MAX, SIM_OUT_MAX, mode );
+    Pid_Float<float>     f ( SIM_KP, SIM_KI, SIM_KD, -SIM_OUT_MAX, SIM_OUT_MAX, mode );
+    Pid_Old     old = { 0, 0, 0, (float)SIM_KP, (float)SIM_KI, (float)SIM_KD };
+
+    for ( i = 0; i < SIM_STEPS; i++ )       //һģͱջǰΪ̬Ҫռձ
+    {
+        goal [ i ] = Sim_Goal ( i );
+        meas [ i ] = Sim_Meas ( vf );
+        uq = q.update ( goal [ i ], Sim_Meas ( vq ), (int32_t)( goal [ i ] / SIM_GAIN ) );
+        uf = f.update ( goal [ i ], meas [ i ], goal [ i ] / SIM_GAIN );
+        vq += ( SIM_GAIN * uq - vq ) / ( SIM_TAU * SIM_HZ );
+        vf += ( SIM_GAIN * uf - vf ) / ( SIM_TAU * SIM_HZ );
+        d = fabsf ( vq - vf );
+        if ( d > dmax )
+            dmax = d;
+        if ( verbose )
+            printf ( "%d,%d,%.1f,%.1f,%d,%.1f\n", i * 1000 / SIM_HZ, goal [ i ], vq, vf, uq, uf );
+    }
+    printf ( "%s, kp %.3f ki %.3f kd %.3f: closed loop max speed difference %.2f mm/s (resolution %.2f)\n",
+             mode == PID_MODE_INC ? "incremental" : "positional", SIM_KP, SIM_KI, SIM_KD, dmax, SIM_RES );
+
+    q.reset ( 0, 0 );
+    f = Pid_Float<float> ( SIM_KP, SIM_KI, SIM_KD, -SIM_OUT_MAX, SIM_OUT_MAX, mode );
+    for ( i = 0; i < SIM_STEPS; i++ )       //ͬһпطţȽ
+    {
+        d = fabsf ( q.update ( goal [ i ], meas [ i ], (int32_t)( goal [ i ] / SIM_GAIN ) )
+                  - f.update ( goal [ i ], meas [ i ], goal [ i ] / SIM_GAIN ) );
+        if ( d > umax )
+            umax = d;
+    }
+    printf ( "replay max output difference %.2f duty (Q16 output is rounded to 1)\n", umax );
+
+    t0 = __rdtsc ();
+    for ( r = 0; r < reps; r++ )
+        for ( i = 0; i < SIM_STEPS; i++ )
+            sink_q = q.update ( goal [ i ], meas [ i ], goal [ i ] );
+    cq = __rdtsc () - t0;
+
+    t0 = __rdtsc ();
+    for ( r = 0; r < reps; r++ )
+        for ( i = 0; i < SIM_STEPS; i++ )
+            sink_f = f.update ( (float)goal [ i ], (float)meas [ i ], (float)goal [ i ] );
+    cf = __rdtsc () - t0;
+
+    t0 = __rdtsc ();
+    for ( r = 0; r < reps; r++ )
+        for ( i = 0; i < SIM_STEPS; i++ )
+            sink_f = Pid_Old_Out ( &old, (float)goal [ i ], (float)meas [ i ] );
+    co = __rdtsc () - t0;
+
+    printf ( "cycles per update (host TSC): Q16 %.2f, float %.2f, old PID.c %.2f\n",
+             (double)cq / reps / SIM_STEPS, (double)cf / reps / SIM_STEPS, (double)co / reps / SIM_STEPS );
+
+    Pid_Float<Cnt_Float> c ( SIM_KP, SIM_KI, SIM_KD, -SIM_OUT_MAX, SIM_OUT_MAX, mode );
+    memset ( &Ops, 0, sizeof ( Ops ) );
+    for ( i = 0; i < SIM_STEPS; i++ )
+        c.update ( Cnt_Float ( goal [ i ] ), Cnt_Float ( meas [ i ] ), Cnt_Float ( goal [ i ] ) );
+    printf ( "float ops per update (each a software call on F103, plus 3 int->float and 1 float->int): add/sub %.1f, mul %.1f, compare %.1f\n",
+             (double)Ops.add / SIM_STEPS, (double)Ops.mul / SIM_STEPS, (double)Ops.cmp / SIM_STEPS );
+    (void)sink_q;
+    (void)sink_f;
+    return 0;
+}
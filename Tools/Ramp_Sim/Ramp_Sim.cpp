@@ -0,0 +1,168 @@
+/*
+ٶбģ⣨ڵУ
+
+ User_main.c  Run (ǰˡƽơͣ)ÿ Driver/Mecanum.cpp ĸӵĿ꣬
+һÿ 1/CTRL_HZ  Driver/Ramp.cpp һÿĸӵռձ(CSV)
+׼ϴӡÿһռձȱ仯ͼٶȱ仯-a 0 ǰֱдȽֵӡ
+-g  gnuplot űֱӻͼ
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Ramp_Sim Ramp_Sim.cpp ../../Driver/Ramp.cpp ../../Driver/Mecanum.cpp
+
+÷
+	./Ramp_Sim [-a ٶ/s] [-j Ӽٶ/s/s] [-s ٶ] [-g] [:ms ...] > ramp.csv
+	./Ramp_Sim -g | gnuplot -p
+up back left right stop ul ur bl brĬ up:600 back:600 right:400 ul:400 stop:500
+*/
+
+#include "Ramp.h"
+#include "Mecanum.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define SIM_HZ              1000            //ͬ config.h  CTRL_HZ
+#define SIM_DUTY_MAX        1000            //MOVE_DUTY_MAX
+#define SIM_DIAG_SCALE      181             //MOVE_DIAG_SCALE
+#define SIM_STEP_MAX        32
+#define SIM_LOG_MAX         60000           //-g ʱ໭ٸ
+
+
+struct Sim_Dir
+{
+    const char *    name;
+    int8_t          dx;
+    int8_t          dy;
+};
+
+static const Sim_Dir Sim_Dirs [ ] =
+{
+    { "up", 0, 1 }, { "back", 0, -1 }, { "left", -1, 0 }, { "right", 1, 0 }, { "stop", 0, 0 },
+    { "ul", -1, 1 }, { "ur", 1, 1 }, { "bl", -1, -1 }, { "br", 1, -1 },
+};
+
+struct Sim_Step
+{
+    const Sim_Dir * dir;
+    uint32_t        ms;
+};
+
+static int16_t Sim_Log [ MEC_WHEEL_NUM ] [ SIM_LOG_MAX ];      //gnuplot Ҫһһߵظ
+
+
+static const Sim_Dir * Sim_Find(const char *name)
+{
+    uint8_t i;
+
+    for ( i = 0; i < sizeof ( Sim_Dirs ) / sizeof ( Sim_Dirs [ 0 ] ); i++ )
+        if ( ! strcmp ( Sim_Dirs [ i ] .name, name ) )
+            return &Sim_Dirs [ i ];
+    return 0;
+}
+
+
+static bool Sim_Parse(const char *arg, Sim_Step *step)
+{
+    char name [ 16 ];
+    const char *c = strchr ( arg, ':' );
+
+    if ( ! c || ( c - arg ) >= (int)sizeof ( name ) )
+        return false;
+    memcpy ( name, arg, c - arg );
+    name [ c - arg ] = 0;
+    step->dir = Sim_Find ( name );
+    step->ms = atoi ( c + 1 );
+    return step->dir && step->ms;
+}
+
+
+int main(int argc, char **argv)
+{
+    static const char * Sim_Default [ ] = { "up:600", "back:600", "right:400", "ul:400", "stop:500" };
+    Sim_Step    steps [ SIM_STEP_MAX ];
+    uint8_t     n = 0, i, k;
+    uint32_t    acc = 4000, jerk = 80000, t = 0, ms, total;
+    int16_t     speed = 200, v, d [ MEC_WHEEL_NUM ], prev [ MEC_WHEEL_NUM ] = { 0 };
+    int32_t     dv, da, dv_prev [ MEC_WHEEL_NUM ] = { 0 }, dv_max [ MEC_WHEEL_NUM ] = { 0 }, da_max [ MEC_WHEEL_NUM ] = { 0 };
+    bool        plot = false;
+    int         opt;
+    Mecanum     mec ( SIM_DUTY_MAX );
+    Ramp        ramp [ MEC_WHEEL_NUM ] = { Ramp ( SIM_HZ ), Ramp ( SIM_HZ ), Ramp ( SIM_HZ ), Ramp ( SIM_HZ ) };
+
+    for ( opt = 1; opt < argc; opt++ )
+    {
+        if ( ! strcmp ( argv [ opt ], "-a" ) && opt + 1 < argc )
+            acc = atoi ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-j" ) && opt + 1 < argc )
+            jerk = atoi ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-s" ) && opt + 1 < argc )
+            speed = atoi ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-g" ) )
+            plot = true;
+        else if ( n < SIM_STEP_MAX && Sim_Parse ( argv [ opt ], &steps [ n ] ) )
+            n++;
+        else
+        {
+            fprintf ( stderr, "usage: %s [-a acc] [-j jerk] [-s speed] [-g] [dir:ms ...]\n", argv [ 0 ] );
+            return 1;
+        }
+    }
+    if ( n == 0 )
+        for ( n = 0; n < sizeof ( Sim_Default ) / sizeof ( Sim_Default [ 0 ] ); n++ )
+            Sim_Parse ( Sim_Default [ n ], &steps [ n ] );
+
+    for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+        ramp [ k ] .limits ( acc, jerk );
+
+    if ( plot )
+    {
+        printf ( "set datafile separator ','\nset key outside\nset xlabel 'ms'\nset ylabel 'duty'\nset grid\n" );
+        printf ( "set title 'acc %u/s  jerk %u/s^2'\n", acc, jerk );
+        printf ( "plot '-' u 1:2 w l t 'FL', '' u 1:2 w l t 'FR', '' u 1:2 w l t 'RL', '' u 1:2 w l t 'RR'\n" );
+    }
+    else
+        printf ( "ms,fl,fr,rl,rr\n" );
+
+    for ( i = 0; i < n; i++ )
+    {
+        v = ( steps [ i ] .dir->dx && steps [ i ] .dir->dy ) ? speed * SIM_DIAG_SCALE / 256 : speed;
+        mec.solve ( steps [ i ] .dir->dx * v, steps [ i ] .dir->dy * v, 0, d );      //ͬ Move_Vel()
+        for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+            ramp [ k ] .target ( d [ k ] );
+
+        for ( ms = 0; ms < steps [ i ] .ms * SIM_HZ / 1000; ms++, t++ )             //
+        {
+            for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+            {
+                d [ k ] = ramp [ k ] .tick ();
+                dv = d [ k ] - prev [ k ];
+                da = dv - dv_prev [ k ];
+                if ( abs ( dv ) > dv_max [ k ] )
+                    dv_max [ k ] = abs ( dv );
+                if ( abs ( da ) > da_max [ k ] )
+                    da_max [ k ] = abs ( da );
+                dv_prev [ k ] = dv;
+                prev [ k ] = d [ k ];
+                if ( t < SIM_LOG_MAX )
+                    Sim_Log [ k ] [ t ] = d [ k ];
+            }
+            if ( ! plot )
+                printf ( "%u,%d,%d,%d,%d\n", t * 1000 / SIM_HZ, d [ 0 ], d [ 1 ], d [ 2 ], d [ 3 ] );
+        }
+    }
+    total = ( t < SIM_LOG_MAX ) ? t : SIM_LOG_MAX;
+
+    if ( plot )
+        for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+        {
+            for ( t = 0; t < total; t++ )
+                printf ( "%u,%d\n", t * 1000 / SIM_HZ, Sim_Log [ k ] [ t ] );
+            printf ( "e\n" );
+        }
+
+    fprintf ( stderr, "acc %u/s jerk %u/s2 speed %d, per %u us step:\n", acc, jerk, speed, 1000000 / SIM_HZ );
+    for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+        fprintf ( stderr, "  wheel %u: max duty change %d, max change of change %d\n", k, dv_max [ k ], da_max [ k ] );
+    return 0;
+}
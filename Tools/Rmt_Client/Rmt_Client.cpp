@@ -0,0 +1,342 @@
+/*
+ңؿͻˣڵУ
+
+ΪTCPС( Tools/Rmt_Sim)ңָ(Driver/Telemetry.h  TLM_ID_CMD_*)
+Сʱ(WIFI_LINK_SERVER) -c Сȵַ sub ָͻ˶ĵң⡣
+ÿָţ֡ͷʱʱ(ms)СӦʱԭأʱӣ
+ʱûӦͬһطСȥأطָֻӦִС
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Rmt_Client Rmt_Client.cpp ../../Driver/Remote.cpp ../../Driver/Telemetry.cpp
+
+÷
+	./Rmt_Client [-p 8080] [-r طʱms]                Ӽָ
+	./Rmt_Client [-p 8080] -n  [-i ms]             pingӡʱͳ
+	./Rmt_Client -c 192.168.123.169 [-p 8080] ...         С(ESP8266_TcpServer_IP)
+ָ
+	jog <0ǰ 1 2 3 4ͣ 5ǰ 6ǰ 7 8Һ> <ms>    stop    start []    param <> <ֵ>    ping
+	vel <vx> <vyǰ> <wʱ> <ms>    ٶȣռձȵλ(-1000~1000)ʱСȱС
+	param ţ0 ʻPWM  1 ʱms  2 б¼ٶ(ÿ)  3 б¼Ӽٶ(ÿÿ)
+	sub <>    nλΪҪյ TLM_ID n 0x18 ֻӾ
+*/
+
+#include "Remote.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+
+#define CLI_TRIES          5               //෢ʹ
+
+
+struct Cli_Pending
+{
+    std::vector<uint8_t> frame;            //طʱԭٷһ
+    uint8_t              id;
+    uint32_t             sent_ms;          //֡ͷʱ
+    uint64_t             first_us;
+    uint64_t             last_us;
+    uint8_t              tries;
+};
+
+static const char *  Cli_Name [ ] = { "jog", "stop", "start", "param", "ping", "sub", "ota", "vel" };
+static const char *  Cli_Res [ ] = { "OK", "DUP", "BUSY", "BAD_ARG", "UNKNOWN" };
+
+static int           Cli_Sock = -1;
+static uint64_t      Cli_Start;
+static uint32_t      Cli_Rto_us = 100000;
+static bool          Cli_Quiet;
+static std::map<uint16_t, Cli_Pending>  Cli_Wait;
+static std::vector<uint8_t>             Cli_Frame;        //Cli_Write ձõ֡
+static std::vector<double>              Cli_Rtt;          //ms
+static uint32_t      Cli_Sent, Cli_Acked, Cli_Retries, Cli_Failed, Cli_DupAck, Cli_EchoBad, Cli_Tlm;
+static uint32_t      Cli_CarMax;                          //СЧʱ(us)
+
+
+static uint64_t Cli_Now(void)
+{
+    struct timespec t;
+    clock_gettime ( CLOCK_MONOTONIC, &t );
+    return (uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000 - Cli_Start;
+}
+
+
+static uint16_t Cli_Write(const uint8_t *buf, uint16_t len)
+{
+    Cli_Frame .assign ( buf, buf + len );
+    return len;
+}
+
+static Telemetry tlm ( Cli_Write );
+
+
+static void Cli_Send(uint8_t id, const uint8_t *payload, uint8_t len)
+{
+    Cli_Pending p;
+    uint16_t    seq;
+    int         n;
+
+    p .sent_ms = Cli_Now () / 1000;
+    seq = (uint16_t)tlm .sent_frames ();                  //Telemetry Ŵ0ʼÿ֡1
+    tlm .send ( id, p .sent_ms, payload, len );
+    p .frame = Cli_Frame;
+    p .id = id;
+    p .first_us = p .last_us = Cli_Now ();
+    p .tries = 1;
+    n = write ( Cli_Sock, p .frame .data (), p .frame .size () );
+    (void)n;
+    Cli_Wait [ seq ] = p;
+    Cli_Sent ++;
+}
+
+
+static void Cli_Retry(void)
+{
+    std::map<uint16_t, Cli_Pending>::iterator it = Cli_Wait .begin ();
+    uint64_t now = Cli_Now ();
+    int      n;
+
+    while ( it != Cli_Wait .end () )
+    {
+        if ( now - it->second .last_us < Cli_Rto_us )
+        {
+            ++ it;
+            continue;
+        }
+        if ( it->second .tries >= CLI_TRIES )
+        {
+            if ( ! Cli_Quiet )
+                printf ( "seq %u %s: no ack after %d tries\n", it->first, Cli_Name [ it->second .id - TLM_ID_CMD_JOG ], CLI_TRIES );
+            Cli_Failed ++;
+            Cli_Wait .erase ( it ++ );
+            continue;
+        }
+        n = write ( Cli_Sock, it->second .frame .data (), it->second .frame .size () );
+        (void)n;
+        it->second .last_us = now;
+        it->second .tries ++;
+        Cli_Retries ++;
+        ++ it;
+    }
+}
+
+
+static void Cli_Frame_In(const Rmt_Cmd *f, void *arg)     //С֡(ңӦ)
+{
+    std::map<uint16_t, Cli_Pending>::iterator it;
+    Tlm_Ack a;
+    double  rtt;
+
+    if ( f->head .id != TLM_ID_ACK )
+    {
+        Cli_Tlm ++;
+        return;
+    }
+    if ( ! Telemetry::get_ack ( f->data, f->len, &a ) )
+        return;
+    it = Cli_Wait .find ( a .cmd_seq );
+    if ( it == Cli_Wait .end () )                          //ط֮Ӧ𶼻
+    {
+        Cli_DupAck ++;
+        return;
+    }
+    if ( a .echo != it->second .sent_ms )
+        Cli_EchoBad ++;
+    rtt = ( Cli_Now () - it->second .first_us ) / 1000.0;
+    Cli_Rtt .push_back ( rtt );
+    if ( a .latency_us > Cli_CarMax )
+        Cli_CarMax = a .latency_us;
+    Cli_Acked ++;
+    if ( ! Cli_Quiet )
+        printf ( "seq %u %s: %s, rtt %.1f ms (echo %u ms), car %u us, tries %u\n", a .cmd_seq,
+                 Cli_Name [ it->second .id - TLM_ID_CMD_JOG ], ( a .result < 5 ) ? Cli_Res [ a .result ] : "?",
+                 rtt, (uint32_t)( Cli_Now () / 1000 ) - a .echo, a .latency_us, it->second .tries );
+    Cli_Wait .erase ( it );
+}
+
+static Remote rmt ( Cli_Frame_In, 0 );
+
+
+static bool Cli_Line(char *line)
+{
+    char      cmd [ 16 ];
+    int       a = 0, b = 0, c = 0, d = 0, n;
+    uint8_t   buf [ TLM_PAYLOAD_MAX ];
+    Tlm_Jog   jog;
+    Tlm_Vel   vel;
+    Tlm_Param par;
+
+    n = sscanf ( line, "%15s %d %d %d %d", cmd, &a, &b, &c, &d );
+    if ( n < 1 )
+        return true;
+    if ( ! strcmp ( cmd, "jog" ) && n == 3 )
+    {
+        jog .dir = a;
+        jog .time_ms = b;
+        Cli_Send ( TLM_ID_CMD_JOG, buf, Telemetry::put_jog ( buf, &jog ) );
+    }
+    else if ( ! strcmp ( cmd, "vel" ) && n == 5 )
+    {
+        vel .vx = a;
+        vel .vy = b;
+        vel .w = c;
+        vel .time_ms = d;
+        Cli_Send ( TLM_ID_CMD_VEL, buf, Telemetry::put_vel ( buf, &vel ) );
+    }
+    else if ( ! strcmp ( cmd, "stop" ) )
+        Cli_Send ( TLM_ID_CMD_STOP, 0, 0 );
+    else if ( ! strcmp ( cmd, "start" ) )
+    {
+        buf [ 0 ] = ( n >= 2 ) ? a : 0;
+        Cli_Send ( TLM_ID_CMD_MISSION, buf, 1 );
+    }
+    else if ( ! strcmp ( cmd, "param" ) && n == 3 )
+    {
+        par .id = a;
+        par .value = b;
+        Cli_Send ( TLM_ID_CMD_PARAM, buf, Telemetry::put_param ( buf, &par ) );
+    }
+    else if ( ! strcmp ( cmd, "ping" ) )
+        Cli_Send ( TLM_ID_CMD_PING, 0, 0 );
+    else if ( ! strcmp ( cmd, "sub" ) && sscanf ( line, "%*s %i", &a ) == 1 )
+    {
+        buf [ 0 ] = a;
+        Cli_Send ( TLM_ID_CMD_SUB, buf, 1 );
+    }
+    else if ( ! strcmp ( cmd, "quit" ) )
+        return false;
+    else
+        printf ( "jog <dir> <ms> | vel <vx> <vy> <w> <ms> | stop | start [step] | param <id> <value> | ping | sub <mask> | quit\n" );
+    return true;
+}
+
+
+static void Cli_Report(void)
+{
+    double sum = 0;
+    size_t i, n = Cli_Rtt .size ();
+
+    fprintf ( stderr, "sent %u, acked %u, retries %u, failed %u, late acks %u, echo mismatch %u, telemetry frames %u\n",
+              Cli_Sent, Cli_Acked, Cli_Retries, Cli_Failed, Cli_DupAck, Cli_EchoBad, Cli_Tlm );
+    fprintf ( stderr, "link in: %u bad, %u lost\n", rmt .bad_frames (), rmt .lost_frames () );
+    if ( n == 0 )
+        return;
+    std::sort ( Cli_Rtt .begin (), Cli_Rtt .end () );
+    for ( i = 0; i < n; i++ )
+        sum += Cli_Rtt [ i ];
+    fprintf ( stderr, "rtt ms: min %.2f avg %.2f p50 %.2f p99 %.2f max %.2f; car apply max %u us\n",
+              Cli_Rtt [ 0 ], sum / n, Cli_Rtt [ n / 2 ], Cli_Rtt [ n * 99 / 100 ], Cli_Rtt [ n - 1 ], Cli_CarMax );
+}
+
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_in addr;
+    struct pollfd      pfd [ 2 ];
+    int                port = 8080, count = 0, interval = 10, opt, s, on = 1, n;
+    uint8_t            in [ 4096 ];
+    char               line [ 256 ];
+    uint64_t           next = 0;
+    bool               input = true;
+    const char *       car = 0;
+
+    while ( ( opt = getopt ( argc, argv, "c:p:r:n:i:" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'c': car = optarg; break;
+            case 'p': port = atoi ( optarg ); break;
+            case 'r': Cli_Rto_us = atoi ( optarg ) * 1000; break;
+            case 'n': count = atoi ( optarg ); break;
+            case 'i': interval = atoi ( optarg ); break;
+            default:
+                fprintf ( stderr, "usage: %s [-c car_ip] [-p port] [-r rto_ms] [-n count [-i interval_ms]]\n", argv [ 0 ] );
+                return 1;
+        }
+    }
+    Cli_Quiet = ( count > 0 );
+    Cli_Start = 0;
+    Cli_Start = Cli_Now ();
+
+    s = socket ( AF_INET, SOCK_STREAM, 0 );
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr .sin_family = AF_INET;
+    addr .sin_port = htons ( port );
+    if ( car )                                          //СǷ
+    {
+        inet_pton ( AF_INET, car, &addr .sin_addr );
+        if ( connect ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 )
+        {
+            perror ( "connect" );
+            return 1;
+        }
+        Cli_Sock = s;
+    }
+    else
+    {
+        setsockopt ( s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof ( on ) );
+        addr .sin_addr .s_addr = htonl ( INADDR_ANY );
+        if ( bind ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 || listen ( s, 1 ) < 0 )
+        {
+            perror ( "listen" );
+            return 1;
+        }
+        fprintf ( stderr, "waiting on port %d\n", port );
+        Cli_Sock = accept ( s, 0, 0 );
+        close ( s );
+    }
+    setsockopt ( Cli_Sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+    fprintf ( stderr, "car connected\n" );
+
+    while ( 1 )
+    {
+        if ( count > 0 && Cli_Now () >= next )             //
+        {
+            Cli_Send ( TLM_ID_CMD_PING, 0, 0 );
+            next = Cli_Now () + interval * 1000;
+            count --;
+        }
+        if ( count == 0 && Cli_Quiet && Cli_Wait .empty () )
+            break;
+
+        pfd [ 0 ] .fd = Cli_Sock;
+        pfd [ 0 ] .events = POLLIN;
+        pfd [ 1 ] .fd = 0;
+        pfd [ 1 ] .events = POLLIN;
+        poll ( pfd, ( Cli_Quiet || ! input ) ? 1 : 2, 1 );
+
+        if ( pfd [ 0 ] .revents & ( POLLIN | POLLHUP | POLLERR ) )
+        {
+            n = read ( Cli_Sock, in, sizeof ( in ) );
+            if ( n <= 0 )
+            {
+                fprintf ( stderr, "car disconnected\n" );
+                break;
+            }
+            rmt .feed ( in, n, 0 );
+        }
+        if ( ! Cli_Quiet && input && ( pfd [ 1 ] .revents & ( POLLIN | POLLHUP ) ) )
+        {
+            if ( ! fgets ( line, sizeof ( line ), stdin ) || ! Cli_Line ( line ) )
+                input = false;
+            fflush ( stdout );
+        }
+        if ( ! input && Cli_Wait .empty () )
+            break;
+        Cli_Retry ();
+    }
+
+    Cli_Report ();
+    close ( Cli_Sock );
+    return 0;
+}
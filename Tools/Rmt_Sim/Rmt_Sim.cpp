@@ -0,0 +1,339 @@
+/*
+ң·ģڵУСESP8266
+
+Сһϵңؿͻ(Tools/Rmt_Client)յֽ Driver/Remote.cpp ֡
+ User_main.c  Remote_Task ִָ Driver/Telemetry.cpp Ӧͬʱ100Hzλң⡣
+-d ģWiFiģתĵʱӣ-l ٷֱ֡(򶼶)طȥء
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Rmt_Sim Rmt_Sim.cpp ../../Driver/Remote.cpp ../../Driver/Telemetry.cpp
+
+÷
+	./Rmt_Sim [-a 127.0.0.1] [-p 8080] [-d ʱms] [-l ֡ٷֱ]
+*/
+
+#include "Remote.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <deque>
+#include <vector>
+
+
+#define SIM_POSE_US        10000           //λң
+#define SIM_DIR_FREE       9               //ͬ Diretion  Free vel ָٶ
+#define SIM_ROT_MM         200             //볤Ӱԭתʱٶȳǽٶ
+#define SIM_JOG_MAX_MS     5000
+
+
+struct Sim_Chunk
+{
+    uint64_t             due;              //Զ˵ʱ(us)
+    std::vector<uint8_t> data;
+};
+
+static std::deque<Sim_Chunk>  Sim_In, Sim_Out;     //ԡСС
+static uint32_t  Sim_Delay_us;
+static int       Sim_Loss;                         //ٷֱ
+static uint32_t  Sim_Drop_In, Sim_Drop_Out;
+
+static int       Car_Dir = 4;                      //ͬ Diretion4Ϊͣ
+static bool      Car_Mission;
+static bool      Car_Jogging;
+static uint64_t  Car_JogEnd;
+static int       Car_Speed = 200;
+static int       Car_Step;
+static float     Car_X, Car_Y, Car_Th;
+static int       Car_Vel [ 3 ];                    //vel ָ vx vy w
+static uint32_t  Car_Cmds [ 6 ];
+
+
+static uint64_t Sim_Now(void)
+{
+    struct timespec t;
+    clock_gettime ( CLOCK_MONOTONIC, &t );
+    return (uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000;
+}
+
+
+static uint16_t Sim_Write(const uint8_t *buf, uint16_t len)      //С֡֡֡ʱӵ
+{
+    Sim_Chunk c;
+
+    if ( rand () % 100 < Sim_Loss )
+    {
+        Sim_Drop_Out ++;
+        return len;                                                 //Ѿ·϶
+    }
+    c .due = Sim_Now () + Sim_Delay_us;
+    c .data .assign ( buf, buf + len );
+    Sim_Out .push_back ( c );
+    return len;
+}
+
+static Telemetry tlm ( Sim_Write );
+
+
+static void Sim_Ack(const Rmt_Cmd *cmd, uint8_t result)
+{
+    Tlm_Ack  a;
+    uint32_t us = (uint32_t)Sim_Now () - cmd->ts;
+
+    a .cmd_seq = cmd->head .seq;
+    a .cmd_id = cmd->head .id;
+    a .result = result;
+    a .echo = cmd->head .time;
+    a .latency_us = ( us > 0xFFFF ) ? 0xFFFF : us;
+    tlm .ack ( Sim_Now () / 1000, &a );
+}
+
+
+static void Sim_Cmd(const Rmt_Cmd *cmd, void *arg)               // Remote_Task ͬж
+{
+    Tlm_Jog   jog;
+    Tlm_Vel   vel;
+    Tlm_Param par;
+    uint8_t   res = TLM_RES_OK;
+
+    if ( cmd->dup )
+    {
+        Sim_Ack ( cmd, TLM_RES_DUP );
+        return;
+    }
+    if ( ( cmd->head .id >= TLM_ID_CMD_JOG ) && ( cmd->head .id <= TLM_ID_CMD_PING ) )
+        Car_Cmds [ cmd->head .id - TLM_ID_CMD_JOG ] ++;
+
+    switch ( cmd->head .id )
+    {
+        case TLM_ID_CMD_JOG:
+            if ( ! Telemetry::get_jog ( cmd->data, cmd->len, &jog ) )
+                res = TLM_RES_UNKNOWN;
+            else if ( Car_Mission )
+                res = TLM_RES_BUSY;
+            else if ( ( jog .dir > 8 ) || ( jog .time_ms == 0 ) || ( jog .time_ms > SIM_JOG_MAX_MS ) )
+                res = TLM_RES_BAD_ARG;
+            else
+            {
+                Car_Dir = jog .dir;
+                Car_JogEnd = Sim_Now () + jog .time_ms * 1000u;
+                Car_Jogging = ( Car_Dir != 4 );
+            }
+            break;
+
+        case TLM_ID_CMD_VEL:
+            if ( ! Telemetry::get_vel ( cmd->data, cmd->len, &vel ) )
+                res = TLM_RES_UNKNOWN;
+            else if ( Car_Mission )
+                res = TLM_RES_BUSY;
+            else if ( ( vel .time_ms == 0 ) || ( vel .time_ms > SIM_JOG_MAX_MS ) )
+                res = TLM_RES_BAD_ARG;
+            else
+            {
+                Car_Vel [ 0 ] = vel .vx;
+                Car_Vel [ 1 ] = vel .vy;
+                Car_Vel [ 2 ] = vel .w;
+                Car_Jogging = ( vel .vx || vel .vy || vel .w );
+                Car_Dir = Car_Jogging ? SIM_DIR_FREE : 4;
+                Car_JogEnd = Sim_Now () + vel .time_ms * 1000u;
+            }
+            break;
+
+        case TLM_ID_CMD_STOP:
+            Car_Dir = 4;
+            Car_Jogging = false;
+            Car_Mission = false;
+            break;
+
+        case TLM_ID_CMD_MISSION:
+            if ( cmd->len < 1 )
+                res = TLM_RES_UNKNOWN;
+            else if ( Car_Mission || Car_Jogging )
+                res = TLM_RES_BUSY;
+            else if ( cmd->data [ 0 ] > 11 )
+                res = TLM_RES_BAD_ARG;
+            else
+            {
+                Car_Step = cmd->data [ 0 ];
+                Car_Mission = true;
+                Car_Dir = 0;
+            }
+            break;
+
+        case TLM_ID_CMD_PARAM:
+            if ( ! Telemetry::get_param ( cmd->data, cmd->len, &par ) )
+                res = TLM_RES_UNKNOWN;
+            else if ( ( par .id == TLM_PARAM_MOVE_SPEED ) && ( par .value >= 0 ) && ( par .value <= 1000 ) )
+                Car_Speed = par .value;
+            else if ( ( par .id == TLM_PARAM_CORRECT_TIME ) && ( par .value >= 0 ) && ( par .value <= 5000 ) )
+                ;
+            else if ( ( par .id == TLM_PARAM_RAMP_ACC ) && ( par .value >= 0 ) && ( par .value <= 1000000 ) )
+                ;
+            else if ( ( par .id == TLM_PARAM_RAMP_JERK ) && ( par .value >= 0 ) && ( par .value <= 10000000 ) )
+                ;
+            else
+                res = TLM_RES_BAD_ARG;
+            break;
+
+        case TLM_ID_CMD_PING:
+            break;
+
+        default:
+            res = TLM_RES_UNKNOWN;
+            break;
+    }
+    Sim_Ack ( cmd, res );
+}
+
+static Remote rmt ( Sim_Cmd, 0 );
+
+
+static void Sim_Received(const uint8_t *p, int n)       //Էֽڣ֡
+{
+    static Sim_Chunk c;
+    int i;
+
+    for ( i = 0; i < n; i++ )
+    {
+        c .data .push_back ( p [ i ] );
+        if ( p [ i ] != 0x00 )
+            continue;
+        if ( rand () % 100 < Sim_Loss )
+            Sim_Drop_In ++;
+        else
+        {
+            c .due = Sim_Now () + Sim_Delay_us;
+            Sim_In .push_back ( c );
+        }
+        c .data .clear ();
+    }
+}
+
+
+static void Sim_Pose(uint64_t now)
+{
+    static const float dx [ 9 ] = { 0, 0, -1, 1, 0, -0.707f, 0.707f, -0.707f, 0.707f };
+    static const float dy [ 9 ] = { 1, -1, 0, 0, 0, 0.707f, 0.707f, -0.707f, -0.707f };
+    Tlm_Pose pose;
+    float    vx, vy;
+
+    if ( Car_Dir == SIM_DIR_FREE )                                  //ת
+    {
+        vx = Car_Vel [ 0 ] * cosf ( Car_Th ) - Car_Vel [ 1 ] * sinf ( Car_Th );
+        vy = Car_Vel [ 0 ] * sinf ( Car_Th ) + Car_Vel [ 1 ] * cosf ( Car_Th );
+        Car_Th += Car_Vel [ 2 ] / 1000.0f * 500 / SIM_ROT_MM * SIM_POSE_US / 1e6f;
+        Car_X += vx / 1000.0f * 5;
+        Car_Y += vy / 1000.0f * 5;
+    }
+    else
+    {
+        Car_X += dx [ Car_Dir ] * Car_Speed / 1000.0f * 5;          //ռձԼ0.5m/s
+        Car_Y += dy [ Car_Dir ] * Car_Speed / 1000.0f * 5;
+    }
+    pose .x_mm = Car_X;
+    pose .y_mm = Car_Y;
+    pose .theta_mrad = Car_Th * 1000;
+    pose .grid_x = pose .x_mm / 300;
+    pose .grid_y = pose .y_mm / 300;
+    tlm .pose ( now / 1000, &pose );
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *       addr = "127.0.0.1";
+    int                port = 8080, opt, s, n, on = 1;
+    struct sockaddr_in sa;
+    uint8_t            in [ 4096 ];
+    uint64_t           now, next_pose, wake;
+    struct pollfd      pfd;
+    size_t             i;
+
+    while ( ( opt = getopt ( argc, argv, "a:p:d:l:" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'a': addr = optarg; break;
+            case 'p': port = atoi ( optarg ); break;
+            case 'd': Sim_Delay_us = atoi ( optarg ) * 1000; break;
+            case 'l': Sim_Loss = atoi ( optarg ); break;
+            default:
+                fprintf ( stderr, "usage: %s [-a addr] [-p port] [-d delay_ms] [-l loss_percent]\n", argv [ 0 ] );
+                return 1;
+        }
+    }
+    srand ( 1 );
+
+    s = socket ( AF_INET, SOCK_STREAM, 0 );
+    memset ( &sa, 0, sizeof ( sa ) );
+    sa .sin_family = AF_INET;
+    sa .sin_port = htons ( port );
+    inet_pton ( AF_INET, addr, &sa .sin_addr );
+    if ( connect ( s, (struct sockaddr *)&sa, sizeof ( sa ) ) < 0 )
+    {
+        perror ( "connect" );
+        return 1;
+    }
+    setsockopt ( s, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+    fprintf ( stderr, "connected to %s:%d, delay %u ms, loss %d%%\n", addr, port, Sim_Delay_us / 1000, Sim_Loss );
+
+    next_pose = Sim_Now ();
+    while ( 1 )
+    {
+        now = Sim_Now ();
+        wake = next_pose;
+        if ( ! Sim_In .empty () && Sim_In .front () .due < wake )
+            wake = Sim_In .front () .due;
+        if ( ! Sim_Out .empty () && Sim_Out .front () .due < wake )
+            wake = Sim_Out .front () .due;
+        if ( Car_Jogging && Car_JogEnd < wake )
+            wake = Car_JogEnd;
+
+        pfd .fd = s;
+        pfd .events = POLLIN;
+        if ( poll ( &pfd, 1, ( wake > now ) ? (int)( ( wake - now + 999 ) / 1000 ) : 0 ) > 0 )
+        {
+            n = read ( s, in, sizeof ( in ) );
+            if ( n <= 0 )
+                break;
+            Sim_Received ( in, n );
+        }
+
+        now = Sim_Now ();
+        while ( ! Sim_In .empty () && Sim_In .front () .due <= now )
+        {
+            for ( i = 0; i < Sim_In .front () .data .size (); i++ )        //ʹжһһֽһֽι
+                rmt .feed ( &Sim_In .front () .data [ i ], 1, Sim_Now () );
+            Sim_In .pop_front ();
+        }
+        if ( Car_Jogging && Car_JogEnd <= now )
+        {
+            Car_Dir = 4;
+            Car_Jogging = false;
+        }
+        if ( next_pose <= now )
+        {
+            Sim_Pose ( now );
+            next_pose += SIM_POSE_US;
+        }
+        while ( ! Sim_Out .empty () && Sim_Out .front () .due <= now )
+        {
+            if ( write ( s, Sim_Out .front () .data .data (), Sim_Out .front () .data .size () ) < 0 )
+                break;
+            Sim_Out .pop_front ();
+        }
+    }
+
+    fprintf ( stderr, "commands: jog %u, stop %u, mission %u, param %u, ping %u\n",
+              Car_Cmds [ 0 ], Car_Cmds [ 1 ], Car_Cmds [ 2 ], Car_Cmds [ 3 ], Car_Cmds [ 4 ] );
+    fprintf ( stderr, "remote: %u frames, %u dup, %u lost, %u bad; link dropped %u in, %u out\n",
+              rmt .rx_frames (), rmt .dup_frames (), rmt .lost_frames (), rmt .bad_frames (), Sim_Drop_In, Sim_Drop_Out );
+    return 0;
+}
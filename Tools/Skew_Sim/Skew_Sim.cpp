@@ -0,0 +1,242 @@
+/*
+бĳģ⣨ڵУ
+
+̳أ߼ -G mmķʱ(ͬ Ramp_Sim)ʼʱͷ -t mrad
+ұӱ -b %(ŻԼת)ÿ 1/CTRL_HZ 룺ĸӾ Driver/Ramp.cpp б£
+ռձȳ -k ٣ϳɳٶȻֳʵλˣĸѲߴλɨʱһĲֵ
+ѹʱ(ɼ -J us ڵжӳ) Driver/Line_Timing.cpp ԣɶԵĽ
+Driver/Skew_Est.cpp ƺÿ 1/ODOM_HZ 밴 w ½ Driver/Mecanum.cppͬ config.cpp
+̼Ƶĺȡʵֵ(-d ɼÿƯ mrad)-n ֻƲԱá
+
+ÿʵλˡƵ; w(CSV)׼ϴӡÿʵֵͳơ
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Skew_Sim Skew_Sim.cpp ../../Driver/Line_Timing.cpp ../../Driver/Skew_Est.cpp ../../Driver/Mecanum.cpp ../../Driver/Ramp.cpp -lm
+
+÷
+	./Skew_Sim [-t ʼбmrad] [-b %] [-s ٶ] [-k mm/sÿռձ] [-G mm] [-J ӳus] [-d Ưmrad/s] [-n] [:ms ...] > skew.csv
+up back left right stopĬ right:4000 up:4000 left:4000
+*/
+
+#include "Line_Timing.h"
+#include "Skew_Est.h"
+#include "Mecanum.h"
+#include "Ramp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+#define SIM_HZ              1000            //ͬ config.h  CTRL_HZ
+#define SIM_ODOM_HZ         100             //ODOM_HZ
+#define SIM_DUTY_MAX        1000            //MOVE_DUTY_MAX
+#define SIM_ACC             4000            //MOVE_ACC_DEFAULT
+#define SIM_JERK            80000           //MOVE_JERK_DEFAULT
+#define SIM_ROT_MM          200             //ODOM_ROT_MM
+#define SIM_FB_MM           160             //LINE_FB_MM
+#define SIM_LR_MM           160             //LINE_LR_MM
+#define SIM_PAIR_MS         300             //LINE_PAIR_MS
+#define SIM_V_MIN           50              //SKEW_V_MIN
+#define SIM_ERR_MAX         250             //SKEW_ERR_MAX
+#define SIM_GAIN            100             //SKEW_GAIN
+#define SIM_DEADBAND        5               //SKEW_DEADBAND
+#define SIM_W_MAX           60              //SKEW_W_MAX
+#define SIM_TS_HZ           72000000u       //ʱͬ CPU_TS_TmrRd()
+#define SIM_STEP_MAX        32
+
+
+struct Sim_Dir
+{
+    const char *    name;
+    int8_t          dx;
+    int8_t          dy;
+};
+
+static const Sim_Dir Sim_Dirs [ ] =
+{
+    { "up", 0, 1 }, { "back", 0, -1 }, { "left", -1, 0 }, { "right", 1, 0 }, { "stop", 0, 0 },
+};
+
+struct Sim_Step
+{
+    const Sim_Dir * dir;
+    uint32_t        ms;
+};
+
+struct Sim_Sensor                           //(mm)˳ͬ Position ı 1~4
+{
+    double          x;
+    double          y;
+    bool            vertical;               //ѹ(x Ϊ)Ǻ
+};
+
+static const Sim_Sensor Sim_Sensors [ LINE_SENSOR_NUM ] =
+{
+    { 0, SIM_FB_MM / 2.0, true }, { 0, -SIM_FB_MM / 2.0, true },
+    { -SIM_LR_MM / 2.0, 0, false }, { SIM_LR_MM / 2.0, 0, false },
+};
+
+
+static const Sim_Dir * Sim_Find(const char *name)
+{
+    uint8_t i;
+
+    for ( i = 0; i < sizeof ( Sim_Dirs ) / sizeof ( Sim_Dirs [ 0 ] ); i++ )
+        if ( ! strcmp ( Sim_Dirs [ i ] .name, name ) )
+            return &Sim_Dirs [ i ];
+    return 0;
+}
+
+
+static bool Sim_Parse(const char *arg, Sim_Step *step)
+{
+    char name [ 16 ];
+    const char *c = strchr ( arg, ':' );
+
+    if ( ! c || ( c - arg ) >= (int)sizeof ( name ) )
+        return false;
+    memcpy ( name, arg, c - arg );
+    name [ c - arg ] = 0;
+    step->dir = Sim_Find ( name );
+    step->ms = atoi ( c + 1 );
+    return step->dir && step->ms;
+}
+
+
+static void Sim_Where(double px, double py, double th, const Sim_Sensor *s, double *x, double *y)
+{
+    *x = px + s->x * cos ( th ) - s->y * sin ( th );
+    *y = py + s->x * sin ( th ) + s->y * cos ( th );
+}
+
+
+int main(int argc, char **argv)
+{
+    static const char * Sim_Default [ ] = { "right:4000", "up:4000", "left:4000" };
+    Sim_Step    steps [ SIM_STEP_MAX ];
+    uint8_t     n = 0, i, k;
+    int16_t     speed = 200, d [ MEC_WHEEL_NUM ], vx = 0, vy = 0, w = 0, th_mrad, odom_v;
+    double      tilt = 80, weak = 3, mm_per_duty = 1.5, grid = 300, jitter = 0, drift = 0;
+    double      px, py, th, wv [ MEC_WHEEL_NUM ], bvx, bvy, bw, odom_err = 0;
+    double      ox [ LINE_SENSOR_NUM ], oy [ LINE_SENSOR_NUM ], nx, ny, a, b, frac, th_max = 0, th_sum2 = 0, e_sum2 = 0;
+    uint32_t    t = 0, ms, ts, samples = 0;
+    bool        fix = true;
+    int         opt, pair;
+    Line_Edge   e;
+    Mecanum     mec ( SIM_DUTY_MAX );
+    Ramp        ramp [ MEC_WHEEL_NUM ] = { Ramp ( SIM_HZ ), Ramp ( SIM_HZ ), Ramp ( SIM_HZ ), Ramp ( SIM_HZ ) };
+    Line_Timing line ( SIM_TS_HZ, 300, SIM_PAIR_MS * 1000u );         //ӱֻ߳㳵٣ò
+    Skew_Est    skew ( SIM_FB_MM, SIM_LR_MM, SIM_V_MIN, SIM_ERR_MAX );
+
+    for ( opt = 1; opt < argc; opt++ )
+    {
+        if ( ! strcmp ( argv [ opt ], "-t" ) && opt + 1 < argc )
+            tilt = atof ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-b" ) && opt + 1 < argc )
+            weak = atof ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-s" ) && opt + 1 < argc )
+            speed = atoi ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-k" ) && opt + 1 < argc )
+            mm_per_duty = atof ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-G" ) && opt + 1 < argc )
+            grid = atof ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-J" ) && opt + 1 < argc )
+            jitter = atof ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-d" ) && opt + 1 < argc )
+            drift = atof ( argv [ ++opt ] );
+        else if ( ! strcmp ( argv [ opt ], "-n" ) )
+            fix = false;
+        else if ( n < SIM_STEP_MAX && Sim_Parse ( argv [ opt ], &steps [ n ] ) )
+            n++;
+        else
+        {
+            fprintf ( stderr, "usage: %s [-t mrad] [-b %%] [-s speed] [-k mm/s/duty] [-G mm] [-J us] [-d mrad/s] [-n] [dir:ms ...]\n", argv [ 0 ] );
+            return 1;
+        }
+    }
+    if ( n == 0 )
+        for ( n = 0; n < sizeof ( Sim_Default ) / sizeof ( Sim_Default [ 0 ] ); n++ )
+            Sim_Parse ( Sim_Default [ n ], &steps [ n ] );
+
+    for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+        ramp [ k ] .limits ( SIM_ACC, SIM_JERK );
+    srand ( 1 );
+    th = tilt / 1000;
+    px = grid / 2;                                      //Ӹм
+    py = grid / 2;
+    for ( k = 0; k < LINE_SENSOR_NUM; k++ )
+        Sim_Where ( px, py, th, &Sim_Sensors [ k ], &ox [ k ], &oy [ k ] );
+
+    printf ( "ms,x,y,theta_mrad,est_mrad,w\n" );
+    for ( i = 0; i < n; i++ )
+    {
+        vx = steps [ i ] .dir->dx * speed;
+        vy = steps [ i ] .dir->dy * speed;
+
+        for ( ms = 0; ms < steps [ i ] .ms * SIM_HZ / 1000; ms++, t++ )
+        {
+            th_mrad = (int16_t)lround ( ( th + odom_err ) * 1000 );     //̼Ƶĺ
+
+            if ( t % ( SIM_HZ / SIM_ODOM_HZ ) == 0 )      //ͬ Skew_Tick()
+            {
+                w = ( fix && ( vx || vy ) ) ? skew.correct ( th_mrad, SIM_GAIN, SIM_DEADBAND, SIM_W_MAX ) : 0;
+                mec.solve ( vx, vy, w, d );
+                for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+                    ramp [ k ] .target ( d [ k ] );
+            }
+
+            for ( k = 0; k < MEC_WHEEL_NUM; k++ )
+                wv [ k ] = ramp [ k ] .tick () * mm_per_duty * ( ( k & 1 ) ? 1 - weak / 100 : 1 );     //ǰҺ
+            bvy = ( wv [ 0 ] + wv [ 1 ] + wv [ 2 ] + wv [ 3 ] ) / 4;                 //ͬ Odometry.h
+            bvx = ( wv [ 0 ] - wv [ 1 ] - wv [ 2 ] + wv [ 3 ] ) / 4;
+            bw = ( -wv [ 0 ] + wv [ 1 ] - wv [ 2 ] + wv [ 3 ] ) / 4 / SIM_ROT_MM;
+            px += ( bvx * cos ( th ) - bvy * sin ( th ) ) / SIM_HZ;
+            py += ( bvx * sin ( th ) + bvy * cos ( th ) ) / SIM_HZ;
+            th += bw / SIM_HZ;
+            odom_err += drift / 1000 / SIM_HZ;
+
+            for ( k = 0; k < LINE_SENSOR_NUM; k++ )     //һɨ
+            {
+                Sim_Where ( px, py, th, &Sim_Sensors [ k ], &nx, &ny );
+                a = Sim_Sensors [ k ] .vertical ? ox [ k ] : oy [ k ];
+                b = Sim_Sensors [ k ] .vertical ? nx : ny;
+                if ( floor ( a / grid ) != floor ( b / grid ) )
+                {
+                    double line_at = ( b > a ) ? floor ( b / grid ) * grid : floor ( a / grid ) * grid;
+                    frac = ( line_at - a ) / ( b - a );
+                    ts = (uint32_t)( ( t + frac ) * ( SIM_TS_HZ / SIM_HZ ) + jitter * ( rand () / (double)RAND_MAX ) * ( SIM_TS_HZ / 1000000 ) );
+                    line.push ( k + 1, ts );
+                }
+                ox [ k ] = nx;
+                oy [ k ] = ny;
+            }
+
+            while ( line.pop ( &e ) )                   //ͬ Line_Drain()
+            {
+                pair = line.feed ( &e );
+                if ( pair < 0 )
+                    continue;
+                odom_v = (int16_t)lround ( pair == LINE_PAIR_FB ? bvx : bvy );
+                if ( skew.cross ( pair, line.pair_dt ( pair ), odom_v, th_mrad ) )
+                {
+                    fprintf ( stderr, "%6u ms  %s  dt %6d us  measured %4d mrad  true %4d mrad\n", t,
+                              pair == LINE_PAIR_FB ? "front/back" : "left/right", line.pair_dt ( pair ), skew.last (), (int)lround ( th * 1000 ) );
+                    e_sum2 += ( skew.last () - th * 1000 ) * ( skew.last () - th * 1000 );
+                }
+            }
+
+            if ( fabs ( th ) > th_max )
+                th_max = fabs ( th );
+            th_sum2 += th * th;
+            samples++;
+            printf ( "%u,%.1f,%.1f,%.1f,%d,%d\n", t, px, py, th * 1000, skew.error ( th_mrad ), w );
+        }
+    }
+
+    fprintf ( stderr, "%s: start %.0f mrad, right wheels %.1f%% weak, speed %d\n", fix ? "corrected" : "estimate only", tilt, weak, speed );
+    fprintf ( stderr, "  crossings: %u measured, %u rejected, measurement rms error %.1f mrad\n",
+              skew.count (), skew.rejects (), skew.count () ? sqrt ( e_sum2 / skew.count () ) : 0.0 );
+    fprintf ( stderr, "  heading: final %.1f mrad, max %.1f, rms %.1f\n", th * 1000, th_max * 1000, sqrt ( th_sum2 / samples ) * 1000 );
+    return 0;
+}
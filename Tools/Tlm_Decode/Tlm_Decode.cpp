@@ -0,0 +1,344 @@
+/*
+ң빤ߣڵУ
+
+СESP8266͸Ķң(Driver/Telemetry.h)CSV
+	pose.csv  wheel.csv  mission.csv  vision.csv  ack.csv  power.csv
+ʱstderrӡÿϢ֡CRC󡢰ͳƵĶ֡ƽʡ
+-L ʱյʱ̼ȥ֡ʱͳʱӣͷ(Tools/Tlm_Link)Ҫͱͬһ̨ϣʱ䶼 CLOCK_MONOTONIC
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Tlm_Decode Tlm_Decode.cpp ../../Driver/Telemetry.cpp
+
+÷
+	./Tlm_Decode -p 8080 [-o Ŀ¼]      ΪTCPС(ESP8266_Link_TcpServer_IP/Port)
+	./Tlm_Decode -u 8081 [-o Ŀ¼]      UDPң(WIFI_LINK_UDPESP8266_UdpServer_Port)2ûݽ
+	./Tlm_Decode -L ...                 ͳʱ
+	./Tlm_Decode [-o Ŀ¼] < ¼µ
+	./Tlm_Decode -g  >           ̼ķƵģݣڼ͹
+*/
+
+#include "Telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+
+#define DEC_BAUD_BYTES     11520           //115200 8N1 ÿֽ
+#define DEC_ID_NUM         8               //ϢID 1~7OTA(6)ֻCSV
+
+
+static FILE *    Dec_Csv [ DEC_ID_NUM ];
+static uint32_t  Dec_Count [ DEC_ID_NUM ];
+static uint32_t  Dec_Bad, Dec_Lost, Dec_Bytes, Dec_Frames;
+static bool      Dec_HaveSeq;
+static uint16_t  Dec_LastSeq;
+static uint32_t  Dec_FirstTime, Dec_LastTime;
+static uint32_t  Dec_Datagrams;
+static bool      Dec_Latency;
+static std::vector<uint32_t> Dec_Delay;         //ÿ֡ʱ(ms)
+
+
+static uint32_t Dec_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_MONOTONIC, &ts );
+    return (uint32_t)( ts.tv_sec * 1000u + ts.tv_nsec / 1000000 );
+}
+
+
+static void Dec_Open(const char *dir)
+{
+    static const char * name [ DEC_ID_NUM ] = { 0, "pose", "wheel", "mission", "vision", "ack", 0, "power" };
+    static const char * head [ DEC_ID_NUM ] =
+    {
+        0,
+        "time_ms,seq,x_mm,y_mm,theta_mrad,grid_x,grid_y\n",
+        "time_ms,seq,duty0,duty1,duty2,duty3\n",
+        "time_ms,seq,step,dir,state\n",
+        "time_ms,seq,kind,result,x,y\n",
+        "time_ms,seq,cmd_seq,cmd_id,result,echo,latency_us\n",
+        0,
+        "time_ms,seq,bat_mv,scale\n",
+    };
+    char path [ 512 ];
+    int  i;
+
+    for ( i = 1; i < DEC_ID_NUM; i++ )
+    {
+        if ( name [ i ] == 0 )
+            continue;
+        snprintf ( path, sizeof ( path ), "%s/%s.csv", dir, name [ i ] );
+        Dec_Csv [ i ] = fopen ( path, "w" );
+        if ( Dec_Csv [ i ] == 0 )
+        {
+            perror ( path );
+            exit ( 1 );
+        }
+        fputs ( head [ i ], Dec_Csv [ i ] );
+    }
+}
+
+
+static void Dec_Frame(const uint8_t *enc, uint16_t len)
+{
+    uint8_t         raw [ TLM_FRAME_MAX ];
+    const uint8_t * p;
+    uint8_t         plen;
+    uint16_t        n;
+    Tlm_Head        h;
+    Tlm_Pose        pose;
+    Tlm_Wheel       wheel;
+    Tlm_Mission     mission;
+    Tlm_Vision      vision;
+    Tlm_Ack         ack;
+    Tlm_Power       power;
+
+    n = Telemetry::cobs_decode ( enc, len, raw );
+    if ( n == 0 || ! Telemetry::parse ( raw, n, &h, &p, &plen ) || h.id < 1 || h.id >= DEC_ID_NUM )
+    {
+        Dec_Bad ++;
+        return;
+    }
+
+    if ( Dec_HaveSeq )
+        Dec_Lost += (uint16_t)( h.seq - Dec_LastSeq - 1 );
+    else
+        Dec_FirstTime = h.time;
+    Dec_HaveSeq = true;
+    Dec_LastSeq = h.seq;
+    Dec_LastTime = h.time;
+    Dec_Frames ++;
+    Dec_Count [ h.id ] ++;
+    if ( Dec_Latency )
+        Dec_Delay.push_back ( Dec_Now() - h.time );
+
+    switch ( h.id )
+    {
+        case TLM_ID_POSE:
+            if ( Telemetry::get_pose ( p, plen, &pose ) )
+                fprintf ( Dec_Csv [ h.id ], "%u,%u,%d,%d,%d,%d,%d\n", h.time, h.seq,
+                          pose.x_mm, pose.y_mm, pose.theta_mrad, pose.grid_x, pose.grid_y );
+            break;
+        case TLM_ID_WHEEL:
+            if ( Telemetry::get_wheel ( p, plen, &wheel ) )
+                fprintf ( Dec_Csv [ h.id ], "%u,%u,%d,%d,%d,%d\n", h.time, h.seq,
+                          wheel.duty [ 0 ], wheel.duty [ 1 ], wheel.duty [ 2 ], wheel.duty [ 3 ] );
+            break;
+        case TLM_ID_MISSION:
+            if ( Telemetry::get_mission ( p, plen, &mission ) )
+                fprintf ( Dec_Csv [ h.id ], "%u,%u,%u,%u,%u\n", h.time, h.seq,
+                          mission.step, mission.dir, mission.state );
+            break;
+        case TLM_ID_VISION:
+            if ( Telemetry::get_vision ( p, plen, &vision ) )
+                fprintf ( Dec_Csv [ h.id ], "%u,%u,%u,%u,%d,%d\n", h.time, h.seq,
+                          vision.kind, vision.result, vision.x, vision.y );
+            break;
+        case TLM_ID_ACK:
+            if ( Telemetry::get_ack ( p, plen, &ack ) )
+                fprintf ( Dec_Csv [ h.id ], "%u,%u,%u,%u,%u,%u,%u\n", h.time, h.seq,
+                          ack.cmd_seq, ack.cmd_id, ack.result, ack.echo, ack.latency_us );
+            break;
+        case TLM_ID_POWER:
+            if ( Telemetry::get_power ( p, plen, &power ) )
+                fprintf ( Dec_Csv [ h.id ], "%u,%u,%u,%u\n", h.time, h.seq, power.bat_mv, power.scale );
+            break;
+    }
+}
+
+
+static void Dec_Input(const uint8_t *in, ssize_t n)
+{
+    static uint8_t  frame [ TLM_FRAME_MAX ];
+    static uint16_t len = 0;
+    static bool     skip = false;   //̫֡һ0x00
+    ssize_t         i;
+
+    Dec_Bytes += n;
+    for ( i = 0; i < n; i++ )
+    {
+        if ( in [ i ] == 0x00 )
+        {
+            if ( skip )
+                Dec_Bad ++;
+            else if ( len )
+                Dec_Frame ( frame, len );
+            len = 0;
+            skip = false;
+        }
+        else if ( len < sizeof ( frame ) )
+            frame [ len ++ ] = in [ i ];
+        else
+            skip = true;
+    }
+}
+
+
+static void Dec_Stream(int fd)
+{
+    uint8_t in [ 4096 ];
+    ssize_t n;
+
+    while ( ( n = read ( fd, in, sizeof ( in ) ) ) > 0 )
+        Dec_Input ( in, n );
+}
+
+
+static void Dec_Udp(int port)                   //ÿ֡ú֡λ
+{
+    struct sockaddr_in addr;
+    struct timeval     tv = { 2, 0 };
+    uint8_t            in [ 2048 ];
+    ssize_t            n;
+    int                s;
+
+    s = socket ( AF_INET, SOCK_DGRAM, 0 );
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons ( port );
+    addr.sin_addr.s_addr = htonl ( INADDR_ANY );
+    if ( bind ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 )
+    {
+        perror ( "bind" );
+        exit ( 1 );
+    }
+    fprintf ( stderr, "waiting on udp port %d\n", port );
+    while ( ( n = recv ( s, in, sizeof ( in ), 0 ) ) > 0 )
+    {
+        setsockopt ( s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof ( tv ) );     //յһԺżƳʱ
+        Dec_Datagrams ++;
+        Dec_Input ( in, n );
+    }
+    close ( s );
+}
+
+
+static void Dec_Report_Latency(void)
+{
+    size_t n = Dec_Delay.size();
+    double sum = 0;
+    size_t i;
+
+    if ( n == 0 )
+        return;
+    for ( i = 0; i < n; i++ )
+        sum += Dec_Delay [ i ];
+    std::sort ( Dec_Delay.begin(), Dec_Delay.end() );
+    fprintf ( stderr, "latency ms: min %u, avg %.1f, p50 %u, p99 %u, max %u\n", Dec_Delay [ 0 ], sum / n,
+              Dec_Delay [ n / 2 ], Dec_Delay [ n * 99 / 100 ], Dec_Delay [ n - 1 ] );
+}
+
+
+static int Dec_Listen(int port)
+{
+    struct sockaddr_in addr;
+    int s, c, on = 1;
+
+    s = socket ( AF_INET, SOCK_STREAM, 0 );
+    setsockopt ( s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof ( on ) );
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons ( port );
+    addr.sin_addr.s_addr = htonl ( INADDR_ANY );
+    if ( bind ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 || listen ( s, 1 ) < 0 )
+    {
+        perror ( "listen" );
+        exit ( 1 );
+    }
+    fprintf ( stderr, "waiting on port %d\n", port );
+    c = accept ( s, 0, 0 );
+    close ( s );
+    return c;
+}
+
+
+// WiFi_Task Ľ
+static uint16_t Gen_Write(const uint8_t *buf, uint16_t len)
+{
+    fwrite ( buf, 1, len, stdout );
+    return len;
+}
+
+static void Gen_Run(uint32_t seconds)
+{
+    Telemetry   tlm ( Gen_Write );
+    Tlm_Pose    pose = { 0, 0, 0, 0, 0 };
+    Tlm_Wheel   wheel = { { 200, 200, 200, 200 } };
+    Tlm_Mission mission = { 0, 0, 1 };
+    Tlm_Vision  vision = { 2, 1, 160, 120 };
+    Tlm_Power   power = { 7400, 4096 };
+    uint32_t    n, t;
+
+    for ( n = 0; n < seconds * 100; n++ )
+    {
+        t = n * 10;
+        pose.x_mm = t / 5;
+        pose.grid_x = pose.x_mm / 300;
+        tlm.pose ( t, &pose );
+        if ( n % 5 == 0 )
+            tlm.wheel ( t, &wheel );
+        if ( n % 20 == 0 )
+            tlm.mission ( t, &mission );
+        if ( n % 20 == 10 )
+            tlm.vision ( t, &vision );
+        if ( n % 20 == 5 )
+        {
+            power.bat_mv = 7400 - n / 10;           //ŵѹµ
+            power.scale = ( 7400u << 12 ) / power.bat_mv;
+            tlm.power ( t, &power );
+        }
+    }
+    fprintf ( stderr, "%u frames, %u bytes in %u s: %u B/s, %u%% of 115200 baud\n",
+              tlm.sent_frames(), tlm.sent_bytes(), seconds, tlm.sent_bytes() / seconds,
+              tlm.sent_bytes() / seconds * 100 / DEC_BAUD_BYTES );
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char * dir = ".";
+    int          port = 0, udp = 0, fd = 0, opt;
+
+    while ( ( opt = getopt ( argc, argv, "p:u:o:g:L" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'p': port = atoi ( optarg ); break;
+            case 'u': udp = atoi ( optarg ); break;
+            case 'L': Dec_Latency = true; break;
+            case 'o': dir = optarg; break;
+            case 'g': Gen_Run ( atoi ( optarg ) ); return 0;
+            default:
+                fprintf ( stderr, "usage: %s [-p port | -u port] [-L] [-o dir] | -g seconds\n", argv [ 0 ] );
+                return 1;
+        }
+    }
+
+    Dec_Open ( dir );
+    if ( udp )
+        Dec_Udp ( udp );
+    else
+    {
+        if ( port )
+            fd = Dec_Listen ( port );
+        Dec_Stream ( fd );
+    }
+
+    fprintf ( stderr, "%u bytes, %u frames (pose %u, wheel %u, mission %u, vision %u, ack %u, ota %u, power %u), %u bad, %u lost\n",
+              Dec_Bytes, Dec_Frames, Dec_Count [ 1 ], Dec_Count [ 2 ], Dec_Count [ 3 ], Dec_Count [ 4 ], Dec_Count [ 5 ],
+              Dec_Count [ 6 ], Dec_Count [ 7 ], Dec_Bad, Dec_Lost );
+    if ( Dec_LastTime > Dec_FirstTime )
+        fprintf ( stderr, "pose rate %.1f Hz over %.2f s\n",
+                  Dec_Count [ 1 ] * 1000.0 / ( Dec_LastTime - Dec_FirstTime ), ( Dec_LastTime - Dec_FirstTime ) / 1000.0 );
+    if ( udp )
+        fprintf ( stderr, "%u datagrams\n", Dec_Datagrams );
+    Dec_Report_Latency ();
+    return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ң·ģڵУСESP8266
+
+ WiFi_Task ļƻ(λ100Hz/5/20Ӿ/20)ʵʱң֡֡ʱǱ CLOCK_MONOTONIC(ms)
+ͬһ̨ϵ Tools/Tlm_Decode -L ͳƶ˵ʱӺͶ֡Ƚ TCP ͸ UDP(WIFI_LINK_UDP)ַʽ
+	-u  ÿ TLM_FLUSH_DIV һUDPİûˣİӰ
+	-t  ÿһTCPݣĶι -r ش(ӱ)֮ĶζҪͷ
+ʱڱģ⣬ػ
+
+루ڱĿ¼£
+	g++ -O2 -I../../Driver -o Tlm_Link Tlm_Link.cpp ../../Driver/Telemetry.cpp
+
+÷
+	../Tlm_Decode/Tlm_Decode -u 8081 -L -o /tmp &
+	./Tlm_Link -u 127.0.0.1:8081 [-s ] [-l ٷֱ] [-d ʱms]
+	../Tlm_Decode/Tlm_Decode -p 8080 -L -o /tmp &
+	./Tlm_Link -t 127.0.0.1:8080 [-s ] [-l ٷֱ] [-d ʱms] [-r شʱms]
+*/
+
+#include "Telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <deque>
+#include <vector>
+
+
+#define LINK_TICK_US       10000           //WiFi_Task 
+#define LINK_UDP_DIV       2               //ͬ TLM_FLUSH_DIV
+#define LINK_WHEEL_DIV     5
+#define LINK_MISSION_DIV   20
+#define LINK_VISION_DIV    20
+
+
+struct Link_Packet
+{
+    uint64_t             due;              //Զ˵ʱ(us)
+    std::vector<uint8_t> data;
+};
+
+static std::deque<Link_Packet> Link_Queue;
+static std::vector<uint8_t>    Link_Buf;            //ûȥ֡
+static uint32_t Link_Frames, Link_Packets, Link_Lost, Link_Retrans;
+
+
+static uint64_t Link_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static void Link_Sleep_Until(uint64_t us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000u;
+    ts.tv_nsec = ( us % 1000000u ) * 1000;
+    clock_nanosleep ( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0 );
+}
+
+
+static uint16_t Link_Write(const uint8_t *buf, uint16_t len)
+{
+    Link_Buf.insert ( Link_Buf.end(), buf, buf + len );
+    Link_Frames ++;
+    return len;
+}
+
+
+static bool Link_Drop(uint32_t loss)
+{
+    return (uint32_t)( rand() % 100 ) < loss;
+}
+
+
+static int Link_Open(bool udp, const char *target)
+{
+    struct sockaddr_in addr;
+    char   host [ 64 ];
+    const char * colon = strchr ( target, ':' );
+    int    s, on = 1;
+
+    if ( colon == 0 || colon - target >= (int)sizeof ( host ) )
+    {
+        fprintf ( stderr, "bad address %s\n", target );
+        exit ( 1 );
+    }
+    memcpy ( host, target, colon - target );
+    host [ colon - target ] = '\0';
+
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons ( atoi ( colon + 1 ) );
+    inet_pton ( AF_INET, host, &addr.sin_addr );
+    s = socket ( AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0 );
+    if ( ! udp )
+        setsockopt ( s, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+    if ( connect ( s, (struct sockaddr *)&addr, sizeof ( addr ) ) < 0 )
+    {
+        perror ( "connect" );
+        exit ( 1 );
+    }
+    return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char * target = 0;
+    bool         udp = false;
+    uint32_t     seconds = 10, loss = 0, delay_ms = 0, rto_ms = 200;
+    uint64_t     start, next, now, due, last_due = 0, extra, rto;
+    uint32_t     n;
+    int          s, opt;
+
+    Telemetry   tlm ( Link_Write );
+    Tlm_Pose    pose = { 0, 0, 0, 0, 0 };
+    Tlm_Wheel   wheel = { { 200, 200, 200, 200 } };
+    Tlm_Mission mission = { 0, 0, 1 };
+    Tlm_Vision  vision = { 2, 1, 160, 120 };
+
+    while ( ( opt = getopt ( argc, argv, "t:u:s:l:d:r:" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 't': target = optarg; udp = false; break;
+            case 'u': target = optarg; udp = true; break;
+            case 's': seconds = atoi ( optarg ); break;
+            case 'l': loss = atoi ( optarg ); break;
+            case 'd': delay_ms = atoi ( optarg ); break;
+            case 'r': rto_ms = atoi ( optarg ); break;
+            default: target = 0; break;
+        }
+    }
+    if ( target == 0 )
+    {
+        fprintf ( stderr, "usage: %s -t|-u host:port [-s seconds] [-l loss%%] [-d delay_ms] [-r rto_ms]\n", argv [ 0 ] );
+        return 1;
+    }
+
+    s = Link_Open ( udp, target );
+    srand ( 1 );
+    start = next = Link_Now();
+    for ( n = 0; ; )
+    {
+        now = Link_Now();
+        while ( ! Link_Queue.empty() && Link_Queue.front().due <= now )     //ʱİԶ
+        {
+            send ( s, Link_Queue.front().data.data(), Link_Queue.front().data.size(), 0 );
+            Link_Queue.pop_front();
+        }
+
+        if ( n == seconds * 100 )
+        {
+            if ( Link_Queue.empty() )
+                break;
+            Link_Sleep_Until ( Link_Queue.front().due );
+            continue;
+        }
+        if ( now < next )
+        {
+            Link_Sleep_Until ( ( ! Link_Queue.empty() && Link_Queue.front().due < next ) ? Link_Queue.front().due : next );
+            continue;
+        }
+
+        pose.x_mm = n * 2;
+        tlm.pose ( now / 1000, &pose );
+        if ( n % LINK_WHEEL_DIV == 0 )
+            tlm.wheel ( now / 1000, &wheel );
+        if ( n % LINK_MISSION_DIV == 0 )
+            tlm.mission ( now / 1000, &mission );
+        if ( n % LINK_VISION_DIV == LINK_VISION_DIV / 2 )
+            tlm.vision ( now / 1000, &vision );
+        n ++;
+        next += LINK_TICK_US;
+
+        if ( udp && ( n % LINK_UDP_DIV ) )
+            continue;
+
+        Link_Packets ++;
+        due = now + delay_ms * 1000u;
+        if ( udp )
+        {
+            if ( Link_Drop ( loss ) )
+            {
+                Link_Lost ++;
+                Link_Buf.clear();
+                continue;
+            }
+        }
+        else
+        {
+            for ( extra = 0, rto = rto_ms * 1000u; Link_Drop ( loss ); rto *= 2 )   //شֱ͵
+            {
+                extra += rto;
+                Link_Retrans ++;
+            }
+            due += extra;
+            if ( due < last_due )                               //ǰĶûյҲȥ
+                due = last_due;
+            last_due = due;
+        }
+        Link_Queue.push_back ( Link_Packet() );
+        Link_Queue.back().due = due;
+        Link_Queue.back().data.swap ( Link_Buf );
+    }
+    close ( s );
+
+    fprintf ( stderr, "%s: %u frames in %u packets over %.1f s, %u packets lost, %u retransmissions\n",
+              udp ? "udp" : "tcp", Link_Frames, Link_Packets, ( Link_Now() - start ) / 1e6, Link_Lost, Link_Retrans );
+    return 0;
+}
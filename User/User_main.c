@@ -9,9 +9,17 @@ typedef enum
     Left=2,
     Right=3,    
     Stop =4,
+    UpLeft=5,       //бߣķ
+    UpRight=6,
+    BackLeft=7,
+    BackRight=8,
+    Free=9,         //ңظ⳵ٶȣ
 }
 Diretion;
 
+static void Car_Move(Diretion dir);     //ĸ
+static void Dir_Step(Diretion dir,int8_t *dx,int8_t *dy);     //x()y(ǰ)ϵķ
+
 
 
 //ƿ
@@ -22,9 +30,21 @@ OS_TCB  Run_TCB;      //
 OS_TCB  LED_Twinkle_TCB;   //LED˸ʱ
 OS_TCB Position_TCB;        //жλü䷽
 OS_TCB  TaskTurn_TCB;       //˳ִ
+OS_TCB  WiFi_TCB;           //ͨ(ң)
+OS_TCB  WiFi_Sup_TCB;       //·
+OS_TCB  Remote_TCB;         //ңָ
+OS_TCB  Ctrl_TCB;           //
+OS_TCB  Ota_TCB;            //OTA
 
 
 static int8_t Pos_x ,Pos_y;     //λ
+static uint8_t doTask_Turn;     //˳
+static uint8_t Mission_Run;     //Key2񡢻ûн
+static uint16_t Correct_Move_Time = Correct_Move_Time_Default;
+
+//ͷʶʶɺTaskTurnи£ңⷢ
+static uint8_t Vision_Kind,Vision_Result;
+static int16_t Vision_X,Vision_Y;
 
 //ǰʻ
 Diretion  Car_Dir;
@@ -32,9 +52,12 @@ Diretion  Car_Dir;
 
 
 
+#if SENSOR_SIGNAL_QUEUE
 //ڴ
 OS_MEM   mem;
 uint8_t ucArray [ 70 ] [ 4 ];   //ڴС
+#endif
+OS_FLAG_GRP Sensor_Flags;       //ѹ¼TIM7жλPosition ȡ
 
 
 
@@ -50,12 +73,18 @@ void User_main()
                         (OS_ERR       *)&err );               //ش
 
 
+#if SENSOR_SIGNAL_QUEUE
     OSMemCreate ((OS_MEM      *)&mem,             //ָڴ
                  (CPU_CHAR    *)"Mem",   //ڴ
                  (void        *)ucArray,          //ڴ׵ַ
                  (OS_MEM_QTY   )70,               //ڴڴĿ
                  (OS_MEM_SIZE  )4,                //ڴֽĿ
                  (OS_ERR      *)&err);            //ش    
+#endif
+    OSFlagCreate ((OS_FLAG_GRP  *)&Sensor_Flags,     //ѹߣn-1λΪn
+                  (CPU_CHAR     *)"Sensor",
+                  (OS_FLAGS      )0,
+                  (OS_ERR       *)&err);
     
     
     
@@ -82,7 +111,7 @@ void User_main()
                  (CPU_STK    *)&USART1_Get_STK[0],             //ջĻַ
                  (CPU_STK_SIZE) USART1_Get_STK_SIZE / 10,   //ջռʣ1/10ʱ
                  (CPU_STK_SIZE) USART1_Get_STK_SIZE,        //Ķջռ䣨λsize(CPU_STK)
-                 (OS_MSG_QTY  ) 2u,                             //ɽܵϢ
+                 (OS_MSG_QTY  ) 8u,                             //DMAʱһжϻᷢΣ
                  (OS_TICK     ) 0u,                             //ʱƬĬֵ0ʾ OS_CFG_TICK_RATE_HZ/10  10ms 
                  (void       *) 0,                              //չ0ʾչ
                  (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),     //ѡ
@@ -102,9 +131,23 @@ void User_main()
                  (void       *) 0,                              //չ0ʾչ
                  (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),     //ѡ
                  (OS_ERR     *)&err);                           //ش 
+    Debounce_Init();            //Sensor_Flags ٿTIM7֮ǰıز
     
     OSTaskCreate(&TaskTurn_TCB,"˳ִ",TaskTurn,0,TaskTurn_PRIO,&TaskTurn_STK[0],TaskTurn_STK_SIZE/10,TaskTurn_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
 
+    OSTaskCreate(&Ctrl_TCB,"",Ctrl_Task,0,Ctrl_PRIO,&Ctrl_STK[0],Ctrl_STK_SIZE/10,Ctrl_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
+    Ctrl_Timer_Init();
+
+    Ota_Init();
+    Remote_Init();
+    OSTaskCreate(&Remote_TCB,"ңָ",Remote_Task,0,Remote_PRIO,&Remote_STK[0],Remote_STK_SIZE/10,Remote_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
+
+    OSTaskCreate(&WiFi_TCB,"ͨ",WiFi_Task,0,WiFi_PRIO,&WiFi_STK[0],WiFi_STK_SIZE/10,WiFi_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
+
+    OSTaskCreate(&WiFi_Sup_TCB,"·",WiFi_Sup_Task,0,WiFi_Sup_PRIO,&WiFi_Sup_STK[0],WiFi_Sup_STK_SIZE/10,WiFi_Sup_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
+
+    OSTaskCreate(&Ota_TCB,"OTA",Ota_Task,0,Ota_PRIO,&Ota_STK[0],Ota_STK_SIZE/10,Ota_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
+
                  
 }
 
@@ -115,7 +158,18 @@ static void  Key1_Scan(void *p_arg)
 	OS_ERR         err;
 	CPU_INT16U     version;
 	CPU_INT32U     cpu_clk_freq;
-	CPU_SR_ALLOC();
+	uint32_t       rmt_frames, rmt_dups, rmt_lost, rmt_bad, rmt_latency;
+	Tlm_Client     client;
+	WiFi_Link      link;
+	Car_Pose       pose;
+	Ctrl_Stat_T    ctrl;
+	uint32_t       motor_oc, motor_stall;
+	uint16_t       bat_mv, bat_scale;
+	Line_Stat      line;
+	uint32_t       deb_acc, deb_glitch, deb_bounce;
+	uint32_t       isr_n, isr_max, isr_avg;
+	static const char * const deb_name[DEB_LINE_NUM] = { "Key1", "Key2", "ǰ", "", "", "" };
+	uint8_t        i;
 
 	
 	(void)p_arg;
@@ -134,8 +188,6 @@ static void  Key1_Scan(void *p_arg)
                      (OS_ERR   *)&err);                 //ش
 		
 
-		OS_CRITICAL_ENTER();                              //ٽΣ⴮ڴӡ
-
         printf ( "\r\nuC/OS汾ţV%d.%02d.%02d\r\n",
              version / 10000, version % 10000 / 100, version % 100 );
 
@@ -148,9 +200,59 @@ static void  Key1_Scan(void *p_arg)
         printf ( "CPUʹʣ%d.%d%%\r\n", 
                  OSStatTaskCPUUsageMax / 100, OSStatTaskCPUUsageMax % 100 );
 
+        printf ( "ڶֽڣ%u\r\n", log_drop_count() );       //printfDMAͣʱ
 
-		
-		OS_CRITICAL_EXIT();                              
+        printf ( "ңⶪ֡%u\r\n", Tlm_Drop_Count() );
+
+        Remote_Stat ( &rmt_frames, &rmt_dups, &rmt_lost, &rmt_bad, &rmt_latency );
+        printf ( "ңָ%u ֡ط %uʧ %u %uЧʱ %uus\r\n",
+                 rmt_frames, rmt_dups, rmt_lost, rmt_bad, rmt_latency );
+
+        for ( i = 0; i < TLM_CLIENT_NUM; i++ )                    //ģʽ¸ͻ
+        {
+            if ( Tlm_Client_Stat ( i, &client ) )
+                printf ( "ͻ%d 0x%02X%u ֡ %u ֽ %u B/s %u ֡ʧ %uѹ %d ֽ\r\n",
+                         i, client.topics, client.frames, client.bytes, client.rate, client.drops, client.fails, client.queued_max );
+        }
+
+        printf ( "OTA%s %u ֡\r\n", Ota_Busy() ? "" : "", Ota_Ring_Drops() );
+        printf ( "PWM%u Hzһ %d \r\n", PWM_Freq(0), PWM_Steps() );
+        printf ( "ٳ޵ȱС%u \r\n", Move_Sat_Count() );
+        Motor_Trips ( &motor_oc, &motor_stall );
+        printf ( "%d %d %d %d %d %d %d %dͣ %u Σתͣ %u \r\n",
+                 Adc_Value(0), Adc_Value(1), Adc_Value(2), Adc_Value(3),
+                 Adc_Peak(0), Adc_Peak(1), Adc_Peak(2), Adc_Peak(3), motor_oc, motor_stall );
+        Adc_Peak_Clear ();
+        Bat_Get ( &bat_mv, &bat_scale );
+        printf ( "أ%d mVռձȲ %d.%03d \r\n", bat_mv, bat_scale >> 12, ( bat_scale & 4095 ) * 1000 >> 12 );
+        Odom_Get ( &pose );
+        printf ( "̼ƣx %dmm y %dmm  %dmrad %d %d %d %d mm/sҺ %u \r\n",
+                 pose.x_mm, pose.y_mm, pose.theta_mrad, pose.wheel[0], pose.wheel[1], pose.wheel[2], pose.wheel[3], Odom_Exti_Errors() );
+        Line_Get ( &line );
+        printf ( "Ѳߣѹ %u %u %u %u Σ %d %d %d %d mm/sǰ %dus(%u )Ҳ %dus(%u ) %u\r\n",
+                 line.edges[0], line.edges[1], line.edges[2], line.edges[3],
+                 line.speed[0], line.speed[1], line.speed[2], line.speed[3],
+                 line.dt_fb_us, line.pairs_fb, line.dt_lr_us, line.pairs_lr, line.drops );
+        for ( i = 0; i < DEB_LINE_NUM; i++ )
+        {
+            Debounce_Get ( i, &deb_acc, &deb_glitch, &deb_bounce );
+            printf ( " %s %u Σë %u %u\r\n", deb_name[i], deb_acc, deb_glitch, deb_bounce );
+        }
+        Isr_Time_Get ( ISR_TIME_EDGE, &isr_n, &isr_max, &isr_avg );
+        printf ( "ⲿжϣ%u Σ %uns ƽ %uns\r\n", isr_n, isr_max, isr_avg );
+        Isr_Time_Get ( ISR_TIME_SIGNAL, &isr_n, &isr_max, &isr_avg );
+        printf ( "֪ͨ(%s)%u ΣTIM7ж  %uns ƽ %uns\r\n",
+                 SENSOR_SIGNAL_QUEUE ? "ڴ+Ϣ" : "¼־", isr_n, isr_max, isr_avg );
+        printf ( "б %dmrad %u ΣҪ %u Σ w %d\r\n", line.skew_mrad, line.skew_n, line.skew_rejects, line.skew_w );
+        Ctrl_Stat ( &ctrl );                                      //ϴΰ
+        printf ( "%u ڣʱ %u %d~%d ƽ %dnsӦ  %u ƽ %unsִ %u~%u ƽ %uns\r\n",
+                 ctrl.cycles, ctrl.overruns, ctrl.jitter_min, ctrl.jitter_max, ctrl.jitter_avg,
+                 ctrl.latency_max, ctrl.latency_avg, ctrl.exec_min, ctrl.exec_max, ctrl.exec_avg );
+
+        WiFi_Link_Stat ( &link );
+        printf ( "·%s %u sۼ %u sϿ %u Σ %u/%u Σָʱ  %ums  %ums ƽ %ums\r\n",
+                 link.up ? "" : "Ͽ", link.uptime_ms / 1000, link.up_total_ms / 1000, link.downs,
+                 link.reconnects, link.attempts, link.recover_last_ms, link.recover_max_ms, link.recover_avg_ms );
 		
 	}
       
@@ -162,7 +264,6 @@ static void    USART1_Get(void *p_arg)
 {
 	OS_ERR         err;
 	OS_MSG_SIZE    msg_size;
-	CPU_SR_ALLOC();
 	
 	char * pMsg;
 
@@ -171,23 +272,14 @@ static void    USART1_Get(void *p_arg)
 
 					 
 	while (DEF_TRUE) {                                           //
-		/* 񣬵ȴϢ */
+		/* 񣬵ȴжϽһݣָDMAջ黹 */
 		pMsg = OSTaskQPend ((OS_TICK        )0,                    //޵ȴ
                           (OS_OPT         )OS_OPT_PEND_BLOCKING, //ûϢ
                           (OS_MSG_SIZE   *)&msg_size,            //Ϣ
                           (CPU_TS        *)0,                    //Ϣʱ
                           (OS_ERR        *)&err);                //ش
 
-		OS_CRITICAL_ENTER();                                       //ٽΣ⴮ڴӡ
-
-		printf ( "%c", * pMsg );                                   //ӡϢ
-
-		OS_CRITICAL_EXIT();                                        //˳ٽ
-		
-		/* ˻ڴ */
-		OSMemPut (  (OS_MEM  *)&mem,                                 //ָڴ
-                    (void    *)pMsg,                                 //ڴ׵ַ
-                    (OS_ERR  *)&err);		                          //ش		
+		log_write ( pMsg, msg_size );                              //ԭԣ
 	}       
 }
 
@@ -205,7 +297,11 @@ static void  Key2_Scan(void *p_arg)
                      (CPU_TS   *)0,                     //ȡźʱ
                      (OS_ERR   *)&err);                 //ش 
         Car_Dir=UP;
+        Mission_Run=1;
         OSTaskCreate(&Run_TCB,"",Run,0,Run_PRIO,&Run_STK[0],Run_STK_SIZE/10,Run_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err);    
+#if !SENSOR_SIGNAL_QUEUE
+        OSFlagPost(&Sensor_Flags,SENSOR_FLAG_ALL,OS_OPT_POST_FLAG_CLR,&err);      //ϴɾʱûȡߵĲ㣬ͬǰɾϢ
+#endif
         OSTaskCreate(&Position_TCB,"ж",Position,0,Position_PRIO,&Position_STK[0],Position_STK_SIZE/10,Position_STK_SIZE,2,0,0,(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),&err); 
         Move_Up();        
        
@@ -221,6 +317,7 @@ static void  Key2_Scan(void *p_arg)
        OSTaskDel(&Position_TCB,&err);           //ɾжϷλ
        Move_Stop();
        Car_Dir=Stop;
+       Mission_Run=0;
 
     }
 }
@@ -233,15 +330,45 @@ static void Run(void* p_arg)
     while(1)
     {
     OSTaskSemPend(0,OS_OPT_PEND_BLOCKING,NULL,&err);
-        switch(Car_Dir)
+        Car_Move(Car_Dir);
+    }       
+}
+
+
+static void Car_Move(Diretion dir)
+{
+        switch(dir)
         {
             case UP : Move_Up(); break;
             case Back : Move_Back(); break;
             case Left:  Move_Left(); break;
             case Right : Move_Right(); break;
             case Stop :  Move_Stop(); break;
+            case UpLeft :    Move_Diag(-1,1); break;
+            case UpRight :   Move_Diag(1,1); break;
+            case BackLeft :  Move_Diag(-1,-1); break;
+            case BackRight : Move_Diag(1,-1); break;
+            case Free : break;
         }    
-    }       
+}
+
+
+static void Dir_Step(Diretion dir,int8_t *dx,int8_t *dy)
+{
+    *dx=0;
+    *dy=0;
+    switch(dir)
+    {
+        case UP : *dy=1; break;
+        case Back : *dy=-1; break;
+        case Left : *dx=-1; break;
+        case Right : *dx=1; break;
+        case UpLeft : *dx=-1; *dy=1; break;
+        case UpRight : *dx=1; *dy=1; break;
+        case BackLeft : *dx=-1; *dy=-1; break;
+        case BackRight : *dx=1; *dy=-1; break;
+        default : break;
+    }
 }
 
 
@@ -267,95 +394,309 @@ static void Position(void* p_arg)
 {
   	OS_ERR     err;
      static uint8_t Flag_x,Flag_y;       //̵xy    
+#if SENSOR_SIGNAL_QUEUE
 	char * pMsg;    
+#endif
+    OS_FLAGS flags;
+    uint8_t id;
+    int8_t dx,dy;
     (void) p_arg;
     
     while(1)
     {
+#if SENSOR_SIGNAL_QUEUE
 		pMsg = OSTaskQPend ((OS_TICK        )0,                    //޵ȴ
                           (OS_OPT         )OS_OPT_PEND_BLOCKING, //ûϢ
                           (OS_MSG_SIZE   *)NULL,            //Ϣ
                           (CPU_TS        *)0,                    //Ϣʱ
                           (OS_ERR        *)&err);                //ش     
-        switch (*pMsg)
+        flags = SENSOR_FLAG(*pMsg);
+		OSMemPut (  (OS_MEM  *)&mem,                                 //ָڴ
+                    (void    *)pMsg,                                 //ڴ׵ַ
+                    (OS_ERR  *)&err);		                          //ش	        
+#else
+        flags = OSFlagPend ((OS_FLAG_GRP  *)&Sensor_Flags,
+                            (OS_FLAGS      )SENSOR_FLAG_ALL,
+                            (OS_TICK       )0,                    //޵ȴ
+                            (OS_OPT        )(OS_OPT_PEND_FLAG_SET_ANY + OS_OPT_PEND_FLAG_CONSUME + OS_OPT_PEND_BLOCKING),   //ĸУȡ߾
+                            (CPU_TS       *)0,
+                            (OS_ERR       *)&err);               //λϴȡѹߵĴ
+#endif
+        Line_Drain();                   //ѹʱжѾ£ֻ
+        
+        for(id=1;id<=4;id++)            //һмһһ
         {
-            case 1:         //ǰ 
+            if(!(flags&SENSOR_FLAG(id)))
+                continue;
+            switch (id)
             {
-                Flag_x++;
-                break;
+                case 1:         //ǰ 
+                {
+                    Flag_x++;
+                    break;
+                }
+                case 2:         //󴫸
+                {
+                    Flag_x++;               
+                    break; 
+                }                
+                case 3:         //󴫸
+                {
+                    Flag_y++;                              
+                    break;
+                }
+                case 4:         //Ҵ
+                {
+                    Flag_y++;                              
+                    break;
+                }
+                default :
+                    break;
             }
-            case 2:         //󴫸
-            {
-                Flag_x++;               
-                break; 
-            }                
-            case 3:         //󴫸
+            
+            Dir_Step(Car_Dir,&dx,&dy);      //бʱߡ߶ѹԼ
+            if(Flag_y==2)
             {
-                Flag_y++;                              
-                break;
+                Pos_y+=dy;
+                Flag_y=0;
+                if(dx==0)                   //ֱʱһļ󴥷һбʱ
+                    Flag_x=0;
             }
-            case 4:         //Ҵ
+            
+            
+            if(Flag_x==2)
             {
-                Flag_y++;                              
-                break;
+                Pos_x+=dx;
+                Flag_x=0;
+                if(dy==0)
+                    Flag_y=0;
             }
-            default :
-                break;
         }
-        
-        if(Flag_y==2)
-        {
-        switch(Car_Dir)
+    }
+    
+}
+
+
+
+
+
+
+
+static void WiFi_Task(void* p_arg)
+{
+    OS_ERR     err;
+    uint32_t   n;
+    Car_Pose   pose;
+    (void) p_arg;
+
+    for ( n = 0; ; n++ )                                   //֮ǰ(WiFi_Init ڼ)ͶϿڼңֱӶճ
+    {
+        OSTimeDly ( OSCfg_TickRate_Hz / TLM_POSE_HZ, OS_OPT_TIME_PERIODIC, &err );     //ʱͼִʱƯ
+
+        Odom_Get ( &pose );
+        Tlm_Send_Pose ( pose.x_mm, pose.y_mm, pose.theta_mrad, Pos_x, Pos_y );
+        if ( n % TLM_WHEEL_DIV == 0 )
+            Tlm_Send_Wheel ();
+        if ( n % TLM_MISSION_DIV == 0 )
+            Tlm_Send_Mission ( doTask_Turn, Car_Dir, Car_Dir != Stop );
+        if ( n % TLM_VISION_DIV == TLM_VISION_DIV / 2 )    //
+            Tlm_Send_Vision ( Vision_Kind, Vision_Result, Vision_X, Vision_Y );
+        if ( n % TLM_POWER_DIV == TLM_POWER_DIV / 4 )
+            Tlm_Send_Power ();
+        Tlm_Flush ();                                      //UDPģʽܹ TLM_FLUSH_DIV ڵ֡һģʽģоͷһͻ˵Ķ
+    }
+}
+
+
+
+
+
+//·ȵҪ룬ȼͨͿ񲻵
+//ʱÿѯһ״̬(һ AT+CIPSTATUS)˰˱ܼ
+static void WiFi_Sup_Task(void* p_arg)
+{
+    OS_ERR     err;
+    uint32_t   wait;
+    (void) p_arg;
+
+    WiFi_Init();            //ȵ͵ԣԼȵȿͻ
+
+    while(1)
+    {
+        wait = WiFi_Supervise ();
+        if ( wait )
+            OSTimeDly ( wait * OSCfg_TickRate_Hz / 1000u + 1, OS_OPT_TIME_DLY, &err );
+    }
+}
+
+
+
+
+
+//OTA³дW25Q64ݴȼͣдflashʱң⡢ңճ
+//ύҪλʱ Ota_Run() ︴λ³򿽵ڲflash
+static void Ota_Task(void* p_arg)
+{
+    (void) p_arg;
+
+    while(1)
+        Ota_Run ();
+}
+
+
+
+
+
+//ƣTIM6ÿ 1/CTRL_HZ 뷢һźȼߣ̼ƺбдPWMﰴ̶
+//ÿڵĶӦִʱ Ctrl_Begin()/Ctrl_End() ͳƣKey1ӡ
+static void Ctrl_Task(void* p_arg)
+{
+    OS_ERR      err;
+    (void) p_arg;
+
+    while(1)
+    {
+        OSTaskSemPend(0,OS_OPT_PEND_BLOCKING,0,&err);       //TIM6ж
+        Ctrl_Begin();
+        Odom_Tick();                //ȶٰбдPWM
+        Skew_Tick();
+        Bat_Tick();
+        Move_Ramp_Tick();
+        Ctrl_End();
+    }
+}
+
+
+
+//ңأָUSART3ж󾭶лѱȼڿ(衢λͬ)Чʱж˳ļʮ΢
+//ӦֻŽ񷢳ģ飻㶯ڼһֱûµĵ㶯ָֹͣߺһֱ
+static void Remote_Task(void* p_arg)
+{
+    OS_ERR      err;
+    Remote_Msg  msg;
+    uint8_t     res;
+    OS_TICK     jog_end = 0, left;
+    uint8_t     jogging = 0;
+    uint32_t    wait;
+    (void) p_arg;
+
+    while(1)
+    {
+        wait = 0;
+        if ( jogging )
         {
-            case UP : Pos_y++; break;
-            case Back : Pos_y--; break;
-            case Left:  
-            case Right :
-            case Stop: break;
-        }    
-            
-            Flag_y=0;
-            Flag_x=0;
+            left = jog_end - OSTimeGet ( &err );
+            if ( ( left == 0 ) || ( left >= 0x80000000u ) )     //㶯ʱ䵽
+            {
+                Move_Stop();
+                Car_Dir = Stop;
+                jogging = 0;
+            }
+            else
+                wait = left * 1000u / OSCfg_TickRate_Hz + 1;
         }
-        
-        
-        if(Flag_x==2)
+        if ( ! Remote_Get ( &msg, wait ) )
+            continue;
+
+        if ( msg.dup )
         {
-        switch(Car_Dir)
+            Remote_Ack ( &msg, RMT_RES_DUP );
+            continue;
+        }
+
+        res = RMT_RES_OK;
+        switch ( msg.kind )
         {
+            case RMT_JOG:
+                if ( Mission_Run || Ota_Busy() )
+                    res = RMT_RES_BUSY;
+                else if ( ( msg.arg > BackRight ) || ( msg.value <= 0 ) || ( msg.value > RMT_JOG_MAX_MS ) )
+                    res = RMT_RES_BAD_ARG;
+                else
+                {
+                    Car_Dir = (Diretion) msg.arg;
+                    Car_Move ( Car_Dir );
+                    jog_end = OSTimeGet ( &err ) + (OS_TICK) msg.value * OSCfg_TickRate_Hz / 1000u;
+                    jogging = ( Car_Dir != Stop );
+                }
+                break;
 
-            case Left:   Pos_x--; break;
-            case Right : Pos_x++; break;
-            case UP :  
-            case Back :  
-            case Stop: break;
-        }    
-            
-            Flag_y=0;
-            Flag_x=0;
+            case RMT_VEL:                              //ͬ㶯ٶ⣬ԭת
+                if ( Mission_Run || Ota_Busy() )
+                    res = RMT_RES_BUSY;
+                else if ( ( msg.value <= 0 ) || ( msg.value > RMT_JOG_MAX_MS ) )
+                    res = RMT_RES_BAD_ARG;
+                else
+                {
+                    Move_Vel ( msg.vel[0], msg.vel[1], msg.vel[2] );
+                    jogging = ( msg.vel[0] || msg.vel[1] || msg.vel[2] );
+                    Car_Dir = jogging ? Free : Stop;
+                    jog_end = OSTimeGet ( &err ) + (OS_TICK) msg.value * OSCfg_TickRate_Hz / 1000u;
+                }
+                break;
+
+            case RMT_STOP:
+                Move_Stop();
+                Car_Dir = Stop;
+                jogging = 0;
+                if ( Mission_Run )
+                {
+                    Mission_Run = 0;                   //Key2 ȼͣͣ
+                    OSTaskSemPost ( &Key2_Scan_TCB, OS_OPT_POST_NONE, &err );
+                }
+                break;
+
+            case RMT_MISSION:
+                if ( Mission_Run || jogging || Ota_Busy() )
+                    res = RMT_RES_BUSY;
+                else if ( msg.arg > 11 )
+                    res = RMT_RES_BAD_ARG;
+                else
+                {
+                    doTask_Turn = msg.arg;
+                    Mission_Run = 1;
+                    OSTaskSemPost ( &Key2_Scan_TCB, OS_OPT_POST_NONE, &err );     //ͬKey2
+                }
+                break;
+
+            case RMT_PARAM:
+                if ( ( msg.arg == RMT_PARAM_MOVE_SPEED ) && ( msg.value >= 0 ) && ( msg.value <= 1000 ) )
+                {
+                    Move_Speed = msg.value;
+                    if ( jogging )
+                        Car_Move ( Car_Dir );          //㶯ٶ
+                }
+                else if ( ( msg.arg == RMT_PARAM_CORRECT_TIME ) && ( msg.value >= 0 ) && ( msg.value <= 5000 ) )
+                    Correct_Move_Time = msg.value;
+                else if ( ( msg.arg == RMT_PARAM_RAMP_ACC ) && ( msg.value >= 0 ) && ( msg.value <= 1000000 ) )
+                    Move_Ramp ( msg.value, Move_Jerk );
+                else if ( ( msg.arg == RMT_PARAM_RAMP_JERK ) && ( msg.value >= 0 ) && ( msg.value <= 10000000 ) )
+                    Move_Ramp ( Move_Acc, msg.value );
+                else
+                    res = RMT_RES_BAD_ARG;
+                break;
+
+            case RMT_PING:
+            case RMT_SUB:
+                break;
+
+            default:
+                res = RMT_RES_UNKNOWN;
+                break;
         }
-        
-             
-		OSMemPut (  (OS_MEM  *)&mem,                                 //ָڴ
-                    (void    *)pMsg,                                 //ڴ׵ַ
-                    (OS_ERR  *)&err);		                          //ش	        
-             
+        Remote_Ack ( &msg, res );
     }
-    
 }
 
 
 
 
 
-
-
 static void TaskTurn(void* p_arg)
 {
     
    	OS_ERR     err; 
     static  uint8_t Task_3_7_Time ;
-    static uint8_t doTask_Turn;     //˳
     (void) p_arg;   
     
     while(1)
@@ -400,8 +741,10 @@ static void TaskTurn(void* p_arg)
                     //..............
                     Car_Dir=Stop;
                     OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);   
-                    //еץȡ
-                    //..............
+                    //еץȡſºɲͬʱнߣ̧·
+                    while(!Arm_Start(ARM_SEQ_PICK))     //һ(λձ)û꣬ٿʼ
+                        Arm_Wait(ARM_STEP_ALL);
+                    Arm_Wait(ARM_PICK_GRIPPED);
                      Car_Dir=Left;     
                     OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);         
                     doTask_Turn++;                        
@@ -415,7 +758,7 @@ static void TaskTurn(void* p_arg)
             {
                 if(Pos_x==3)
                     {
-                    Car_Dir=UP;
+                    Car_Dir=UpRight;        //бŵ(4,2)ƽƣϺһ
                     doTask_Turn++;
                     OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);   
                     }    
@@ -443,8 +786,10 @@ static void TaskTurn(void* p_arg)
 //                  {
 //                    Car_Dir=Stop;      //ֹͣ
 //                    OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);  
-//                    //
-//                    //......
+//                    //ɿߣձ·
+//                    while(!Arm_Start(ARM_SEQ_PLACE))    //һ(ץȡ̧)û꣬ٿʼ
+//                        Arm_Wait(ARM_STEP_ALL);
+//                    Arm_Wait(ARM_PLACE_RELEASED);
 //                    Car_Dir=Right;      //ʻ
 //                    OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);  
 //                    doTask_Turn++;                    
@@ -530,12 +875,9 @@ static void TaskTurn(void* p_arg)
             {
                 if(Pos_x==1)
                     {
-                    Car_Dir=Left;
+                    Car_Dir=BackLeft;       //ͬ Correct_Move_TimeбֻҪ2
                     OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err); 
-                    OSTimeDly(Correct_Move_Time,OS_OPT_TIME_DLY,&err);
-                    Car_Dir=Back;
-                    OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);  
-                    OSTimeDly(Correct_Move_Time,OS_OPT_TIME_DLY,&err);
+                    OSTimeDly((uint32_t)Correct_Move_Time*362u/256u,OS_OPT_TIME_DLY,&err);
                     Car_Dir=Stop;
                     OSTaskSemPost(&Run_TCB,OS_OPT_POST_NONE,&err);  
                     doTask_Turn++; 
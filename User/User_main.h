@@ -5,16 +5,21 @@
 #include "config.h"
 
 
+#if SENSOR_SIGNAL_QUEUE
 extern OS_MEM   mem;
 extern uint8_t ucArray [ 70 ] [ 4 ];   //ڴС
-#define Correct_Move_Time  500  //õʱ䣨˶ģλms
+#endif
+extern OS_FLAG_GRP Sensor_Flags;       //ѹ¼Position һȡλ
+#define SENSOR_FLAG(id)     ((OS_FLAGS)1u<<((id)-1))      // 1~4ǰ   
+#define SENSOR_FLAG_ALL     0x0Fu
+#define Correct_Move_Time_Default  500  //õʱ䣨˶ģλmsң޸
 
 
 //Key1 
 extern  OS_TCB   Key1_Scan_TCB;
 static void    Key1_Scan(void *p_arg);
 #define  Key1_Scan_PRIO  3
-#define  Key1_Scan_STK_SIZE 64
+#define  Key1_Scan_STK_SIZE 256       //ӡͳʱֲٶֽڣټ printf ջ
 static CPU_STK   Key1_Scan_STK[Key1_Scan_STK_SIZE];  
 
 
@@ -23,7 +28,7 @@ extern  OS_TCB  USART1_Get_TCB;
 static void    USART1_Get(void *p_arg);
 #define  USART1_Get_PRIO  4
 #define  USART1_Get_STK_SIZE 64
-static CPU_STK   USART1_Get_STK[Key1_Scan_STK_SIZE];  
+static CPU_STK   USART1_Get_STK[USART1_Get_STK_SIZE];  
 
 
 //Key2 
@@ -65,6 +70,51 @@ static CPU_STK   TaskTurn_STK[TaskTurn_STK_SIZE];
 
 
 
+//ͨ(ң)
+extern OS_TCB  WiFi_TCB;    
+static void WiFi_Task(void* p_arg);
+#define  WiFi_PRIO  5
+#define  WiFi_STK_SIZE 256
+static CPU_STK   WiFi_STK[WiFi_STK_SIZE];  
+
+
+
+//·飬ȼͨŵͣȵ㡢ļֻڵ
+extern OS_TCB  WiFi_Sup_TCB;    
+static void WiFi_Sup_Task(void* p_arg);
+#define  WiFi_Sup_PRIO  6
+#define  WiFi_Sup_STK_SIZE 256
+static CPU_STK   WiFi_Sup_STK[WiFi_Sup_STK_SIZE];  
+
+
+
+//OTA飬ȼͣдW25Q64
+extern OS_TCB  Ota_TCB;    
+static void Ota_Task(void* p_arg);
+#define  Ota_PRIO  7
+#define  Ota_STK_SIZE 256
+static CPU_STK   Ota_STK[Ota_STK_SIZE];  
+
+
+
+//飬ȼߣTIM6ÿ 1/CTRL_HZ 봥б¡̼ơдPWM
+extern OS_TCB  Ctrl_TCB;    
+static void Ctrl_Task(void* p_arg);
+#define  Ctrl_PRIO  1
+#define  Ctrl_STK_SIZE 128
+static CPU_STK   Ctrl_STK[Ctrl_STK_SIZE];  
+
+
+
+//ңָ飬ڿָõ
+extern OS_TCB  Remote_TCB;    
+static void Remote_Task(void* p_arg);
+#define  Remote_PRIO  2
+#define  Remote_STK_SIZE 128
+static CPU_STK   Remote_STK[Remote_STK_SIZE];  
+
+
+
 //е
 void User_main(void);
 
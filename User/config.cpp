@@ -9,12 +9,25 @@
 #include "tim.h"
 #include "dac.h"
 #include "spi.h"
-#include "PID.h"
 #include "flash.h"
 #include "ILI9341_LCD.h"
 #include "OV7725.h"
 #include "ESP8266.h"
 #include "W25Q64.h"
+#include "Telemetry.h"
+#include "Remote.h"
+#include "Tlm_Fanout.h"
+#include "Link_Sup.h"
+#include "Ota.h"
+#include "Mecanum.h"
+#include "Ramp.h"
+#include "Odometry.h"
+#include "Adc_Watch.h"
+#include "Servo.h"
+#include "Line_Timing.h"
+#include "Skew_Est.h"
+#include "Debounce.h"
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -22,6 +35,7 @@ extern "C"
 #include "system.h"
 #include "stm32f10x_it.h"
 #include "stm32f10x.h"                  // Device header
+#include <includes.h>
 };
 #endif
 
@@ -83,17 +97,37 @@ void LED2_Toggle()
 }
 
 
-    
+
+uint8_t USART1_RX_Buf[USART1_RX_BUF_SIZE];      //USART1 DMAջ
+
 void Uart_Init()
 {
- 
+
     GPIO Tx(GPIOA,GPIO_Pin_9);
     GPIO Rx(GPIOA,GPIO_Pin_10);
     UART uart1(&Rx,&Tx);
     uart1.inti_mode(115200,USART_WordLength_8b,USART_StopBits_1,USART_Parity_No,USART_Mode_ALL,USART_HardwareFlowControl_None);
-    uart1.inti_it_turn(1,0,ENABLE,USART_IT_RXNE);
-    
-}    
+    uart1.inti_it_turn(1,0,ENABLE,USART_IT_IDLE);      //ֻжϣDMA
+
+    //USART1_RX Ӧ DMA1ͨ5ѭģʽд USART1_RX_Buf
+    DMA usart1_rx_dma;
+    usart1_rx_dma.inti(DMA1_Channel5,(uint32_t)&USART1->DR,(uint32_t)USART1_RX_Buf,DMA_DIR_PeripheralSRC,USART1_RX_BUF_SIZE,
+                       DMA_PeripheralInc_Disable,DMA_MemoryInc_Enable,DMA_PeripheralDataSize_Byte,DMA_MemoryDataSize_Byte,
+                       DMA_Mode_Circular,DMA_Priority_High,DMA_M2M_Disable,RCC_AHBPeriph_DMA1);
+    DMA_ITConfig(DMA1_Channel5,DMA_IT_HT|DMA_IT_TC,ENABLE);     ///ȫжϣֹûпʱ
+
+    NVIC_InitTypeDef NVIC_InitStructure;
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;  //USART1жͬһռȼ
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    USART_DMACmd(USART1,USART_DMAReq_Rx,ENABLE);
+
+    USART1_TX.inti(DMA1_Channel4_IRQn,1,2);     //printf/log_write DMA1ͨ4
+
+}
     
     
 void Key_Init()
@@ -134,12 +168,62 @@ void Key_Init()
     
     
 
+//PWMƵʣҪƵѡƵڣھ(ֱʸ)ռձһ MOVE_DUTY_FULL ΪƵʱ벻ø
+static uint16_t PWM_Psc=1;
+static uint16_t PWM_Period=1;
+static int16_t PWM_Duty[MEC_WHEEL_NUM];         //һ PWM_Commit() ռձȣƵʱȽֵ
+static uint16_t PWM_Bat=BAT_SCALE_ONE;         //صѹϵ(Q12) Bat_Tick()
+static uint32_t PWM_Gain;                       //һռձȵλӦټ(Q16)ڱ˲㣬ÿڲó
+
+
+
+static int16_t Move_Unit(int32_t v,int32_t to,int32_t from)     //ռձȻλ(ǧ֮Q15)룬̵Ľص
+{
+    v=(v*to+(v<0?-from/2:from/2))/from;
+    if(v>MOVE_DUTY_FULL)
+        v=MOVE_DUTY_FULL;
+    if(v<-MOVE_DUTY_FULL)
+        v=-MOVE_DUTY_FULL;
+    return v;
+}
+
+
+
+static void PWM_Gain_Update()
+{
+    PWM_Gain=(((uint64_t)PWM_Period<<16)+MOVE_DUTY_FULL/2)/MOVE_DUTY_FULL;          //Q16 = /
+}
+
+
+
+static uint16_t PWM_Count(int16_t duty)         //ռձȻɼ̾һ
+{
+    uint32_t c=(uint32_t)(((uint64_t)duty*PWM_Gain+0x8000)>>16);
+
+    return c>PWM_Period?PWM_Period:c;
+}
+
+
+
+static uint32_t PWM_Calc(uint32_t hz,uint16_t *psc,uint16_t *period)     //ʵƵ
+{
+    uint32_t ticks=(SystemCoreClock+hz/2)/hz;   //TIM3/TIM4APB1ϣʱӱƵͬ SystemCoreClock
+
+    if(ticks<2)
+        ticks=2;
+    *psc=(ticks-1)/65536+1;
+    *period=(ticks+*psc/2)/ *psc;
+    return SystemCoreClock/ *psc/ *period;
+}
+
+
+
 void OutPWM_TIM3_Init()
 {
    TIM_TimeBaseInitTypeDef	tim_base;
     
-	tim_base.TIM_Prescaler=72-1;        //72Ƶ
-	tim_base.TIM_Period=1000-1;         //1000us
+	tim_base.TIM_Prescaler=PWM_Psc-1;   //Ƶ PWM_Calc()  PWM_HZ_DEFAULT 
+	tim_base.TIM_Period=PWM_Period-1;
 	tim_base.TIM_CounterMode=TIM_CounterMode_Up;    //ϼ
 	tim_base.TIM_ClockDivision=TIM_CKD_DIV1;   //ʱӲƵ
 	
@@ -160,7 +244,16 @@ void OutPWM_TIM3_Init()
     TIM_OC3Init(TIM3,&tim_oc_mode);         //B0
     TIM_OC4Init(TIM3,&tim_oc_mode);         //B1
     
-    TIM_Cmd(TIM3,ENABLE);       //ʱ3  
+    TIM_OC1PreloadConfig(TIM3,TIM_OCPreload_Enable);    //ȽֵдӰӼĴ¼ʱЧ
+    TIM_OC2PreloadConfig(TIM3,TIM_OCPreload_Enable);
+    TIM_OC3PreloadConfig(TIM3,TIM_OCPreload_Enable);
+    TIM_OC4PreloadConfig(TIM3,TIM_OCPreload_Enable);
+    TIM_ARRPreloadConfig(TIM3,ENABLE);
+
+    TIM_SelectMasterSlaveMode(TIM3,TIM_MasterSlaveMode_Enable);
+    TIM_SelectOutputTrigger(TIM3,TIM_TRGOSource_Enable);       //TIM3ͬʱTIM4Ӵͬ
+    
+    TIM_Cmd(TIM3,ENABLE);       //ʱ3TIM4Ҳһʼ  
     
 }
 
@@ -185,8 +278,8 @@ void OutPWM_TIM4_Init()
 {
    TIM_TimeBaseInitTypeDef	tim_base;
     
-	tim_base.TIM_Prescaler=72-1;        //72Ƶ
-	tim_base.TIM_Period=1000-1;         //1000us
+	tim_base.TIM_Prescaler=PWM_Psc-1;   //Ƶ PWM_Calc()  PWM_HZ_DEFAULT 
+	tim_base.TIM_Period=PWM_Period-1;
 	tim_base.TIM_CounterMode=TIM_CounterMode_Up;    //ϼ
 	tim_base.TIM_ClockDivision=TIM_CKD_DIV1;   //ʱӲƵ
 	
@@ -207,7 +300,15 @@ void OutPWM_TIM4_Init()
     TIM_OC3Init(TIM4,&tim_oc_mode);         //B8
     TIM_OC4Init(TIM4,&tim_oc_mode);         //B9
     
-    TIM_Cmd(TIM4,ENABLE);       //ʱ4   
+    TIM_OC1PreloadConfig(TIM4,TIM_OCPreload_Enable);
+    TIM_OC2PreloadConfig(TIM4,TIM_OCPreload_Enable);
+    TIM_OC3PreloadConfig(TIM4,TIM_OCPreload_Enable);
+    TIM_OC4PreloadConfig(TIM4,TIM_OCPreload_Enable);
+    TIM_ARRPreloadConfig(TIM4,ENABLE);
+
+    //ģʽTIM3(ITR2)ʱTIM4ſƵͬ¼ͬһʱ
+    TIM_SelectInputTrigger(TIM4,TIM_TS_ITR2);
+    TIM_SelectSlaveMode(TIM4,TIM_SlaveMode_Trigger);
     
 }
 
@@ -229,124 +330,1921 @@ void GPIO_TIM4_Init()
 
 
 
+#if PWM_DMA_BURST
+//ÿʱһDMAͨ¼ʱĸȽֵ DMAR һд CCR1~CCR4
+static uint16_t PWM_Dma_Fwd[4];
+static uint16_t PWM_Dma_Rev[4];
+
+
+
+static void PWM_DMA_Init()
+{
+    DMA dma;
+
+    dma.inti(DMA1_Channel3,(uint32_t)&TIM3->DMAR,(uint32_t)PWM_Dma_Fwd,DMA_DIR_PeripheralDST,4,
+             DMA_PeripheralInc_Disable,DMA_MemoryInc_Enable,DMA_PeripheralDataSize_HalfWord,DMA_MemoryDataSize_HalfWord,
+             DMA_Mode_Normal,DMA_Priority_VeryHigh,DMA_M2M_Disable,RCC_AHBPeriph_DMA1);      //TIM3_UP
+    dma.cmd(DMA1_Channel3,DISABLE);                 //µռձʱٿ
+    dma.inti(DMA1_Channel7,(uint32_t)&TIM4->DMAR,(uint32_t)PWM_Dma_Rev,DMA_DIR_PeripheralDST,4,
+             DMA_PeripheralInc_Disable,DMA_MemoryInc_Enable,DMA_PeripheralDataSize_HalfWord,DMA_MemoryDataSize_HalfWord,
+             DMA_Mode_Normal,DMA_Priority_VeryHigh,DMA_M2M_Disable,RCC_AHBPeriph_DMA1);      //TIM4_UP
+    dma.cmd(DMA1_Channel7,DISABLE);
+
+    TIM_DMAConfig(TIM3,TIM_DMABase_CCR1,TIM_DMABurstLength_4Transfers);
+    TIM_DMAConfig(TIM4,TIM_DMABase_CCR1,TIM_DMABurstLength_4Transfers);
+    TIM_DMACmd(TIM3,TIM_DMA_Update,ENABLE);
+    TIM_DMACmd(TIM4,TIM_DMA_Update,ENABLE);
+}
+
+
+
+static void PWM_DMA_Arm(DMA_Channel_TypeDef *ch)
+{
+    while(ch->CNDTR!=0&&ch->CNDTR!=4);        //ͻд༸ns
+    ch->CCR&=~DMA_CCR1_EN;
+    ch->CNDTR=4;
+    ch->CCR|=DMA_CCR1_EN;
+}
+#endif
+
+
+
 void PWM_Init()
 {
     GPIO_TIM3_Init();
 
-    OutPWM_TIM3_Init(); 
-
     GPIO_TIM4_Init (); 
     
-    OutPWM_TIM4_Init();
+    PWM_Calc(PWM_HZ_DEFAULT,&PWM_Psc,&PWM_Period);
+    PWM_Gain_Update();
+
+    OutPWM_TIM4_Init();         //TIM4ǴӶʱõTIM3
+
+    OutPWM_TIM3_Init(); 
+
+#if PWM_DMA_BURST
+    PWM_DMA_Init();
+#endif
+
+    Move_Ramp(Move_Acc,Move_Jerk);
     
 }
 
 
 
-void Move_Up(  )
+uint16_t Move_Speed=MOVE_SPEED_DEFAULT;
+static Mecanum mecanum(MOVE_DUTY_FULL);
+
+
+
+//ĸӵռձȲֱдɿÿ 1/CTRL_HZ 밴бһʱһ
+uint32_t Move_Acc=MOVE_ACC_DEFAULT;
+uint32_t Move_Jerk=MOVE_JERK_DEFAULT;
+static Ramp wheel_ramp[MEC_WHEEL_NUM]={ Ramp(CTRL_HZ), Ramp(CTRL_HZ), Ramp(CTRL_HZ), Ramp(CTRL_HZ) };
+static volatile bool Move_Busy;         //ӻûĿ꣬Ҫ
+static int16_t Move_Cmd[3];             //Move_Vel()  vx vy wб w
+static int16_t Skew_W;                  //ڼӵľ
+static void Move_Solve();
+
+
+
+//бһԴѹͬһߵʱϳپǺ( Skew_Est.h)١ȡ̼Ƶ
+//ÿ 1/ODOM_HZ 밴һ w ӵƶָϣѹ̼֮
+//ָ w(ԭתңת)ʱҲƣתʱѹʱתĲ֣תǰҲ׼
+static Skew_Est skew(LINE_FB_MM,LINE_LR_MM,SKEW_V_MIN,SKEW_ERR_MAX);
+
+
+
+//˸ȽֵԤװأдʱȹصʱĸ¼(UDIS)дٿ
+//¼Ҫôд֮ǰҪôд֮Ӳһ￴һһɵռձ
+void PWM_Commit(const int16_t duty[MEC_WHEEL_NUM])
 {
-    
-    TIM3->CCR1 =Move_Speed;
-    TIM3->CCR2 =Move_Speed;
-    TIM3->CCR3 =Move_Speed;
-    TIM3->CCR4 =Move_Speed;
-    
-    TIM4->CCR1=0;
-    TIM4->CCR2=0;
-    TIM4->CCR3=0;
-    TIM4->CCR4=0;
- 
+    CPU_SR_ALLOC();
+    uint16_t fwd[MEC_WHEEL_NUM],rev[MEC_WHEEL_NUM];
+    uint8_t i;
+
+    CPU_CRITICAL_ENTER();
+    for(i=0;i<MEC_WHEEL_NUM;i++)            //TIM3תTIM4תһռձһ߾0ڻɼ
+    {
+        PWM_Duty[i]=duty[i];
+        fwd[i]=duty[i]>0?PWM_Count(duty[i]):0;
+        rev[i]=duty[i]<0?PWM_Count(-duty[i]):0;
+    }
+    TIM3->CR1|=TIM_CR1_UDIS;
+    TIM4->CR1|=TIM_CR1_UDIS;
+#if PWM_DMA_BURST
+    memcpy(PWM_Dma_Fwd,fwd,sizeof(fwd));    //һ¼DMAдԤװأһЧ
+    memcpy(PWM_Dma_Rev,rev,sizeof(rev));
+    PWM_DMA_Arm(DMA1_Channel3);
+    PWM_DMA_Arm(DMA1_Channel7);
+#else
+    TIM3->CCR1=fwd[0];
+    TIM3->CCR2=fwd[1];
+    TIM3->CCR3=fwd[2];
+    TIM3->CCR4=fwd[3];
+    TIM4->CCR1=rev[0];
+    TIM4->CCR2=rev[1];
+    TIM4->CCR3=rev[2];
+    TIM4->CCR4=rev[3];
+#endif
+    TIM3->CR1&=~TIM_CR1_UDIS;
+    TIM4->CR1&=~TIM_CR1_UDIS;
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+uint32_t PWM_Freq(uint32_t hz)
+{
+    CPU_SR_ALLOC();
+    uint16_t psc,period;
+    uint32_t real;
+
+    if(hz==0)
+        return SystemCoreClock/PWM_Psc/PWM_Period;
+    real=PWM_Calc(hz,&psc,&period);
+
+    CPU_CRITICAL_ENTER();
+    TIM3->CR1|=TIM_CR1_UDIS;                //ƵڡȽֵԤװأһ¼ʱһ
+    TIM4->CR1|=TIM_CR1_UDIS;
+    PWM_Psc=psc;
+    PWM_Period=period;
+    PWM_Gain_Update();
+    TIM3->PSC=psc-1;
+    TIM4->PSC=psc-1;
+    TIM3->ARR=period-1;
+    TIM4->ARR=period-1;
+    PWM_Commit(PWM_Duty);                   //Ƚֵдٴ򿪸¼
+    CPU_CRITICAL_EXIT();
+    return real;
 }
 
 
 
+uint16_t PWM_Steps()
+{
+    return PWM_Period>MOVE_DUTY_FULL?MOVE_DUTY_FULL+1:PWM_Period;     //ڱ Q15 ʱļò
+}
 
-void Move_Back(  )
+
+
+//صѹϵƽѹԼΪ صѹ*ռձȣصѹ½ʱ BAT_NOMINAL_MV/صѹ Ŵռձȣ
+//Move_Speed ﰴʱߵľͺ͵ʱһϵڿ BAT_HZ һΣ Move_Solve() ˵ӵĿϣ
+//Ŵӳʱĸһߵķ򲻱
+static volatile uint16_t Bat_Mv;
+
+
+
+void Bat_Tick()         //ڿУÿ CTRL_HZ/BAT_HZ ڸһ
 {
-    
-    TIM4->CCR1 =Move_Speed;
-    TIM4->CCR2 =Move_Speed;
-    TIM4->CCR3 =Move_Speed;
-    TIM4->CCR4 =Move_Speed;
-    
-    TIM3->CCR1=0;
-    TIM3->CCR2=0;
-    TIM3->CCR3=0;
-    TIM3->CCR4=0;
- 
+    static uint16_t div;
+    CPU_SR_ALLOC();
+    uint32_t mv,scale;
+
+    if(++div<CTRL_HZ/BAT_HZ)
+        return;
+    div=0;
+
+    mv=(uint32_t)Adc_Value(ADC_CH_BAT)*(3300*BAT_DIVIDER)/4095;
+    if(mv<BAT_MIN_MV)                       //ûӷѹʱ
+        scale=BAT_SCALE_ONE;
+    else
+    {
+        scale=((uint32_t)BAT_NOMINAL_MV<<12)/mv;
+        if(scale>BAT_SCALE_MAX)
+            scale=BAT_SCALE_MAX;
+    }
+    Bat_Mv=mv;
+    if(scale==PWM_Bat)
+        return;
+
+    CPU_CRITICAL_ENTER();
+    PWM_Bat=scale;
+    Move_Solve();                           //ϵĿ꣬б߹ȥ
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+void Bat_Get(uint16_t *mv,uint16_t *scale)
+{
+    *mv=Bat_Mv;
+    *scale=PWM_Bat;
+}
+
+
+
+void PWM_Get(int16_t duty[MEC_WHEEL_NUM])
+{
+    uint8_t i;
+
+    for(i=0;i<MEC_WHEEL_NUM;i++)
+        duty[i]=Move_Unit(PWM_Duty[i],MOVE_DUTY_MAX,MOVE_DUTY_FULL);
+}
+
+
+
+static volatile uint16_t Motor_Hold;    //תͣҪȶٸ
+
+
+
+void Move_Ramp_Tick()       //ڿ
+{
+    CPU_SR_ALLOC();
+    int16_t d[MEC_WHEEL_NUM];
+    bool busy=false;
+    uint8_t i;
+
+    if(Motor_Hold)
+    {
+        Motor_Hold--;
+        return;
+    }
+    if(!Move_Busy)
+        return;
+    CPU_CRITICAL_ENTER();           //ADCжʱ Move_Halt()㵽һ뱻ٰѾɵдȥ
+    for(i=0;i<MEC_WHEEL_NUM;i++)
+    {
+        d[i]=wheel_ramp[i].tick();
+        if(!wheel_ramp[i].idle())
+            busy=true;
+    }
+    PWM_Commit(d);
+    Move_Busy=busy;
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+static uint32_t Move_Rate(uint32_t r)      //ǧ֮ÿ뻻 Q15 ÿ
+{
+    uint64_t q=((uint64_t)r*MOVE_DUTY_FULL+MOVE_DUTY_MAX/2)/MOVE_DUTY_MAX;
+    return q>0xFFFFFFFFu?0xFFFFFFFFu:(uint32_t)q;
+}
+
+
+
+void Move_Ramp(uint32_t acc,uint32_t jerk)
+{
+    CPU_SR_ALLOC();
+    uint8_t i;
+
+    CPU_CRITICAL_ENTER();
+    Move_Acc=acc;
+    Move_Jerk=jerk;
+    for(i=0;i<MEC_WHEEL_NUM;i++)            //б° Q15 ߣǧ֮ÿ
+        wheel_ramp[i].limits(Move_Rate(acc),Move_Rate(jerk));
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+static void Move_Solve()        //жʱ
+{
+    int16_t d[MEC_WHEEL_NUM];
+    int32_t b[MEC_WHEEL_NUM],m=0,a;
+    uint8_t i;
+
+    mecanum.solve(Move_Unit(Move_Cmd[0],MOVE_DUTY_FULL,MOVE_DUTY_MAX),Move_Unit(Move_Cmd[1],MOVE_DUTY_FULL,MOVE_DUTY_MAX),
+                  Move_Unit(Move_Cmd[2]+Skew_W,MOVE_DUTY_FULL,MOVE_DUTY_MAX),d);
+    for(i=0;i<MEC_WHEEL_NUM;i++)            //زܵӽأٵı˳
+    {
+        b[i]=((int32_t)d[i]*PWM_Bat+(d[i]<0?-BAT_SCALE_ONE/2:BAT_SCALE_ONE/2))/BAT_SCALE_ONE;
+        a=b[i]<0?-b[i]:b[i];
+        if(a>m)
+            m=a;
+    }
+    for(i=0;i<MEC_WHEEL_NUM;i++)
+    {
+        if(m>MOVE_DUTY_FULL)
+            b[i]=(b[i]*MOVE_DUTY_FULL+(b[i]<0?-m/2:m/2))/m;
+        wheel_ramp[i].target(b[i]);
+    }
+    Move_Busy=true;
+}
+
+
+
+void Move_Vel(int16_t vx,int16_t vy,int16_t w)
+{
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();           //ĸӵĿһ𻻣жﲻῴһ
+    Move_Cmd[0]=vx;
+    Move_Cmd[1]=vy;
+    Move_Cmd[2]=w;
+    if(!vx&&!vy)                    //ͣŲԭת
+        Skew_W=0;
+    if(w)
+    {
+        Skew_W=0;
+        skew.reset();
+    }
+    Move_Solve();
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+void Move_Halt()
+{
+    CPU_SR_ALLOC();
+    static const int16_t zero[MEC_WHEEL_NUM]={0};
+    uint8_t i;
+
+    CPU_CRITICAL_ENTER();
+    for(i=0;i<MEC_WHEEL_NUM;i++)
+        wheel_ramp[i].reset(0);
+    Move_Cmd[0]=Move_Cmd[1]=Move_Cmd[2]=0;     //һƶָбҲԼ
+    Skew_W=0;
+    Move_Busy=false;
+    PWM_Commit(zero);
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+uint32_t Move_Sat_Count()
+{
+    return mecanum.saturations();
 }
 
 
 
+void Move_Up(  )
+{
+    Move_Vel(0,Move_Speed,0);
+}
+
+
+
+void Move_Back(  )
+{
+    Move_Vel(0,-Move_Speed,0);
+}
+
+
 
 void Move_Left(  )
 {
-    
-    TIM4->CCR1 =Move_Speed;
-    TIM3->CCR2 =Move_Speed;
-    TIM3->CCR3 =Move_Speed;
-    TIM4->CCR4 =Move_Speed;
-    
-    TIM3->CCR1=0;
-    TIM4->CCR2=0;
-    TIM4->CCR3=0;
-    TIM3->CCR4=0;
- 
+    Move_Vel(-Move_Speed,0,0);
 }
 
 
 
 void Move_Right(  )
 {
-    
-    TIM3->CCR1 =Move_Speed;
-    TIM4->CCR2 =Move_Speed;
-    TIM4->CCR3 =Move_Speed;
-    TIM3->CCR4 =Move_Speed;
-    
-    TIM4->CCR1=0;
-    TIM3->CCR2=0;
-    TIM3->CCR3=0;
-    TIM4->CCR4=0;
- 
+    Move_Vel(Move_Speed,0,0);
+}
+
+
+
+void Move_Diag(int8_t dx,int8_t dy)
+{
+    int16_t v=(uint32_t)Move_Speed*MOVE_DIAG_SCALE/256u;
+    Move_Vel(dx*v,dy*v,0);
 }
 
+
+
 void Move_Stop()
 {
-    
-    TIM3->CCR1 =0;
-    TIM4->CCR2 =0;
-    TIM4->CCR3 =0;
-    TIM3->CCR4 =0;
-    
-    TIM4->CCR1=0;
-    TIM3->CCR2=0;
-    TIM3->CCR3=0;
-    TIM4->CCR4=0;    
-    
+    Move_Vel(0,0,0);
 }
 
 
 
-void OLED_Init()
+//A B࣬ıƵǰ TIM2(ӳ1A15 B3)ǰ TIM8(C6 C7) TIM1(ȫӳ䣬E9 E11)
+//Ķʱֻʣ(TIM3 TIM4 PWMTIM5 A0 A1ǰǰ)Һ E12 E13 ⲿж
+static Odometry odom(ODOM_NM_PER_COUNT,ODOM_ROT_MM,ODOM_HZ);
+static const int8_t Odom_Dir[ODOM_WHEEL_NUM]={1,-1,1,-1};       //ұߵĵǾװģǰתС߽ӷ˸
+static uint16_t Odom_Last[ODOM_WHEEL_NUM];
+static uint8_t  Odom_Div;
+static volatile uint16_t Odom_Exti_Cnt;     //Һ֣Ͷʱһ16λ
+static uint8_t  Odom_Exti_Ab;               //ϴεA Bƽ
+static volatile uint32_t Odom_Exti_Errs;    //A Bͬʱ(˱ػë)
+static const int8_t Odom_Quad[16]={0,-1,1,0, 1,0,0,-1, -1,0,0,1, 0,1,-1,0};      //[ϴAB*4+AB]AǰBΪ
+
+
+
+static void Odom_Tim_Init(TIM_TypeDef *TIMx)
 {
-    OLED_GPIO  oled_def;
-    oled_def.ID_Adress=0x3c;//OLEDĴӻַ
-    oled_def.SCL=new GPIO(GPIOD,GPIO_Pin_2);
-    oled_def.SDA=new GPIO(GPIOD,GPIO_Pin_0);
-    OLED oled(&oled_def);								 
-    oled.Init_Gpio();
-    oled.Inti();
-    
-    oled.Printf(50,2,"Red  :");
-    oled.Printf(50,4,"Blue :");
-    oled.Printf(50,6,"Green:");
-    
-    delete oled_def.SCL;
-    delete oled_def.SDA;
+    TIM_TimeBaseInitTypeDef	tim_base;
+    TIM_ICInitTypeDef tim_ic;
+
+    tim_base.TIM_Prescaler=0;
+    tim_base.TIM_Period=0xFFFF;
+    tim_base.TIM_CounterMode=TIM_CounterMode_Up;
+    tim_base.TIM_ClockDivision=TIM_CKD_DIV1;
+    tim_base.TIM_RepetitionCounter=0;
+    TIM_TimeBaseInit(TIMx,&tim_base );
+
+    TIM_EncoderInterfaceConfig(TIMx,TIM_EncoderMode_TI12,TIM_ICPolarity_Rising,TIM_ICPolarity_Rising);     //ıض
+    TIM_ICStructInit(&tim_ic);
+    tim_ic.TIM_ICFilter=6;                  //8 fDTS/4 һ㣬˵ë
+    tim_ic.TIM_Channel=TIM_Channel_1;
+    TIM_ICInit(TIMx,&tim_ic);
+    tim_ic.TIM_Channel=TIM_Channel_2;
+    TIM_ICInit(TIMx,&tim_ic);
+
+    TIM_SetCounter(TIMx,0);
+    TIM_Cmd(TIMx,ENABLE);
+}
+
+
+
+static uint8_t Odom_Exti_Read()
+{
+    uint16_t idr=GPIOE->IDR;
+    return ((idr>>12)&1)<<1|((idr>>13)&1);
+}
+
+
+
+void Odom_Init()
+{
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    GPIO A15(GPIOA,GPIO_Pin_15);
+    GPIO B3(GPIOB,GPIO_Pin_3);
+    GPIO C6(GPIOC,GPIO_Pin_6);
+    GPIO C7(GPIOC,GPIO_Pin_7);
+    GPIO E9(GPIOE,GPIO_Pin_9);
+    GPIO E11(GPIOE,GPIO_Pin_11);
+    GPIO E12(GPIOE,GPIO_Pin_12);
+    GPIO E13(GPIOE,GPIO_Pin_13);
+
+    A15.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);       //Ǽ缫·
+    B3.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    C6.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    C7.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    E9.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    E11.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    E12.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    E13.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);
+    GPIO_PinRemapConfig(GPIO_PartialRemap1_TIM2,ENABLE);        //JTAG system_init() ѾˣA15 B3 ճ
+    GPIO_PinRemapConfig(GPIO_FullRemap_TIM1,ENABLE);
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM1|RCC_APB2Periph_TIM8, ENABLE);
+    Odom_Tim_Init(TIM2);
+    Odom_Tim_Init(TIM8);
+    Odom_Tim_Init(TIM1);
+
+    Odom_Exti_Ab=Odom_Exti_Read();
+    GPIO_EXTILineConfig(GPIO_PortSourceGPIOE, GPIO_PinSource12);
+    GPIO_EXTILineConfig(GPIO_PortSourceGPIOE, GPIO_PinSource13);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line12|EXTI_Line13;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising_Falling;     //ıض
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI15_10_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;      //ڴʹڣӿʱҲ
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+
+
+void Odom_Exti()        //EXTI15_10ж
+{
+    uint8_t ab=Odom_Exti_Read();
+    int8_t d=Odom_Quad[Odom_Exti_Ab<<2|ab];
+
+    if(d==0&&ab!=Odom_Exti_Ab)
+        Odom_Exti_Errs++;
+    Odom_Exti_Cnt+=d;
+    Odom_Exti_Ab=ab;
+}
+
+
+
+void Odom_Tick()        //ڿУÿ CTRL_HZ/ODOM_HZ ڲһ
+{
+    uint16_t now[ODOM_WHEEL_NUM];
+    int16_t d[ODOM_WHEEL_NUM];
+    uint8_t i;
+
+    if(++Odom_Div<CTRL_HZ/ODOM_HZ)
+        return;
+    Odom_Div=0;
+
+    now[0]=TIM2->CNT;
+    now[1]=TIM8->CNT;
+    now[2]=TIM1->CNT;
+    now[3]=Odom_Exti_Cnt;
+    for(i=0;i<ODOM_WHEEL_NUM;i++)
+    {
+        d[i]=(int16_t)(now[i]-Odom_Last[i])*Odom_Dir[i];
+        Odom_Last[i]=now[i];
+    }
+    odom.update(d);
+}
+
+
+
+void Odom_Get(Car_Pose *out)
+{
+    CPU_SR_ALLOC();
+    Odom_Pose p;
+    uint8_t i;
+
+    CPU_CRITICAL_ENTER();
+    odom.get(&p);
+    CPU_CRITICAL_EXIT();
+    out->x_mm=p.x_mm;
+    out->y_mm=p.y_mm;
+    out->theta_mrad=p.theta_mrad;
+    out->vx=p.vx;
+    out->vy=p.vy;
+    out->w=p.w;
+    for(i=0;i<ODOM_WHEEL_NUM;i++)
+        out->wheel[i]=p.wheel[i];
+}
+
+
+
+uint32_t Odom_Exti_Errors()
+{
+    return Odom_Exti_Errs;
+}
+
+
+
+//TIM6ÿ 1/CTRL_HZ һźб¡дPWM
+//ʱ CPU_TS_TmrRd()(DWTڼ72MHz)ж´ʱ̣ʼһ
+static volatile uint8_t  Ctrl_Busy;             //Ѿû
+static volatile CPU_TS   Ctrl_Rel_Ts;           //δʱ
+static volatile uint32_t Ctrl_Overruns;
+static CPU_TS   Ctrl_Start_Ts;
+static CPU_TS   Ctrl_Last_Start;
+static uint32_t Ctrl_Cycles;
+static int32_t  Ctrl_Jit_Min,Ctrl_Jit_Max;
+static int64_t  Ctrl_Jit_Sum;
+static uint32_t Ctrl_Jit_N;                     //һûһΣ㶶
+static uint32_t Ctrl_Lat_Max;
+static uint64_t Ctrl_Lat_Sum;
+static uint32_t Ctrl_Exec_Min,Ctrl_Exec_Max;
+static uint64_t Ctrl_Exec_Sum;
+static bool     Ctrl_Restart=true;              //ͳƸһڲ㶶
+
+
+
+void Ctrl_Timer_Init()
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+    TIM_TimeBaseInitTypeDef	tim_base;
+
+    tim_base.TIM_Prescaler=72-1;        //72Ƶ1usһ
+    tim_base.TIM_Period=1000000/CTRL_HZ-1;
+    tim_base.TIM_CounterMode=TIM_CounterMode_Up;
+    tim_base.TIM_ClockDivision=TIM_CKD_DIV1;
+    tim_base.TIM_RepetitionCounter=0;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM6, ENABLE);
+    TIM_TimeBaseInit(TIM6,&tim_base );
+    TIM_ClearFlag(TIM6, TIM_FLAG_Update);
+    TIM_ITConfig(TIM6,TIM_IT_Update,ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM6_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;  //ʱ׼һЩжֻʱź
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(TIM6,ENABLE);
+}
+
+
+
+uint8_t Ctrl_Release()      //TIM6ж
+{
+    if(Ctrl_Busy)                       //һڻû꣬Ŷӣ
+    {
+        Ctrl_Overruns++;
+        return 0;
+    }
+    Ctrl_Rel_Ts=CPU_TS_TmrRd();
+    Ctrl_Busy=1;
+    return 1;
+}
+
+
+
+static uint32_t Ctrl_Ns(uint32_t ts)
+{
+    return (uint64_t)ts*1000u/(SystemCoreClock/1000000u);
+}
+
+
+
+void Ctrl_Begin()
+{
+    CPU_TS now=CPU_TS_TmrRd();
+    uint32_t lat=now-Ctrl_Rel_Ts;
+    int32_t jit;
+
+    if(!Ctrl_Restart)
+    {
+        jit=(int32_t)(now-Ctrl_Last_Start)-(int32_t)(SystemCoreClock/CTRL_HZ);      //Ҳ
+        if(Ctrl_Jit_N==0||jit<Ctrl_Jit_Min)
+            Ctrl_Jit_Min=jit;
+        if(Ctrl_Jit_N==0||jit>Ctrl_Jit_Max)
+            Ctrl_Jit_Max=jit;
+        Ctrl_Jit_Sum+=jit;
+        Ctrl_Jit_N++;
+    }
+    Ctrl_Restart=false;
+    if(lat>Ctrl_Lat_Max)
+        Ctrl_Lat_Max=lat;
+    Ctrl_Lat_Sum+=lat;
+    Ctrl_Last_Start=now;
+    Ctrl_Start_Ts=now;
 }
 
 
+
+void Ctrl_End()
+{
+    uint32_t exec=CPU_TS_TmrRd()-Ctrl_Start_Ts;
+
+    if(Ctrl_Cycles==0||exec<Ctrl_Exec_Min)
+        Ctrl_Exec_Min=exec;
+    if(exec>Ctrl_Exec_Max)
+        Ctrl_Exec_Max=exec;
+    Ctrl_Exec_Sum+=exec;
+    Ctrl_Cycles++;
+    Ctrl_Busy=0;
+}
+
+
+
+void Ctrl_Stat(Ctrl_Stat_T *out)        //ãͳʱסȣ񲻻
+{
+    OS_ERR err;
+    int32_t jit_n;
+
+    OSSchedLock(&err);
+    out->cycles=Ctrl_Cycles;
+    out->overruns=Ctrl_Overruns;
+    jit_n=Ctrl_Jit_N?Ctrl_Jit_N:1;
+    out->jitter_min=Ctrl_Jit_Min<0?-(int32_t)Ctrl_Ns(-Ctrl_Jit_Min):Ctrl_Ns(Ctrl_Jit_Min);
+    out->jitter_max=Ctrl_Jit_Max<0?-(int32_t)Ctrl_Ns(-Ctrl_Jit_Max):Ctrl_Ns(Ctrl_Jit_Max);
+    out->jitter_avg=(int32_t)(Ctrl_Jit_Sum*1000/(int32_t)(SystemCoreClock/1000000u)/jit_n);
+    out->latency_max=Ctrl_Ns(Ctrl_Lat_Max);
+    out->latency_avg=Ctrl_Cycles?Ctrl_Ns(Ctrl_Lat_Sum/Ctrl_Cycles):0;
+    out->exec_min=Ctrl_Ns(Ctrl_Exec_Min);
+    out->exec_max=Ctrl_Ns(Ctrl_Exec_Max);
+    out->exec_avg=Ctrl_Cycles?Ctrl_Ns(Ctrl_Exec_Sum/Ctrl_Cycles):0;
+
+    Ctrl_Cycles=0;
+    Ctrl_Overruns=0;
+    Ctrl_Jit_Min=Ctrl_Jit_Max=0;
+    Ctrl_Jit_Sum=0;
+    Ctrl_Jit_N=0;
+    Ctrl_Lat_Max=0;
+    Ctrl_Lat_Sum=0;
+    Ctrl_Exec_Min=Ctrl_Exec_Max=0;
+    Ctrl_Exec_Sum=0;
+    Ctrl_Restart=true;
+    OSSchedUnlock(&err);
+}
+
+
+
+//صѹADC1ɨ C1~C5DMA1ͨ1ѭˣȫжƽж
+//תʱжֱ Move_Halt()ȽֵһPWM¼㣻
+//жÿ ADC_SCAN_FRAMES*ADC_SCAN_US Լ230usһΣӵԽ޵ͣ1ms
+static uint16_t Adc_Buf[ADC_SCAN_FRAMES*2][ADC_SCAN_CH];
+static Adc_Watch adc_watch(ADC_SCAN_CH);
+static int8_t Motor_Oc_Rule[MEC_WHEEL_NUM];
+static int8_t Motor_Stall_Rule[MEC_WHEEL_NUM];
+
+
+
+static void Motor_Trip(uint8_t rule,uint16_t avg)      //DMA1ͨ1ж
+{
+    (void)rule;
+    (void)avg;
+    Move_Halt();
+    Motor_Hold=MOTOR_FAULT_MS*CTRL_HZ/1000;
+}
+
+
+
+void Adc_Init()
+{
+    static const uint8_t ch[ADC_SCAN_CH]={ADC_Channel_11,ADC_Channel_12,ADC_Channel_13,ADC_Channel_14,ADC_Channel_15};
+    GPIO C1(GPIOC,GPIO_Pin_1);
+    GPIO C2(GPIOC,GPIO_Pin_2);
+    GPIO C3(GPIOC,GPIO_Pin_3);
+    GPIO C4(GPIOC,GPIO_Pin_4);
+    GPIO C5(GPIOC,GPIO_Pin_5);
+    ADC adc;
+    uint8_t i;
+
+    C2.mode(GPIO_Mode_AIN,GPIO_Speed_50MHz);        //C1  inti_adc() 
+    C3.mode(GPIO_Mode_AIN,GPIO_Speed_50MHz);
+    C4.mode(GPIO_Mode_AIN,GPIO_Speed_50MHz);
+    C5.mode(GPIO_Mode_AIN,GPIO_Speed_50MHz);
+    adc.inti_adc(RCC_APB2Periph_ADC1,ADC1,&C1,ADC_Mode_Independent,ENABLE,ENABLE,ADC_ExternalTrigConv_None,
+                 ADC_DataAlign_Right,ADC_SCAN_CH,RCC_PCLK2_Div6);
+    for(i=0;i<ADC_SCAN_CH;i++)
+        adc.inti_channel(ADC1,ch[i],i+1,ADC_SampleTime_55Cycles5);
+
+    for(i=0;i<MEC_WHEEL_NUM;i++)
+    {
+        Motor_Oc_Rule[i]=adc_watch.rule(i,MOTOR_OC_RAW,1,true,Motor_Trip);
+        Motor_Stall_Rule[i]=adc_watch.rule(i,MOTOR_STALL_RAW,MOTOR_STALL_MS*1000/ADC_SCAN_US,true,Motor_Trip);
+    }
+
+    adc.inti_scan(ADC1,DMA1_Channel1,&Adc_Buf[0][0],ADC_SCAN_FRAMES*2*ADC_SCAN_CH,DMA1_Channel1_IRQn,0,2);     //ͱͬһռȼᱻڡ
+}
+
+
+
+void Adc_Feed(uint8_t half)
+{
+    adc_watch.feed(&Adc_Buf[half?ADC_SCAN_FRAMES:0][0],ADC_SCAN_FRAMES);
+}
+
+
+
+uint16_t Adc_Value(uint8_t ch)
+{
+    return adc_watch.value(ch);
+}
+
+
+
+uint16_t Adc_Peak(uint8_t ch)
+{
+    return adc_watch.peak(ch);
+}
+
+
+
+void Adc_Peak_Clear()
+{
+    adc_watch.peak_clear();
+}
+
+
+
+void Motor_Trips(uint32_t *oc,uint32_t *stall)
+{
+    uint8_t i;
+
+    *oc=0;
+    *stall=0;
+    for(i=0;i<MEC_WHEEL_NUM;i++)
+    {
+        *oc+=adc_watch.trips(Motor_Oc_Rule[i]);
+        *stall+=adc_watch.trips(Motor_Stall_Rule[i]);
+    }
+}
+
+
+
+//е۶TIM5 ֻʱ(1usһ֡ 1/SERVO_HZ )(A0~A3 ǰѲߴ)
+//ڿŵ D12 D13жһߡһ֡д CCRxȽж
+//CCR Ԥװأдȥֵһ֡ã SERVO_US_MINжд
+static Servo_Traj servo(SERVO_HZ,SERVO_NUM,SERVO_US_MIN,SERVO_US_MAX);
+static const uint16_t Servo_Pin[SERVO_NUM]={GPIO_Pin_12,GPIO_Pin_13};
+static const uint16_t Servo_It[4]={TIM_IT_CC1,TIM_IT_CC2,TIM_IT_CC3,TIM_IT_CC4};
+
+//ץȡſ(ɲͬʱ)н̧(Ѿ)
+static const Servo_Step Arm_Pick_Seq[]=
+{
+    {0x03,{SERVO_CLAW_OPEN,SERVO_ARM_DOWN},400,SERVO_EASE_COS,100},
+    {0x01,{SERVO_CLAW_CLOSE,0},250,SERVO_EASE_LINEAR,150},          //нԣһҲ
+    {0x02,{0,SERVO_ARM_UP},500,SERVO_EASE_COS,0},
+};
+
+//£ŵ(ɲͬʱ)ɿ̧צ(Ѿ)
+static const Servo_Step Arm_Place_Seq[]=
+{
+    {0x02,{0,SERVO_ARM_DOWN},400,SERVO_EASE_COS,100},
+    {0x01,{SERVO_CLAW_OPEN,0},200,SERVO_EASE_COS,100},
+    {0x03,{SERVO_CLAW_CLOSE,SERVO_ARM_UP},500,SERVO_EASE_COS,0},
+};
+
+static const Servo_Step Arm_Home_Seq[]=
+{
+    {0x03,{SERVO_CLAW_CLOSE,SERVO_ARM_UP},600,SERVO_EASE_COS,0},
+};
+
+
+
+void Servo_Init()
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+    TIM_TimeBaseInitTypeDef	tim_base;
+    GPIO D12(GPIOD,GPIO_Pin_12);
+    GPIO D13(GPIOD,GPIO_Pin_13);
+    uint8_t i;
+
+    D12.mode(GPIO_Mode_Out_PP,GPIO_Speed_2MHz);
+    D13.mode(GPIO_Mode_Out_PP,GPIO_Speed_2MHz);
+    D12.reset();
+    D13.reset();
+    servo.set(SERVO_CLAW,SERVO_CLAW_CLOSE);        //ϵʱ
+    servo.set(SERVO_ARM,SERVO_ARM_UP);
+
+    tim_base.TIM_Prescaler=72-1;        //72Ƶ1usһ
+    tim_base.TIM_Period=1000000/SERVO_HZ-1;
+    tim_base.TIM_CounterMode=TIM_CounterMode_Up;
+    tim_base.TIM_ClockDivision=TIM_CKD_DIV1;
+    tim_base.TIM_RepetitionCounter=0;
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);
+    TIM_TimeBaseInit(TIM5,&tim_base );
+    for(i=0;i<SERVO_NUM;i++)
+        ((volatile uint16_t *)&TIM5->CCR1)[i*2]=servo.value(i);     //CCR1~CCR4 4ֽ
+    TIM_ClearFlag(TIM5, TIM_FLAG_Update);
+    TIM_ITConfig(TIM5,TIM_IT_Update,ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM5_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;  //жϵļж˶ᶶ
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 3;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(TIM5,ENABLE);
+}
+
+
+
+void Servo_Frame()      //TIM5ж
+{
+    uint16_t pins=0;
+    uint8_t i;
+
+    for(i=0;i<SERVO_NUM;i++)
+        pins|=Servo_Pin[i];
+    GPIOD->BSRR=pins;                   //ߣ
+    servo.tick();
+    for(i=0;i<SERVO_NUM;i++)
+    {
+        ((volatile uint16_t *)&TIM5->CCR1)[i*2]=servo.value(i);
+        TIM_ClearITPendingBit(TIM5,Servo_It[i]);
+        TIM_ITConfig(TIM5,Servo_It[i],ENABLE);
+    }
+}
+
+
+
+void Servo_Edge(uint8_t ch)     //TIM5Ƚж
+{
+    GPIOD->BRR=Servo_Pin[ch];
+    TIM_ITConfig(TIM5,Servo_It[ch],DISABLE);       //һֻ֡һ
+}
+
+
+
+void Servo_Move(uint8_t ch,uint16_t us,uint16_t ms,uint8_t ease)
+{
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    servo.move(ch,us,ms,ease);
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+uint8_t Arm_Start(uint8_t seq)
+{
+    CPU_SR_ALLOC();
+    bool ok;
+
+    CPU_CRITICAL_ENTER();
+    switch(seq)
+    {
+        case ARM_SEQ_PICK: ok=servo.run(Arm_Pick_Seq,sizeof(Arm_Pick_Seq)/sizeof(Arm_Pick_Seq[0])); break;
+        case ARM_SEQ_PLACE: ok=servo.run(Arm_Place_Seq,sizeof(Arm_Place_Seq)/sizeof(Arm_Place_Seq[0])); break;
+        default: ok=servo.run(Arm_Home_Seq,sizeof(Arm_Home_Seq)/sizeof(Arm_Home_Seq[0])); break;
+    }
+    CPU_CRITICAL_EXIT();
+    return ok;
+}
+
+
+
+void Arm_Wait(uint8_t step)
+{
+    OS_ERR err;
+
+    while(servo.busy()&&servo.step()<step)
+        OSTimeDly(OSCfg_TickRate_Hz/SERVO_HZ,OS_OPT_TIME_DLY,&err);       //ÿ֡űһΣҲû
+}
+
+
+
+uint8_t Arm_Busy()
+{
+    return servo.busy();
+}
+
+
+
+//ESP8266  USART3(B10 B11)CH_PD E0RST E1
+static GPIO ESP8266_CH_PD(GPIOE,GPIO_Pin_0);
+static GPIO ESP8266_RST(GPIOE,GPIO_Pin_1);
+static GPIO ESP8266_Rx(GPIOB,GPIO_Pin_11);
+static GPIO ESP8266_Tx(GPIOB,GPIO_Pin_10);
+static ESP8266_Gpio esp8266_gpio = { &ESP8266_CH_PD, &ESP8266_RST, &ESP8266_Rx, &ESP8266_Tx };
+static ESP8266 esp8266(&esp8266_gpio);
+
+//·ӣWiFi_Init() ֮ɼʱѯڼֻ WiFi_Up
+static Link_Sup wifi_sup;
+static volatile bool WiFi_Up;           //ɡ֮ûжϿ
+static bool WiFi_Join;                  //ȵҲˣҪȵ
+
+//UDPģʽڵ֡ƴTlm_Flush() һ CIPSEND ʡÿ֡һεָ
+static uint8_t  Tlm_Udp_Buf[TLM_UDP_BUF_SIZE];
+static uint16_t Tlm_Udp_Len;
+static uint8_t  Tlm_Udp_Frames;     //֡
+static uint32_t Tlm_Udp_Lost;       //UDPʧܶ֡
+static uint8_t  Tlm_Udp_InFlight;   //ѽģ顢û SEND OK İ֡
+static uint32_t Tlm_Udp_Fails;
+static uint8_t  Tlm_Udp_Ticks;      //˼
+
+//ģʽÿͻһУTlm_Flush() ÿֵһͻ
+static uint32_t Fan_SendFails;
+static bool Fan_Send(uint8_t id,const uint8_t *buf,uint16_t len,bool *prev_lost)
+{
+    bool ok=esp8266.Send_Id((ENUM_ID_NO)id,buf,len,false);
+    *prev_lost=(esp8266.Send_Fails()!=Fan_SendFails);       //һε SEND OK η֮ǰŵ
+    Fan_SendFails=esp8266.Send_Fails();
+    return ok;
+}
+static Tlm_Fanout fanout(Fan_Send);
+static volatile uint8_t Fan_Open;       //жµ״̬nλΪӺn
+static volatile uint8_t Fan_Event;      //״̬б仯û
+static uint8_t Fan_Sub[FAN_CLIENT_NUM]; //ңյĶģ Fan_SubEvent һڹжʱ
+static volatile uint8_t Fan_SubEvent;   //б仯û
+
+static uint16_t Tlm_Write(const uint8_t *buf,uint16_t len)
+{
+    if(WIFI_LINK_MODE==WIFI_LINK_TCP)
+        return WiFi_Up?esp8266.Send(buf,len):0;     //ģʱϲܲ
+    if(WIFI_LINK_MODE==WIFI_LINK_SERVER)
+        return fanout.publish(buf,len);
+    if(Tlm_Udp_Len+len>TLM_UDP_BUF_SIZE)
+        return 0;
+    memcpy(&Tlm_Udp_Buf[Tlm_Udp_Len],buf,len);
+    Tlm_Udp_Len+=len;
+    Tlm_Udp_Frames++;
+    return len;
+}
+static Telemetry tlm(Tlm_Write);
+
+//ʱָӦ𾭷ָTCPӷңֻŽλ¸ CIPSENDң񲻵ģ
+static uint8_t  Ack_Ring[ACK_RING_SIZE];    //һ¼Ӻ(1) (1) ֡
+static volatile uint16_t Ack_Head;          //ֻңдһֱӣʱ ACK_RING_SIZE ȡģ
+static volatile uint16_t Ack_Tail;          //ֻд
+static uint32_t Ack_Lost;                   //ʧܵӦ𣬵Գʱط
+static uint8_t Ack_Link;                    //ӦӺţֻң
+static uint16_t Ack_Write(const uint8_t *buf,uint16_t len)
+{
+    uint16_t head=Ack_Head,i;
+
+    if(!WiFi_Up||len>TLM_FRAME_MAX||ACK_RING_SIZE-(uint16_t)(head-Ack_Tail)<len+2)
+        return 0;                           //Telemetry Ϊ
+    Ack_Ring[head++%ACK_RING_SIZE]=Ack_Link;
+    Ack_Ring[head++%ACK_RING_SIZE]=len;
+    for(i=0;i<len;i++)
+        Ack_Ring[head++%ACK_RING_SIZE]=buf[i];
+    Ack_Head=head;                          //֡дƶ head
+    return len;
+}
+static Telemetry tlm_ack(Ack_Write);        //TCPUDPԱţԶ˷ֱͳƶ֡
+
+static void Ack_Flush()                     //Уһε SEND OK  Send_Id() ȣԵģ
+{
+    uint8_t buf[TLM_FRAME_MAX];
+    uint16_t tail=Ack_Tail;
+    uint8_t link,len,i;
+
+    while(tail!=Ack_Head)
+    {
+        link=Ack_Ring[tail++%ACK_RING_SIZE];
+        len=Ack_Ring[tail++%ACK_RING_SIZE];
+        for(i=0;i<len;i++)
+            buf[i]=Ack_Ring[tail++%ACK_RING_SIZE];
+        Ack_Tail=tail;
+        if(!WiFi_Up||!esp8266.Send_Id((ENUM_ID_NO)link,buf,len,false))
+            Ack_Lost++;
+    }
+}
+
+//ң֡źͼ룬ңȼߣʱ
+static void Tlm_Lock()
+{
+    OS_ERR err;
+    OSSchedLock(&err);
+}
+static void Tlm_Unlock()
+{
+    OS_ERR err;
+    OSSchedUnlock(&err);
+}
+
+static uint32_t Tlm_Time()      //ңʱ(ms)
+{
+    OS_ERR err;
+    return OSTimeGet(&err)*1000u/OSCfg_TickRate_Hz;
+}
+
+
+static void Fan_Link(uint8_t id,bool open);
+
+void WiFi_Init()
+{
+    esp8266.Init();
+    if(WIFI_LINK_MODE==WIFI_LINK_SERVER)
+    {
+        esp8266.Set_LinkHandler(Fan_Link);
+        esp8266.Set_AP_Mode();
+    }
+    else if(WIFI_LINK_MODE==WIFI_LINK_UDP)
+        esp8266.Set_STA_Mux_Mode();
+    else
+        esp8266.Set_STA_Mode();
+    if(WIFI_LINK_MODE!=WIFI_LINK_TCP)       //͸вܲѯ״̬
+        wifi_sup.start(Tlm_Time(),true);
+    WiFi_Up=true;
+}
+
+
+static void Fan_Reset()             //ģ鸴λԭĿͻ˶ˣ CLOSED
+{
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    Fan_Event|=Fan_Open;
+    Fan_Open=0;
+    CPU_CRITICAL_EXIT();
+}
+
+
+uint32_t WiFi_Supervise()
+{
+    uint32_t wait;
+    uint8_t ids;
+    ENUM_Link_Status st;
+    bool ok;
+
+    switch(wifi_sup.next(Tlm_Time(),&wait))
+    {
+        case LINK_ACT_POLL:
+            st=esp8266.Link_Poll(&ids);
+            if(WIFI_LINK_MODE==WIFI_LINK_SERVER)
+                ok=(st!=Status_Get_Fall);                   //Լȵ㣬ģ黹Ӧ
+            else
+                ok=(st==Link_Set)&&((ids&0x03)==0x03);      //TCP0UDP1
+            WiFi_Join=(st==AP_Lost)||(st==Status_Get_Fall);
+            wifi_sup.polled(Tlm_Time(),ok);
+            break;
+
+        case LINK_ACT_RECONNECT:
+            if(WIFI_LINK_MODE==WIFI_LINK_SERVER)
+            {
+                ok=esp8266.Restart_AP();
+                Fan_Reset();
+            }
+            else
+            {
+                ok=esp8266.Relink_STA_Mux(WiFi_Join);
+                if(!ok)
+                    WiFi_Join=true;                         //ֻؽӲУ´δȵ㿪ʼ
+            }
+            wifi_sup.reconnected(Tlm_Time(),ok);
+            break;
+
+        default:
+            return wait;
+    }
+    WiFi_Up=wifi_sup.is_up();
+    return 0;
+}
+
+
+uint8_t WiFi_Link_Up()
+{
+    return WiFi_Up;
+}
+
+
+void WiFi_Link_Stat(WiFi_Link *out)
+{
+    Link_Stat st;
+
+    wifi_sup.stat(Tlm_Time(),&st);
+    out->up=WiFi_Up;
+    out->uptime_ms=st.uptime;
+    out->up_total_ms=st.up_total;
+    out->downs=st.downs;
+    out->reconnects=st.reconnects;
+    out->attempts=st.attempts;
+    out->recover_last_ms=st.recover_last;
+    out->recover_max_ms=st.recover_max;
+    out->recover_avg_ms=st.recover_avg;
+}
+
+
+void Tlm_Send_Pose(int16_t x_mm,int16_t y_mm,int16_t theta_mrad,int8_t grid_x,int8_t grid_y)
+{
+    Tlm_Pose p;
+    p.x_mm=x_mm;
+    p.y_mm=y_mm;
+    p.theta_mrad=theta_mrad;
+    p.grid_x=grid_x;
+    p.grid_y=grid_y;
+    Tlm_Lock();
+    tlm.pose(Tlm_Time(),&p);
+    Tlm_Unlock();
+}
+
+
+void Tlm_Send_Power()
+{
+    Tlm_Power p;
+    uint16_t mv,scale;
+    Bat_Get(&mv,&scale);
+    p.bat_mv=mv;
+    p.scale=scale;
+    Tlm_Lock();
+    tlm.power(Tlm_Time(),&p);
+    Tlm_Unlock();
+}
+
+
+void Tlm_Send_Wheel()
+{
+    Tlm_Wheel w;
+    PWM_Get(w.duty);        //ȽֵļƵʱ䣬ң԰ MOVE_DUTY_MAX Ϊ
+    Tlm_Lock();
+    tlm.wheel(Tlm_Time(),&w);
+    Tlm_Unlock();
+}
+
+
+void Tlm_Send_Mission(uint8_t step,uint8_t dir,uint8_t state)
+{
+    Tlm_Mission m;
+    m.step=step;
+    m.dir=dir;
+    m.state=state;
+    Tlm_Lock();
+    tlm.mission(Tlm_Time(),&m);
+    Tlm_Unlock();
+}
+
+
+void Tlm_Send_Vision(uint8_t kind,uint8_t result,int16_t x,int16_t y)
+{
+    Tlm_Vision v;
+    v.kind=kind;
+    v.result=result;
+    v.x=x;
+    v.y=y;
+    Tlm_Lock();
+    tlm.vision(Tlm_Time(),&v);
+    Tlm_Unlock();
+}
+
+
+static void Fan_Flush()
+{
+    uint8_t ev,open,sub_ev,sub[FAN_CLIENT_NUM],i;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    ev=Fan_Event;
+    open=Fan_Open;
+    Fan_Event=0;
+    sub_ev=Fan_SubEvent;
+    Fan_SubEvent=0;
+    for(i=0;i<FAN_CLIENT_NUM;i++)
+        sub[i]=Fan_Sub[i];
+    CPU_CRITICAL_EXIT();
+    for(i=0;i<FAN_CLIENT_NUM;i++)           //ϡϿ͸ĶЧַͷͶü
+    {
+        if(ev&(1u<<i))
+        {
+            if(open&(1u<<i))
+                fanout.open(i,Tlm_Time());
+            else
+                fanout.close(i);
+        }
+        if(sub_ev&(1u<<i))                  // open() ֮󣬲ᱻĻ FAN_TOPIC_ALL
+            fanout.subscribe(i,sub[i]);
+    }
+    if(WiFi_Up&&!esp8266.Send_Busy())       //һε SEND OK ûͲ֡ڸԶţ˸ģ񲻵ȣÿڶ
+        fanout.pump();
+}
+
+
+void Tlm_Flush()
+{
+    if(WIFI_LINK_MODE!=WIFI_LINK_TCP)
+        Ack_Flush();                        //Ӧȷ
+    if(WIFI_LINK_MODE==WIFI_LINK_SERVER)
+    {
+        Fan_Flush();
+        return;
+    }
+    if(WIFI_LINK_MODE!=WIFI_LINK_UDP||++Tlm_Udp_Ticks<TLM_FLUSH_DIV)
+        return;
+    Tlm_Udp_Ticks=0;
+    if(Tlm_Udp_Len==0)
+        return;
+    if(!WiFi_Up)                            //Ͽʱģ飬ֱӶ
+        Tlm_Udp_Lost+=Tlm_Udp_Frames;
+    else if(esp8266.Send_Id(Multiple_ID_1,Tlm_Udp_Buf,Tlm_Udp_Len,false))     //SEND OK ʱռʱ
+    {
+        if(esp8266.Send_Fails()!=Tlm_Udp_Fails)         //һʧ
+            Tlm_Udp_Lost+=Tlm_Udp_InFlight;
+        Tlm_Udp_InFlight=Tlm_Udp_Frames;
+    }
+    else
+        Tlm_Udp_Lost+=Tlm_Udp_Frames;
+    Tlm_Udp_Fails=esp8266.Send_Fails();
+    Tlm_Udp_Len=0;
+    Tlm_Udp_Frames=0;
+}
+
+
+uint32_t Tlm_Drop_Count()
+{
+    return tlm.drop_frames()+Tlm_Udp_Lost+tlm_ack.drop_frames()+Ack_Lost;
+}
+
+
+uint8_t Tlm_Client_Stat(uint8_t id,Tlm_Client *out)
+{
+    Fan_Stat st;
+    uint32_t ms;
+
+    if(!fanout.stat(id,&st))
+        return 0;
+    ms=Tlm_Time()-st.open_time;
+    out->topics=fanout.topics(id);
+    out->frames=st.frames;
+    out->bytes=st.bytes;
+    out->drops=st.drops;
+    out->fails=st.fails;
+    out->queued_max=st.queued_max;
+    out->rate=ms?(uint32_t)((uint64_t)st.bytes*1000u/ms):0;
+    return 1;
+}
+
+
+
+//ңָUSART3ж֡ŽеĲ۾OSнң Remote_Ack() ͷ
+struct Rmt_Slot
+{
+    Rmt_Cmd             cmd;
+    volatile uint8_t    busy;       //ж1Ӧ0
+    uint8_t             link;       //ָӺţӦ𷢻ȥ
+};
+static Rmt_Slot Rmt_Slots[RMT_SLOT_NUM];
+static OS_Q     Rmt_Q;
+static uint32_t Rmt_LatencyMax;     //յ֡βӦʱ(us)
+
+static void Ota_Put(const uint8_t *p,uint8_t len);
+static void Rmt_OnCmd(const Rmt_Cmd *cmd,void *arg)         //USART3ж
+{
+    OS_ERR err;
+    uint8_t i;
+    if(cmd->head.id==TLM_ID_CMD_OTA)        //OTAռָҲӦ𣬽񣬽 TLM_ID_OTA ״̬֡
+    {
+        Ota_Put(cmd->data,cmd->len);
+        return;
+    }
+    for(i=0;i<RMT_SLOT_NUM;i++)
+    {
+        if(!Rmt_Slots[i].busy)
+        {
+            Rmt_Slots[i].cmd=*cmd;
+            Rmt_Slots[i].link=(uint8_t)(uint32_t)arg;
+            Rmt_Slots[i].busy=1;
+            OSQPost(&Rmt_Q,&Rmt_Slots[i],sizeof(Rmt_Slot),OS_OPT_POST_FIFO,&err);
+            return;
+        }
+    }
+    //۶ˣӦ𣬵Գʱͬһط
+}
+static Remote rmt[FAN_CLIENT_NUM]=           //ÿһ֡ȥػӰ죻Ƿģʽֻõ0
+{
+    Remote(Rmt_OnCmd,(void *)0),
+    Remote(Rmt_OnCmd,(void *)1),
+    Remote(Rmt_OnCmd,(void *)2),
+    Remote(Rmt_OnCmd,(void *)3),
+};
+
+static void Rmt_Data(uint8_t id,const char *p,uint16_t len)     //ESP8266͸յֽڣʱ +IPD 
+{
+    if(WIFI_LINK_MODE==WIFI_LINK_UDP&&id!=Multiple_ID_0)        //ָֻTCP
+        return;
+    if(id>=FAN_CLIENT_NUM)
+        return;
+    rmt[id].feed((const uint8_t *)p,len,CPU_TS_Get32());
+}
+
+static void Fan_Link(uint8_t id,bool open)          //USART3ж
+{
+    if(id>=FAN_CLIENT_NUM)
+        return;
+    if(open)
+    {
+        Fan_Open|=1u<<id;
+        rmt[id].reset();                //¿ͻˣŴͷ
+    }
+    else
+        Fan_Open&=~(1u<<id);
+    Fan_Event|=1u<<id;
+    Fan_SubEvent&=~(1u<<id);            //һͻ˵ĶĲµ
+}
+
+
+void Remote_Init()
+{
+    OS_ERR err;
+    OSQCreate(&Rmt_Q,"Remote",RMT_SLOT_NUM,&err);
+    esp8266.Set_DataHandler(Rmt_Data);
+}
+
+
+uint8_t Remote_Get(Remote_Msg *msg,uint32_t timeout_ms)
+{
+    OS_ERR      err;
+    OS_MSG_SIZE size;
+    OS_TICK     ticks=timeout_ms*OSCfg_TickRate_Hz/1000u;
+    Rmt_Slot   *s;
+    Tlm_Jog     jog;
+    Tlm_Vel     vel;
+    Tlm_Param   par;
+    CPU_SR_ALLOC();
+
+    if(timeout_ms&&ticks==0)
+        ticks=1;
+    s=(Rmt_Slot *)OSQPend(&Rmt_Q,ticks,OS_OPT_PEND_BLOCKING,&size,0,&err);
+    if(s==0)
+        return 0;
+
+    msg->slot=s-Rmt_Slots;
+    msg->dup=s->cmd.dup;
+    msg->kind=RMT_UNKNOWN;
+    msg->arg=0;
+    msg->value=0;
+    msg->vel[0]=msg->vel[1]=msg->vel[2]=0;
+    switch(s->cmd.head.id)
+    {
+        case TLM_ID_CMD_JOG:
+            if(Telemetry::get_jog(s->cmd.data,s->cmd.len,&jog))
+            {
+                msg->kind=RMT_JOG;
+                msg->arg=jog.dir;
+                msg->value=jog.time_ms;
+            }
+            break;
+        case TLM_ID_CMD_VEL:
+            if(Telemetry::get_vel(s->cmd.data,s->cmd.len,&vel))
+            {
+                msg->kind=RMT_VEL;
+                msg->vel[0]=vel.vx;
+                msg->vel[1]=vel.vy;
+                msg->vel[2]=vel.w;
+                msg->value=vel.time_ms;
+            }
+            break;
+        case TLM_ID_CMD_STOP:
+            msg->kind=RMT_STOP;
+            break;
+        case TLM_ID_CMD_MISSION:
+            if(s->cmd.len>=1)
+            {
+                msg->kind=RMT_MISSION;
+                msg->arg=s->cmd.data[0];
+            }
+            break;
+        case TLM_ID_CMD_PARAM:
+            if(Telemetry::get_param(s->cmd.data,s->cmd.len,&par))
+            {
+                msg->kind=RMT_PARAM;
+                msg->arg=par.id;
+                msg->value=par.value;
+            }
+            break;
+        case TLM_ID_CMD_PING:
+            msg->kind=RMT_PING;
+            break;
+        case TLM_ID_CMD_SUB:
+            if(WIFI_LINK_MODE==WIFI_LINK_SERVER&&s->cmd.len>=1&&s->link<FAN_CLIENT_NUM)
+            {
+                CPU_CRITICAL_ENTER();                       //ģڷַͷͣطҲһ
+                Fan_Sub[s->link]=s->cmd.data[0];
+                Fan_SubEvent|=1u<<s->link;
+                CPU_CRITICAL_EXIT();
+                msg->kind=RMT_SUB;
+                msg->arg=s->cmd.data[0];
+            }
+            break;
+    }
+    return 1;
+}
+
+
+void Remote_Ack(const Remote_Msg *msg,uint8_t result)
+{
+    Rmt_Slot *s=&Rmt_Slots[msg->slot];
+    Tlm_Ack   a;
+    uint32_t  us;
+
+    us=(CPU_TS_Get32()-s->cmd.ts)/(BSP_CPU_ClkFreq()/1000000u);
+    if(us>Rmt_LatencyMax)
+        Rmt_LatencyMax=us;
+
+    a.cmd_seq=s->cmd.head.seq;
+    a.cmd_id=s->cmd.head.id;
+    a.result=result;
+    a.echo=s->cmd.head.time;
+    a.latency_us=(us>0xFFFF)?0xFFFF:us;
+    Ack_Link=s->link;
+    s->busy=0;
+    if(WIFI_LINK_MODE!=WIFI_LINK_TCP)
+        tlm_ack.ack(Tlm_Time(),&a);     //ֻӦ𻺳񷢳
+    else
+        tlm.ack(Tlm_Time(),&a);         //ңȼߣʱ˵ȣﲻ
+}
+
+
+void Remote_Stat(uint32_t *frames,uint32_t *dups,uint32_t *lost,uint32_t *bad,uint32_t *latency_max_us)
+{
+    uint8_t i;
+    *frames=*dups=*lost=*bad=0;
+    for(i=0;i<FAN_CLIENT_NUM;i++)
+    {
+        *frames+=rmt[i].rx_frames();
+        *dups+=rmt[i].dup_frames();
+        *lost+=rmt[i].lost_frames();
+        *bad+=rmt[i].bad_frames();
+    }
+    *latency_max_us=Rmt_LatencyMax;
+}
+
+
+
+//OTAUSART3жϰ TLM_ID_CMD_OTA ֡ԭŽλȡдW25Q64дflashʱж
+//W25Q64  SPI1(A5 A6 A7)Ƭѡ C0A5 ҲҴA6 A7 TIM312ֻͨڼӹܣȫͣת
+static GPIO W25Q64_CS(GPIOC,GPIO_Pin_0);
+static GPIO W25Q64_SCK(GPIOA,GPIO_Pin_5);
+static GPIO W25Q64_MISO(GPIOA,GPIO_Pin_6);
+static GPIO W25Q64_MOSI(GPIOA,GPIO_Pin_7);
+static W25Q64_Gpio w25q64_gpio = { &W25Q64_SCK, &W25Q64_MISO, &W25Q64_MOSI, &W25Q64_CS };
+static W25Q64 w25q64(&w25q64_gpio);
+
+static void Ota_Erase(uint32_t addr,uint32_t len)
+{
+    uint32_t end=addr+len;
+    while(addr<end)
+    {
+        if((addr&0xFFFF)==0&&end-addr>=0x10000)     //64KԼ0.15sֳ16Ҫ0.7s
+        {
+            w25q64.BlockErase(addr);
+            addr+=0x10000;
+        }
+        else
+        {
+            w25q64.SectorErase(addr);
+            addr+=OTA_CHUNK;
+        }
+    }
+}
+static void Ota_Write(uint32_t addr,const uint8_t *buf,uint16_t len)
+{
+    w25q64.Write((uint8_t *)buf,addr,len);
+}
+static void Ota_Read(uint32_t addr,uint8_t *buf,uint16_t len)
+{
+    w25q64.Read(buf,addr,len);
+}
+static const Ota_Flash ota_flash = { Ota_Erase, Ota_Write, Ota_Read };
+static Ota ota(&ota_flash);
+
+static uint8_t  Ota_Ring[OTA_RING_SIZE];    //һ¼(1) 
+static volatile uint16_t Ota_Head;          //ֻждһֱӣʱ OTA_RING_SIZE ȡģ
+static volatile uint16_t Ota_Tail;          //ֻд
+static uint32_t Ota_RingDrops;              //֡ƫƶԲϺԴһط
+static OS_SEM   Ota_Sem;
+static bool     Ota_Pins;                   //W25Q64ռA5~A7
+static uint16_t Ota_CCER3,Ota_CCER4;
+
+static void Ota_Put(const uint8_t *p,uint8_t len)          //USART3ж
+{
+    OS_ERR err;
+    uint16_t head=Ota_Head;
+    uint8_t i;
+
+    if(len<TLM_OTA_DATA_HEAD)
+        return;
+    if(OTA_RING_SIZE-(uint16_t)(head-Ota_Tail)<len+1)
+    {
+        Ota_RingDrops++;
+        return;
+    }
+    Ota_Ring[head++%OTA_RING_SIZE]=len;
+    for(i=0;i<len;i++)
+        Ota_Ring[head++%OTA_RING_SIZE]=p[i];
+    Ota_Head=head;                          //дƶ headµ head ʱѾ
+    OSSemPost(&Ota_Sem,OS_OPT_POST_1,&err);
+}
+
+static uint8_t Ota_Take(uint8_t *p)         //ȡһ¼ûз0
+{
+    uint16_t tail=Ota_Tail;
+    uint8_t len,i;
+
+    if(tail==Ota_Head)
+        return 0;
+    len=Ota_Ring[tail++%OTA_RING_SIZE];
+    for(i=0;i<len;i++)
+        p[i]=Ota_Ring[tail++%OTA_RING_SIZE];
+    Ota_Tail=tail;
+    return len;
+}
+
+static void Ota_Bulk(const Tlm_Head *head,const uint8_t *p,uint8_t len,bool dup,void *arg)     //USART3жУOTA֡
+{
+    if(head->id==TLM_ID_CMD_OTA&&!dup)
+        Ota_Put(p,len);
+}
+
+static void Ota_Take_Pins()
+{
+    if(Ota_Pins)
+        return;
+    Move_Halt();                            //б£ͣ
+    EXTI->IMR&=~EXTI_Line5;                 //A5SCKʱҴжϹص
+    Ota_CCER3=TIM3->CCER;
+    Ota_CCER4=TIM4->CCER;
+    TIM3->CCER=0;                           //PWMA6 A7 øSPI1
+    TIM4->CCER=0;
+    w25q64.Init();
+    Ota_Pins=true;
+}
+
+static void Ota_Release_Pins()
+{
+    if(!Ota_Pins)
+        return;
+    SPI_Cmd(SPI1,DISABLE);
+    GPIO_TIM3_Init();
+    W25Q64_SCK.mode(GPIO_Mode_IPU,GPIO_Speed_50MHz);       //ͬ Sensor_Init()
+    TIM3->CCER=Ota_CCER3;
+    TIM4->CCER=Ota_CCER4;
+    EXTI_ClearITPendingBit(EXTI_Line5);
+    EXTI->IMR|=EXTI_Line5;
+    Ota_Pins=false;
+}
+
+static void Ota_Send_Status(uint8_t op,uint32_t arg)      //ظ op ָ arg
+{
+    Tlm_Ota st;
+    ota.status(&st);
+    st.op=op;
+    st.arg=arg;
+    Tlm_Lock();
+    tlm.ota(Tlm_Time(),&st);
+    Tlm_Unlock();
+}
+
+
+void Ota_Init()
+{
+    OS_ERR err;
+    uint8_t i;
+    OSSemCreate(&Ota_Sem,"Ota",0,&err);
+    W25Q64_CS.mode(GPIO_Mode_Out_PP,GPIO_Speed_50MHz);
+    W25Q64_CS.set();                        //ƽʱA5~A7ǴPWMƬѡW25Q64Ųǵָ
+    for(i=0;i<FAN_CLIENT_NUM;i++)
+        rmt[i].set_bulk(Ota_Bulk);
+}
+
+
+uint8_t Ota_Busy()
+{
+    return Ota_Pins;
+}
+
+
+void Ota_Run()
+{
+    OS_ERR err;
+    static uint8_t buf[TLM_BULK_MAX];
+    Tlm_Ota_Cmd c;
+    uint8_t len;
+    bool reply,reset=false;
+
+    OSSemPend(&Ota_Sem,Ota_Pins?OTA_IDLE_MS*OSCfg_TickRate_Hz/1000u:0,OS_OPT_PEND_BLOCKING,0,&err);
+    if(err==OS_ERR_TIMEOUT)                 //Բˣݴ´Żʹ
+    {
+        ota.abort();
+        Ota_Release_Pins();
+        Ota_Send_Status(TLM_OTA_STATUS,0);
+        return;
+    }
+    while((len=Ota_Take(buf))!=0)
+    {
+        if(!Telemetry::get_ota_cmd(buf,len,&c))
+            continue;
+        reply=true;
+        switch(c.op)
+        {
+            case TLM_OTA_BEGIN:
+                Ota_Take_Pins();
+                if(ota.begin(c.arg,c.crc)!=TLM_RES_OK)
+                    Ota_Release_Pins();
+                break;
+            case TLM_OTA_DATA:              //ݲ״̬ƫƶԲϵĶڿУĻظ￴ next ط
+                ota.data(c.arg,&buf[TLM_OTA_DATA_HEAD],len-TLM_OTA_DATA_HEAD);
+                reply=false;
+                break;
+            case TLM_OTA_CHUNK:
+                ota.chunk((uint16_t)c.arg,c.crc);       //16λǵԼõ
+                break;
+            case TLM_OTA_COMMIT:
+                if(ota.commit())
+                {
+                    Ota_Release_Pins();
+                    reset=(c.arg!=0);
+                }
+                break;
+            case TLM_OTA_ABORT:
+                ota.abort();
+                Ota_Release_Pins();
+                break;
+        }
+        if(reply)
+            Ota_Send_Status(c.op,c.arg);
+        if(reset)                           //״̬֡ȥλ򿽱
+        {
+            OSTimeDly(OSCfg_TickRate_Hz/5,OS_OPT_TIME_DLY,&err);
+            NVIC_SystemReset();
+        }
+    }
+}
+
+
+uint32_t Ota_Ring_Drops()
+{
+    return Ota_RingDrops;
+}
+
+
+
+void OLED_Init()
+{
+    OLED_GPIO  oled_def;
+    oled_def.ID_Adress=0x3c;//OLEDĴӻַ
+    oled_def.SCL=new GPIO(GPIOD,GPIO_Pin_2);
+    oled_def.SDA=new GPIO(GPIOD,GPIO_Pin_0);
+    OLED oled(&oled_def);								 
+    oled.Init_Gpio();
+    oled.Inti();
+    
+    oled.Printf(50,2,"Red  :");
+    oled.Printf(50,4,"Blue :");
+    oled.Printf(50,6,"Green:");
+    
+    delete oled_def.SCL;
+    delete oled_def.SDA;
+}
+
+
+//Ѳߴѹʱ̣ж CPU_TS_TmrRd()(DWTڼSystemCoreClock)TIM7жŽλ
+//Position ÿµĶȡ㣻TIM5 벶 A1~A3  CH2 ѾʱˣA5 ҲǶʱţ
+//жڼжӦӳ(ͬȼĴжŶʱus)
+static Line_Timing line_timing(SystemCoreClock,LINE_GRID_MM,LINE_PAIR_MS*1000u);
+
+
+
+static uint8_t Skew_Div;        //Skew_Tick() ƵбĹ Move_Vel() ǰ
+
+
+
+void Skew_Tick()        //ڿУOdom_Tick() ֮
+{
+    CPU_SR_ALLOC();
+    Odom_Pose p;
+    int16_t w;
+
+    if(++Skew_Div<CTRL_HZ/ODOM_HZ)
+        return;
+    Skew_Div=0;
+    CPU_CRITICAL_ENTER();           //Position ADCж(Move_Halt)
+    odom.get(&p);
+    w=(Move_Cmd[0]||Move_Cmd[1])&&!Move_Cmd[2]?skew.correct(p.theta_mrad,SKEW_GAIN,SKEW_DEADBAND,SKEW_W_MAX):0;
+    if(w!=Skew_W)
+    {
+        Skew_W=w;
+        Move_Solve();
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+void Line_Mark(uint8_t id,uint32_t ts)
+{
+    line_timing.push(id,ts);
+}
+
+
+
+void Line_Drain()
+{
+    CPU_SR_ALLOC();
+    Line_Edge e;
+    Odom_Pose p;
+    int8_t pair;
+
+    while(line_timing.pop(&e))
+    {
+        pair=line_timing.feed(&e);
+        if(pair<0)
+            continue;
+        CPU_CRITICAL_ENTER();
+        odom.get(&p);               //ǰ󴫸ѹߣҵĳ٣Ҵǰ
+        if(!Move_Cmd[2])
+            skew.cross(pair,line_timing.pair_dt(pair),pair==LINE_PAIR_FB?p.vx:p.vy,p.theta_mrad);
+        CPU_CRITICAL_EXIT();
+    }
+}
+
+
+
+void Line_Get(Line_Stat *out)
+{
+    OS_ERR err;
+    uint8_t i;
+
+    OSSchedLock(&err);                  //Position ȼߣȡʱһ
+    out->dt_fb_us=line_timing.pair_dt(LINE_PAIR_FB);
+    out->dt_lr_us=line_timing.pair_dt(LINE_PAIR_LR);
+    out->pairs_fb=line_timing.pairs(LINE_PAIR_FB);
+    out->pairs_lr=line_timing.pairs(LINE_PAIR_LR);
+    for(i=0;i<4;i++)
+    {
+        out->edges[i]=line_timing.edges(i+1);
+        out->speed[i]=line_timing.speed(i+1);
+    }
+    out->drops=line_timing.drops();
+    out->skew_mrad=skew.last();
+    out->skew_n=skew.count();
+    out->skew_rejects=skew.rejects();
+    out->skew_w=Skew_W;
+    OSSchedUnlock(&err);
+}
+
+
+
+//Ѳߴⲿжֻʱ̽ debounce(ϵͳ)TIM7 ÿ 1/DEB_HZ һţ
+//Чƽ˲һΣTIM7ж﷢( stm32f10x_it .cpp)ÿزٸһ
+//ʱѵһصʱ̽ Line_Mark()ѹʱ̲ĵȴӰ
+static Debounce debounce(DEB_HZ);
+static uint8_t Deb_Fired;               //ߣTIM7жȡ
+
+
+
+static void Deb_Accept(uint8_t line,uint32_t ts)
+{
+    Deb_Fired|=1<<line;
+    if(line>=DEB_FRONT)
+        Line_Mark(line-DEB_FRONT+1,ts);
+}
+
+
+
+void Debounce_Init()
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+    TIM_TimeBaseInitTypeDef	tim_base;
+
+    debounce.add(KEY_MIN_US,KEY_REFRACT_MS,Deb_Accept);         //˳ͬ DEB_KEY1 ~ DEB_RIGHT
+    debounce.add(KEY_MIN_US,KEY_REFRACT_MS,Deb_Accept);
+    debounce.add(SENSOR_MIN_US,SENSOR_REFRACT_MS,Deb_Accept);
+    debounce.add(SENSOR_MIN_US,SENSOR_REFRACT_MS,Deb_Accept);
+    debounce.add(SENSOR_MIN_US,SENSOR_REFRACT_MS,Deb_Accept);
+    debounce.add(SENSOR_MIN_US,SENSOR_REFRACT_MS,Deb_Accept);
+
+    tim_base.TIM_Prescaler=72-1;        //72Ƶ1usһ
+    tim_base.TIM_Period=1000000/DEB_HZ-1;
+    tim_base.TIM_CounterMode=TIM_CounterMode_Up;
+    tim_base.TIM_ClockDivision=TIM_CKD_DIV1;
+    tim_base.TIM_RepetitionCounter=0;
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM7, ENABLE);
+    TIM_TimeBaseInit(TIM7,&tim_base );
+    TIM_ClearFlag(TIM7, TIM_FLAG_Update);
+    TIM_ITConfig(TIM7,TIM_IT_Update,ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM7_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;  //ͬжϣ಻ϣжжϵ edge()
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(TIM7,ENABLE);
+}
+
+
+
+void Debounce_Edge(uint8_t line,uint32_t ts)
+{
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    debounce.edge(line,ts);
+    CPU_CRITICAL_EXIT();
+}
+
+
+
+uint8_t Debounce_Tick()
+{
+    uint16_t a=GPIOA->IDR,e=GPIOE->IDR;
+    uint8_t active=0,fired;
+
+    if(a&GPIO_Pin_0)            //Key1 Ϊߣǵ
+        active|=1<<DEB_KEY1;
+    if(!(e&GPIO_Pin_4))
+        active|=1<<DEB_KEY2;
+    if(!(a&GPIO_Pin_1))
+        active|=1<<DEB_FRONT;
+    if(!(a&GPIO_Pin_2))
+        active|=1<<DEB_BACK;
+    if(!(a&GPIO_Pin_3))
+        active|=1<<DEB_LEFT;
+    if(!(a&GPIO_Pin_5))
+        active|=1<<DEB_RIGHT;
+    debounce.tick(active);
+    fired=Deb_Fired;
+    Deb_Fired=0;
+    return fired;
+}
+
+
+
+//жϵִʱ(CPU)Ƚ֪ͨ Position (SENSOR_SIGNAL_QUEUE)
+//ⲿжϺTIM7жռȼͬ಻ϣ¼ʱùж
+static uint32_t Isr_Cnt[ISR_TIME_NUM];
+static uint32_t Isr_Max[ISR_TIME_NUM];
+static uint32_t Isr_Sum[ISR_TIME_NUM];
+
+
+
+void Isr_Time(uint8_t which,uint32_t cycles)
+{
+    Isr_Cnt[which]++;
+    Isr_Sum[which]+=cycles;
+    if(cycles>Isr_Max[which])
+        Isr_Max[which]=cycles;
+}
+
+
+
+void Isr_Time_Get(uint8_t which,uint32_t *n,uint32_t *max_ns,uint32_t *avg_ns)
+{
+    CPU_SR_ALLOC();
+    uint32_t cnt,max,sum;
+
+    CPU_CRITICAL_ENTER();
+    cnt=Isr_Cnt[which];
+    max=Isr_Max[which];
+    sum=Isr_Sum[which];
+    Isr_Cnt[which]=Isr_Max[which]=Isr_Sum[which]=0;
+    CPU_CRITICAL_EXIT();
+    *n=cnt;
+    *max_ns=Ctrl_Ns(max);
+    *avg_ns=cnt?Ctrl_Ns(sum/cnt):0;
+}
+
+
+
+void Debounce_Get(uint8_t line,uint32_t *accepts,uint32_t *glitches,uint32_t *bounces)
+{
+    *accepts=debounce.accepts(line);
+    *glitches=debounce.glitches(line);
+    *bounces=debounce.bounces(line);
+}
+
+
+
 void Sensor_Init()
 {
     GPIO FrontSensor(GPIOA,GPIO_Pin_1);
@@ -25,8 +25,201 @@ extern "C"
 
 //ûⲿ    
 
-#define Move_Speed 200        //ƶʱPWM(0-1000)    
-    
+#define MOVE_SPEED_DEFAULT  200        //ƶʱPWM(0-1000)
+extern uint16_t Move_Speed;             //ǰƶPWMң޸
+#define MOVE_DUTY_MAX       1000       //Move_Vel()Move_Speedб²ңռձȵλ(ǧ֮)1000ΪPWMƵ޹أʱĸӵȱС
+#define MOVE_DUTY_FULL      32767      //ڲ(Mecanumб¡PWM_Commit)ռձ(Q15)PWMڵļϸбºͲķֱֻ
+#define MOVE_DIAG_SCALE     181        //бʱ vxvy Ϊ Move_Speed  181/256(Լ1/2)ٺֱһ߶Խʡ29%ʱ
+#define PWM_HZ_DEFAULT      20000      //PWMƵ(Hz)20kHz72MHzһ3600
+#define PWM_DMA_BURST       0          //1ĸӵıȽֵɸ¼DMAͻд(DMA1ͨ37)CPUCCRһPWMЧ
+#define CTRL_HZ             1000       //Ƶ(Hz)TIM6жϴռձÿڰбһ
+#define MOVE_ACC_DEFAULT    4000       //ռձÿ仯٣0~1000Ҫ0.25s0Ϊ(ͬǰֱ)
+#define MOVE_JERK_DEFAULT   80000      //ٶÿ仯٣ٶȴ0Ҫ50ms0Ϊ
+extern uint32_t Move_Acc;               //ǰб²ң޸
+extern uint32_t Move_Jerk;
+
+#define ODOM_HZ             100        //̼ƻƵ(Hz)ÿ CTRL_HZ/ODOM_HZ һ
+#define ODOM_COUNTS_REV     1560       //תһȦļ13߻30٣ıƵ
+#define ODOM_WHEEL_MM       60         //ķֱ(mm)
+#define ODOM_ROT_MM         200        //ǰ־һ־һ(mm)ԭתһȦʵٵ
+#define ODOM_NM_PER_COUNT   ( 3141593u * ODOM_WHEEL_MM / ODOM_COUNTS_REV )     //һ߹ľ(nm)
+
+#define ADC_SCAN_CH         5          //ADC1ɨ裺C1~C4 ĸӵĵ(˳ͬ Mecanum.h)C5 صѹ(ѹ)
+#define ADC_CH_BAT          4
+#define ADC_SCAN_FRAMES     8          //DMAÿɨȫһж
+#define ADC_SCAN_US         28         //һɨʱ䣺12MHzÿͨ 55.5+12.5 
+#define MOTOR_OC_RAW        3100       //˲(8ƽ0~4095)ͣ·궨
+#define MOTOR_STALL_RAW     2000       //תֵ MOTOR_STALL_MS ͣ
+#define MOTOR_STALL_MS      100
+#define MOTOR_FAULT_MS      500        //ͣôòӦƶָ֮0б
+#define BAT_DIVIDER         4          //ؾ 1/4 ѹ C5·
+#define BAT_NOMINAL_MV      7400       // Move_Speed ʱʱĵصѹʱϵΪ1
+#define BAT_MIN_MV          5000       //ֵΪûӷѹ
+#define BAT_SCALE_ONE       4096       //ϵ Q12
+#define BAT_SCALE_MAX       6144       //Ŵ1.5ؿûʱڰռձȫ
+#define BAT_HZ              10         //ϵƵ(Hz)ADCѾ8ƽһ㲻ŵĲ
+#define SERVO_NUM           2          //е۶D12 צD13 ̧ۣTIM5 ʱ
+#define SERVO_HZ            50
+#define SERVO_US_MIN        500        //Χ(us)
+#define SERVO_US_MAX        2500
+#define SERVO_CLAW          0
+#define SERVO_ARM           1
+#define SERVO_CLAW_OPEN     1000       //λõװ
+#define SERVO_CLAW_CLOSE    1750
+#define SERVO_ARM_UP        1000
+#define SERVO_ARM_DOWN      2000
+#define ARM_SEQ_HOME        0          //Arm_Start() Ķ
+#define ARM_SEQ_PICK        1
+#define ARM_SEQ_PLACE       2
+#define ARM_PICK_GRIPPED    2          //ץȡǰ(н)Ϳߣ̧ۺʻͬʱ
+#define ARM_PLACE_RELEASED  2          //ǰ(ɿ)Ϳ
+#define ARM_STEP_ALL        0xFF       //Arm_Wait() 
+
+#define DEB_HZ              1000       //ĲƵ(TIM7)
+#define DEB_KEY1            0          //ߺ
+#define DEB_KEY2            1
+#define DEB_FRONT           2          //ǰ   Ҵ˳ͬ Position ı 1~4
+#define DEB_BACK            3
+#define DEB_LEFT            4
+#define DEB_RIGHT           5
+#define DEB_LINE_NUM        6
+#define KEY_MIN_US          20000      //Ҫ20ms
+#define KEY_REFRACT_MS      200        //200msڵıزҪ
+#define SENSOR_MIN_US       2000       //ѹҪ2ms̵ë
+#define SENSOR_REFRACT_MS   100        //ѹһߺ100msڲѹһ(1.5m/s300mmҪ200ms)ʱıǶ
+#define SENSOR_SIGNAL_QUEUE 0          //ѹô֪ͨ Position 0 ¼־飬һڵļһηꣻ
+                                       //1 ǰÿѹһڴһϢֻΪԱжʱ(Key1 ӡ)
+#define ISR_TIME_EDGE       0          //Isr_Time() ͳƵжϣⲿж
+#define ISR_TIME_SIGNAL     1          //TIM7жд(жϵ)
+#define ISR_TIME_NUM        2
+#define LINE_GRID_MM        300        //ظӱ߳(mm)ѹ߼㳵ãظ
+#define LINE_PAIR_MS        300        //һԴѹʱͲͬһ
+#define LINE_FB_MM          160        //ǰ󴫸ľ(mm)
+#define LINE_LR_MM          160        //Ҵľ(mm)
+#define SKEW_V_MIN          50         //ѹ߷ĳ(mm/s)ֵбжӳռ̫
+#define SKEW_ERR_MAX        250        //ñ⻹(mrad)Ϊ˶ԣҪ
+#define SKEW_GAIN           100        //w = -(mrad) * 100/2560ΪֻƲ
+#define SKEW_DEADBAND       5          // 5mrad ڲذ
+#define SKEW_W_MAX          60         // w ô(ռձȵλ)
+
+#define USART1_RX_BUF_SIZE  256        //USART1 DMAѭջС(ֽ)
+extern uint8_t USART1_RX_Buf[USART1_RX_BUF_SIZE];   //DMA1ͨ5ѭд룬ֻȡжϽƬ
+
+#define TLM_POSE_HZ         100        //λңƵ(Hz)һ֡20ֽڣ100HzԼռ11520017%
+#define TLM_WHEEL_DIV       5          //ÿ5λ˷һռձ(20Hz)
+#define TLM_MISSION_DIV     20         //(5Hz)
+#define TLM_VISION_DIV      20         //ͷ(5Hz)
+#define TLM_POWER_DIV       20         //صѹ(5Hz)
+#define WIFI_LINK_TCP       0          //ӵԣң⡢ָһTCP͸
+#define WIFI_LINK_UDP       1          //ӵ()ң⾭UDP(ۺ֡)ָӦTCP
+#define WIFI_LINK_SERVER    2          //Сȵ TLM_CLIENT_NUM ͻԶң⡢ָ
+#define WIFI_LINK_MODE      WIFI_LINK_UDP
+#define TLM_FLUSH_DIV       2          //UDPģʽÿ2ڵ֡ƴһһ CIPSEND 115200Ҫ10msңÿһ
+#define TLM_UDP_BUF_SIZE    128        //һUDP󳤶ȣ275ֽ
+#define TLM_CLIENT_NUM      4          //ģʽĿͻ Tlm_Fanout.h  FAN_CLIENT_NUM ͬ
+
+//ңָ(ԾESP8266)USART3ж֡Remote_Get() ȡִ Remote_Ack()
+#define RMT_UNKNOWN         0          //ʶݸʽ
+#define RMT_JOG             1          //㶯argΪ(Diretion)valueΪʱms
+#define RMT_STOP            2          //ͣ
+#define RMT_MISSION         3          //ʼargΪʼ
+#define RMT_PARAM           4          //޸ĲargΪţvalueΪֵ
+#define RMT_PING            5          //ֻӦ
+#define RMT_SUB             6          //ģʽ¿ͻ˸ĶģRemote_Get() Ѿ¸ЧֻӦ
+#define RMT_VEL             7          //ٶȣvelΪ vx vy wvalueΪʱms
+
+#define RMT_RES_OK          0          //Ӧ Telemetry.h  TLM_RESULT ͬ
+#define RMT_RES_DUP         1
+#define RMT_RES_BUSY        2
+#define RMT_RES_BAD_ARG     3
+#define RMT_RES_UNKNOWN     4
+
+#define RMT_PARAM_MOVE_SPEED    0      //ţ Telemetry.h  TLM_PARAM_* ͬ
+#define RMT_PARAM_CORRECT_TIME  1
+#define RMT_PARAM_RAMP_ACC      2
+#define RMT_PARAM_RAMP_JERK     3
+
+#define RMT_SLOT_NUM        4          //ѹָٶĲӦ𣬵Գʱط
+#define ACK_RING_SIZE       128        //ʱ񷢳Ӧ(ֽ)һӦʮֽڣRMT_SLOT_NUM ŵ
+#define RMT_JOG_MAX_MS      5000       //㶯ʱ
+
+#define OTA_RING_SIZE       4096       //OTA֡λ(ֽ)115200Լ0.35sݣдW25Q64ʱжϽ
+#define OTA_IDLE_MS         10000      //ôûյOTA֡ͣʹָ֮ͬһ
+
+typedef struct
+{
+    uint8_t   kind;         //RMT_*
+    uint8_t   dup;          //طָ֮ǰѾִйֻӦ
+    uint8_t   arg;
+    int32_t   value;
+    int16_t   vel[3];       //RMT_VELvx vy w(ռձȵλ)
+    uint8_t   slot;         //ڲʹ
+} Remote_Msg;
+
+typedef struct              //Ķʱͳ(ns)ϴ Ctrl_Stat() 
+{
+    uint32_t  cycles;       //ִ˵
+    uint32_t  overruns;     //ʱһڻû(ûʼ)
+    int32_t   jitter_min;   //οʼ֮ļȥ
+    int32_t   jitter_max;
+    int32_t   jitter_avg;
+    uint32_t  latency_max;  //ʱжϵʼ
+    uint32_t  latency_avg;
+    uint32_t  exec_min;     //һڵִʱ
+    uint32_t  exec_max;
+    uint32_t  exec_avg;
+} Ctrl_Stat_T;
+
+typedef struct              //̼ƣϵʱλΪԭ㣬y Ϊʱͷ򣬼 Odometry.h
+{
+    int32_t   x_mm;
+    int32_t   y_mm;
+    int16_t   theta_mrad;   //ʱΪ
+    int16_t   vx;           //ٶ(mm/s)Ϊ
+    int16_t   vy;           //ǰΪ
+    int16_t   w;            //mrad/s
+    int16_t   wheel[4];     //(mm/s)ǰ ǰ  Һ
+} Car_Pose;
+
+typedef struct              //Ѳߴѹʱͳƣ˳ǰ   
+{
+    int32_t   dt_fb_us;     //һǰ󴫸ѹͬһߵʱ(ǰ)ʱΪ0
+    int32_t   dt_lr_us;     //Ҵѹͬһ(Ҽ)
+    uint32_t  pairs_fb;     //ɶԵĴ
+    uint32_t  pairs_lr;
+    uint32_t  edges[4];     //ѹߴ
+    uint16_t  speed[4];     //ͬһѹ߼ĳ(mm/s)
+    uint32_t  drops;        //Position ȡλ
+    int16_t   skew_mrad;    //һѹĺʱΪ
+    uint32_t  skew_n;       //˼
+    uint32_t  skew_rejects; //̫̫ײҪ
+    int16_t   skew_w;       //ڼӵƶָϵ w
+} Line_Stat;
+
+typedef struct              //ģʽһͻ˵ңͳ
+{
+    uint8_t   topics;       //ĵϢnλΪ TLM_ID n
+    uint32_t  frames;       //֡
+    uint32_t  bytes;
+    uint32_t  drops;        //ʧܶ֡
+    uint32_t  fails;        //ʧܴ
+    uint16_t  queued_max;   //ѹֽ
+    uint32_t  rate;         //ƽ(B/s)
+} Tlm_Client;
+
+typedef struct              //·ͳ(UDPͷģʽTCP͸ʱܷATָ)
+{
+    uint8_t   up;           //
+    uint32_t  uptime_ms;    //
+    uint32_t  up_total_ms;  //ۼŵʱ
+    uint32_t  downs;        //Ͽ
+    uint32_t  reconnects;   //ɹ
+    uint32_t  attempts;     //Դ
+    uint32_t  recover_last_ms;  //һδӷֶϿָʱ
+    uint32_t  recover_max_ms;
+    uint32_t  recover_avg_ms;
+} WiFi_Link;
+
     
 void LED1_Toggle(void);     //LED1ת    
 void LED2_Toggle(void);     //LED2ת
@@ -36,6 +229,68 @@ void Move_Right(void);           //
 void Move_Left(void);            //ƽ
 void Move_Back(void);            //
 void Move_Up(void);              //ǰ
+void Move_Vel(int16_t vx,int16_t vy,int16_t w);     //ٶ(ҡǰʱ룬ռձȵλ)ĸӵĿ꣬ Mecanum.hӰб¹ȥ
+void Move_Diag(int8_t dx,int8_t dy);                //бߣdx 1 -1dy 1ǰ -1
+uint32_t Move_Sat_Count(void);                      //Move_Vel()  MOVE_DUTY_MAX ȱСĴ
+void Move_Halt(void);                               //бͣ(ӹPWMǰͣ)
+void PWM_Commit(const int16_t duty[4]);             //ĸӵռձ(Q15MOVE_DUTY_FULLΪΪǰת)һд˸Ƚֵͬһ¼Ч
+void PWM_Get(int16_t duty[4]);                       //һдռձȣ MOVE_DUTY_MAX Ϊ
+uint32_t PWM_Freq(uint32_t hz);                     //ĵPWMƵʣʵƵʣ0Ϊֻѯ
+uint16_t PWM_Steps(void);                           //ռձʵֳܷļһPWMڵļ Q15  MOVE_DUTY_FULL+1
+void Bat_Tick(void);                                //ڿÿڵ
+void Bat_Get(uint16_t *mv,uint16_t *scale);         //صѹ(mV)ռձȲϵ(Q124096Ϊ1)
+void Move_Ramp(uint32_t acc,uint32_t jerk);         //б² Ramp.h
+void Move_Ramp_Tick(void);                          //ڿÿڵ
+void Odom_Tick(void);                               //ڿÿڵ
+uint8_t Ctrl_Release(void);                         //TIM6жã1ʱź0Ϊһû(һγʱ)
+void Ctrl_Begin(void);                              //ÿڿʼʱãʱͳ
+void Ctrl_End(void);
+void Ctrl_Stat(Ctrl_Stat_T *out);                   //ȡͳƲ¿ʼ
+void Odom_Exti(void);                               //EXTI15_10ж(Һֱ)
+void Adc_Feed(uint8_t half);                        //DMA1ͨ1жã0ǰһ 1һ
+uint16_t Adc_Value(uint8_t ch);                     //ƽԭʼֵ(0~4095)ch Ϊɨ˳
+uint16_t Adc_Peak(uint8_t ch);                      //ϴ Adc_Peak_Clear() ֵ
+void Adc_Peak_Clear(void);
+void Motor_Trips(uint32_t *oc,uint32_t *stall);     //תͣĴ(ĸӺϼ)
+void Servo_Frame(void);                             //TIM5ж
+void Servo_Edge(uint8_t ch);                        //TIM5Ƚж
+void Servo_Move(uint8_t ch,uint16_t us,uint16_t ms,uint8_t ease);  // ms ߵ usease  Servo.h
+uint8_t Arm_Start(uint8_t seq);                     //ʼһ׶(ARM_SEQ_*)ꣻһû귵0
+void Arm_Wait(uint8_t step);                        //ȶǰ step (ȫ)
+uint8_t Arm_Busy(void);
+void Debounce_Edge(uint8_t line,uint32_t ts);       //ڰⲿжãline Ϊ DEB_*ts Ϊ CPU_TS_TmrRd()
+uint8_t Debounce_Tick(void);                        //TIM7жã(nλΪ DEB_* n)
+void Debounce_Get(uint8_t line,uint32_t *accepts,uint32_t *glitches,uint32_t *bounces);    //ë̡Ĵ
+void Isr_Time(uint8_t which,uint32_t cycles);       //жĩβãcycles Ϊ CPU_TS_TmrRd() ֮
+void Isr_Time_Get(uint8_t which,uint32_t *n,uint32_t *max_ns,uint32_t *avg_ns);    //ȡ¿ʼ
+void Line_Mark(uint8_t id,uint32_t ts);             //ʱãid ͬ Position Ϣts Ϊһص CPU_TS_TmrRd()
+void Line_Drain(void);                              // Position ãµѹʱ
+void Line_Get(Line_Stat *out);
+void Skew_Tick(void);                               //ڿÿڵãOdom_Tick() ֮󣺰ƶָ w
+void Odom_Get(Car_Pose *out);
+uint32_t Odom_Exti_Errors(void);                    //ҺA Bͬʱ仯Ĵ
+uint16_t log_write(const char *str,uint16_t len);   //1(DMA)дֽ0
+uint32_t log_drop_count(void);                      //1򻺳ֽ
+void WiFi_Init(void);                               //ESP8266ȵ͵ԻԼȵ( WIFI_LINK_MODE)Ϊֹеã֮ǰңⶪ
+uint32_t WiFi_Supervise(void);                      //·һ(ѯ״̬һΣҪ)صһʱ(ms)ڵĵȼе
+uint8_t WiFi_Link_Up(void);                         //·ţϿʱңӦֱӶģ
+void WiFi_Link_Stat(WiFi_Link *out);
+void Tlm_Send_Pose(int16_t x_mm,int16_t y_mm,int16_t theta_mrad,int8_t grid_x,int8_t grid_y);   //ң⣺λ
+void Tlm_Send_Wheel(void);                               //ң⣺ĸӵռձ()
+void Tlm_Send_Power(void);                               //ң⣺صѹռձȲϵ
+void Tlm_Send_Mission(uint8_t step,uint8_t dir,uint8_t state);                       //ң⣺
+void Tlm_Send_Vision(uint8_t kind,uint8_t result,int16_t x,int16_t y);               //ң⣺ͷʶ
+void Tlm_Flush(void);                               //ÿңڵãUDPģʽܹ֡ΪһUDPģʽһͻ˷ĶУҪģ'>'ʱ
+uint32_t Tlm_Drop_Count(void);                      //ңͶʱָӦ򻺳ʧܶ֡
+uint8_t Tlm_Client_Stat(uint8_t id,Tlm_Client *out);        //ģʽ¿ͻid(0~TLM_CLIENT_NUM-1)ͳƣûӷ0
+void Remote_Init(void);                             //ָвӵESP8266жϣڴ֮ǰ
+uint8_t Remote_Get(Remote_Msg *msg,uint32_t timeout_ms);    //ȴһңָ(ms0Ϊһֱ)ʱ0
+void Remote_Ack(const Remote_Msg *msg,uint8_t result);      //Ӧ(صԵʱָЧʱ)ͷָ
+void Remote_Stat(uint32_t *frames,uint32_t *dups,uint32_t *lost,uint32_t *bad,uint32_t *latency_max_us);   //ңͳ
+void Ota_Init(void);                                //źӵңز֡ϣ Remote_Init() ֮ǰ
+void Ota_Run(void);                                 //OTAִ֡(дW25Q64״̬)ѭãύҪλʱ
+uint8_t Ota_Busy(void);                             //УW25Q64ռA5~A7
+uint32_t Ota_Ring_Drops(void);                      //OTA֡
     
 
 
@@ -59,6 +314,11 @@ void LED_Init(void);
 void Uart_Init(void);       
 void Key_Init(void);       
 void PWM_Init(void) ;
+void Ctrl_Timer_Init(void); //TIM6ʱжϴ񣬿񽨺úٵ
+void Odom_Init(void);       //ĸӵı PWM_Init() ֮ǰ
+void Adc_Init(void);        //صѹADCɨ裬 PWM_Init() ֮
+void Servo_Init(void);      //е۶
+void Debounce_Init(void);   //TIM7жҪ Sensor_Flagsǽúٵ
 extern void system_init(void) ;
 void OLED_Init(void);       //ʼOLEDʾϢ  90  2.4.6ֱʾ˳
 void Sensor_Init(void);     //ʼ    